@@ -1,6 +1,14 @@
 #include "SharedMemoryManager.h"
+
+#include <signal.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
 #include "structs/Event.h"
 #include "storage/SmartEventSerializer.h"
+#include "TriggerMessageCodec.h"
 
 namespace na62 {
 
@@ -20,6 +28,36 @@ boost::interprocess::message_queue * SharedMemoryManager::trigger_queue_; conste
 boost::interprocess::message_queue * SharedMemoryManager::trigger_response_queue_; constexpr char SharedMemoryManager::trigger_response_queue_name_[];
 boost::interprocess::message_queue * SharedMemoryManager::l1_free_queue_; constexpr char SharedMemoryManager::l1_free_queue_name_[];
 
+/*
+ * 16 kB covers the smallest L2 events, most of them fit into 20 kB and nearly all into 24 kB
+ */
+const uint SharedMemoryManager::l2_slab_sizes_[L2_NUMBER_OF_SLAB_CLASSES] = { 16384, 20480, 24576, 65536 };
+const uint SharedMemoryManager::l2_slab_shares_[L2_NUMBER_OF_SLAB_CLASSES] = { 20, 50, 20, 10 }; // % of the segment
+
+uint SharedMemoryManager::l2_mem_size_;
+uint SharedMemoryManager::l2_num_slots_[L2_NUMBER_OF_SLAB_CLASSES];
+
+boost::interprocess::managed_shared_memory* SharedMemoryManager::l2_shm_; constexpr char SharedMemoryManager::l2_shm_name_[];
+char* SharedMemoryManager::l2_slabs_[L2_NUMBER_OF_SLAB_CLASSES];
+boost::interprocess::message_queue* SharedMemoryManager::l2_free_queues_[L2_NUMBER_OF_SLAB_CLASSES];
+boost::interprocess::message_queue* SharedMemoryManager::l2_trigger_queue_; constexpr char SharedMemoryManager::l2_trigger_queue_name_[];
+
+std::atomic<uint64_t> SharedMemoryManager::L2EventsStored_(0);
+std::atomic<uint64_t> SharedMemoryManager::L2EventsDroppedNoSlot_(0);
+std::atomic<uint64_t> SharedMemoryManager::L2EventsDroppedQueueFull_(0);
+std::atomic<uint64_t> SharedMemoryManager::L2EventsDroppedTooLarge_(0);
+std::atomic<int64_t> SharedMemoryManager::L2EventsInFlight_(0);
+
+boost::interprocess::managed_shared_memory* SharedMemoryManager::consumer_shm_; constexpr char SharedMemoryManager::consumer_shm_name_[];
+TriggerConsumerRegistry* SharedMemoryManager::trigger_consumers_ = nullptr; constexpr char SharedMemoryManager::trigger_consumers_name_[];
+boost::interprocess::message_queue* SharedMemoryManager::consumer_queues_[MAX_TRIGGER_CONSUMERS];
+
+uint SharedMemoryManager::consumer_queue_size_;
+std::atomic<uint64_t> SharedMemoryManager::consumer_heartbeat_timeout_micros_(2000000);
+
+std::atomic<uint64_t> SharedMemoryManager::EventsDispatchedToConsumers_(0);
+std::atomic<uint64_t> SharedMemoryManager::EventsDispatchedShared_(0);
+
 /*
  * Stats Counters
  */
@@ -75,18 +113,18 @@ void SharedMemoryManager::initialize(){
 
 	//send queue
 	try {
-		trigger_queue_ = new boost::interprocess::message_queue(boost::interprocess::create_only, trigger_queue_name_, getL1NumEvents(), sizeof(TriggerMessager));
+		trigger_queue_ = new boost::interprocess::message_queue(boost::interprocess::create_only, trigger_queue_name_, getL1NumEvents(), sizeof(TriggerDescriptor));
 	} catch (boost::interprocess::interprocess_exception& ex) {
 		LOG_INFO(ex.what()<< " Trigger Queue exists");
-		trigger_queue_ = new boost::interprocess::message_queue(boost::interprocess::open_or_create, trigger_queue_name_, getL1NumEvents(), sizeof(TriggerMessager));
+		trigger_queue_ = new boost::interprocess::message_queue(boost::interprocess::open_or_create, trigger_queue_name_, getL1NumEvents(), sizeof(TriggerDescriptor));
 	}
 
 	//receive queue
 	try {
-		trigger_response_queue_ = new boost::interprocess::message_queue(boost::interprocess::create_only, trigger_response_queue_name_, from_q_size_, sizeof(TriggerMessager));
+		trigger_response_queue_ = new boost::interprocess::message_queue(boost::interprocess::create_only, trigger_response_queue_name_, from_q_size_, sizeof(TriggerDescriptor));
 	} catch (boost::interprocess::interprocess_exception& ex) {
 		LOG_INFO(ex.what()<< " Trigger Response Queue exists");
-		trigger_response_queue_ = new boost::interprocess::message_queue(boost::interprocess::open_or_create, trigger_response_queue_name_, from_q_size_, sizeof(TriggerMessager));
+		trigger_response_queue_ = new boost::interprocess::message_queue(boost::interprocess::open_or_create, trigger_response_queue_name_, from_q_size_, sizeof(TriggerDescriptor));
 	}
 }
 
@@ -111,25 +149,487 @@ bool SharedMemoryManager::storeL1Event(const Event* event) {
 		return false;
 	}
 	//Enqueue memory location to analyze
+	TriggerMessager trigger_message;
+	trigger_message.memory_id = memory_id;
+	trigger_message.event_id = event->getEventNumber();
+	trigger_message.burst_id = event->getBurstID();
+	trigger_message.level = 1;
+	trigger_message.dispatch_time_micros = getMonotonicMicros();
+	TriggerMessageCodec::writeDispatchTime(getL1ResultArea(memory_id), trigger_message.dispatch_time_micros);
+	if (dispatchTriggerMessage(trigger_message)) {
+		return true;
+	}
+	removeL1Event(memory_id); //Memory location will be available again
+	return false;
+}
+
+bool SharedMemoryManager::dispatchTriggerMessage(TriggerMessager &trigger_message) {
+	const TriggerDescriptor descriptor = TriggerMessageCodec::toDescriptor(trigger_message, false);
+	if (trigger_consumers_ != nullptr) {
+		/*
+		 * Try the live consumers in the order of their backlog, skipping the ones with a full sub-queue
+		 */
+		const uint64_t now = getMonotonicMicros();
+		uint64_t tried = 0;
+		while (true) {
+			int best = -1;
+			int64_t best_load = 0;
+			for (uint consumer_id = 0; consumer_id != MAX_TRIGGER_CONSUMERS; consumer_id++) {
+				TriggerConsumerState& consumer = trigger_consumers_->consumers[consumer_id];
+				if ((tried & (1ull << consumer_id)) || !isConsumerAlive(consumer, now)) {
+					continue;
+				}
+				const int64_t load = consumer.queued.load(std::memory_order_relaxed)
+						+ consumer.inFlight.load(std::memory_order_relaxed);
+				if (best == -1 || load < best_load) {
+					best = consumer_id;
+					best_load = load;
+				}
+			}
+			if (best == -1) {
+				break;
+			}
+			tried |= 1ull << best;
+
+			// Count before sending so that the consumer never sees a negative backlog
+			TriggerConsumerState& consumer = trigger_consumers_->consumers[best];
+			consumer.queued.fetch_add(1, std::memory_order_relaxed);
+			try {
+				if (consumer_queues_[best]->try_send(&descriptor, sizeof(TriggerDescriptor), 0)) {
+					EventsDispatchedToConsumers_.fetch_add(1, std::memory_order_relaxed);
+					return true;
+				}
+			} catch (boost::interprocess::interprocess_exception &ex) {
+				LOG_ERROR("trigger_queue_" << best << "_ send error: " << ex.what());
+			}
+			consumer.queued.fetch_sub(1, std::memory_order_relaxed);
+		}
+	}
+
 	try {
-		uint message_priority = 0;
-		TriggerMessager trigger_message;
-		trigger_message.memory_id = memory_id;
-		trigger_message.event_id = event->getEventNumber();
-		trigger_message.burst_id = event->getBurstID();
-		trigger_message.level = 1;
-		trigger_queue_->send(&trigger_message, sizeof(TriggerMessager), message_priority); //Blocking
+		trigger_queue_->send(&descriptor, sizeof(TriggerDescriptor), 0); //Blocking
+		EventsDispatchedShared_.fetch_add(1, std::memory_order_relaxed);
 		return true;
 	} catch (boost::interprocess::interprocess_exception &ex) {
-		removeL1Event(memory_id); //Memory location will be available again
 		LOG_ERROR("trigger_queue send error: " << ex.what());
 		return false;
 	}
+}
+
+//Trigger consumer pool
+uint64_t SharedMemoryManager::getMonotonicMicros() {
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void SharedMemoryManager::initializeTriggerConsumers(uint queue_size) {
+	consumer_queue_size_ = queue_size;
+
+	try {
+		consumer_shm_ = new boost::interprocess::managed_shared_memory(boost::interprocess::open_or_create, consumer_shm_name_,
+				sizeof(TriggerConsumerRegistry) + 65536);
+		// Value initialization zeroes all atomics
+		trigger_consumers_ = consumer_shm_->find_or_construct<TriggerConsumerRegistry>(trigger_consumers_name_)();
+	} catch (boost::interprocess::interprocess_exception& ex) {
+		LOG_ERROR(ex.what() << " Unable to create the trigger consumer registry");
+		trigger_consumers_ = nullptr;
+		return;
+	}
+
+	for (uint consumer_id = 0; consumer_id != MAX_TRIGGER_CONSUMERS; consumer_id++) {
+		const std::string queue_name = getConsumerQueueName(consumer_id);
+		consumer_queues_[consumer_id] = new boost::interprocess::message_queue(boost::interprocess::open_or_create,
+				queue_name.c_str(), consumer_queue_size_, sizeof(TriggerDescriptor));
+	}
+	LOG_INFO("Trigger consumer pool: " << MAX_TRIGGER_CONSUMERS << " sub-queues of " << consumer_queue_size_ << " events");
+}
+
+void SharedMemoryManager::eraseTriggerConsumers() {
+	try {
+		for (uint consumer_id = 0; consumer_id != MAX_TRIGGER_CONSUMERS; consumer_id++) {
+			boost::interprocess::message_queue::remove(getConsumerQueueName(consumer_id).c_str());
+		}
+		boost::interprocess::shared_memory_object::remove(consumer_shm_name_);
+	} catch(boost::interprocess::interprocess_exception& ex) {
+		LOG_ERROR(ex.what());
+	}
+}
+
+int SharedMemoryManager::registerTriggerConsumer() {
+	const uint64_t now = getMonotonicMicros();
+	for (uint consumer_id = 0; consumer_id != MAX_TRIGGER_CONSUMERS; consumer_id++) {
+		TriggerConsumerState& consumer = trigger_consumers_->consumers[consumer_id];
+		uint64_t heartbeat = consumer.heartbeatMicros.load(std::memory_order_relaxed);
+
+		bool claimed = false;
+		uint32_t free_slot = 0;
+		if (consumer.registered.compare_exchange_strong(free_slot, 1, std::memory_order_acq_rel)) {
+			claimed = true;
+		} else if (!isConsumerAlive(consumer, now) && kill(consumer.pid.load(std::memory_order_relaxed), 0) != 0
+				&& errno == ESRCH) {
+			/*
+			 * The process of this slot is gone: the heartbeat CAS makes sure only one process takes the slot over.
+			 * Its events in flight are lost until the free queue consistency check, its backlog is kept
+			 */
+			claimed = consumer.heartbeatMicros.compare_exchange_strong(heartbeat, now, std::memory_order_acq_rel);
+			if (claimed) {
+				LOG_INFO("Taking over trigger consumer " << consumer_id << " of pid " << consumer.pid);
+			}
+		}
+		if (!claimed) {
+			continue;
+		}
+
+		consumer.pid.store(getpid(), std::memory_order_relaxed);
+		consumer.inFlight.store(0, std::memory_order_relaxed);
+		consumer.queued.store(consumer_queues_[consumer_id]->get_num_msg(), std::memory_order_relaxed);
+		consumer.heartbeatMicros.store(getMonotonicMicros(), std::memory_order_release);
+		LOG_INFO("Registered trigger consumer " << consumer_id);
+		return consumer_id;
+	}
+	LOG_ERROR("All " << MAX_TRIGGER_CONSUMERS << " trigger consumer slots are in use");
+	return -1;
+}
+
+void SharedMemoryManager::unregisterTriggerConsumer(uint consumer_id) {
+	// The remaining backlog is stolen by the other consumers
+	trigger_consumers_->consumers[consumer_id].registered.store(0, std::memory_order_release);
+}
+
+bool SharedMemoryManager::tryReceiveTriggerMessage(boost::interprocess::message_queue *queue, TriggerMessager &trigger_message) {
+	TriggerDescriptor descriptor;
+	std::size_t recvd_size;
+	uint priority;
+	try {
+		if (!queue->try_receive(&descriptor, sizeof(TriggerDescriptor), recvd_size, priority)) {
+			return false;
+		}
+	} catch (boost::interprocess::interprocess_exception &ex) {
+		LOG_ERROR("trigger queue receive error: " << ex.what());
+		return false;
+	}
+	if (recvd_size != sizeof(TriggerDescriptor)) {
+		LOG_ERROR("Unexpected queue message received recvd side: " << recvd_size << " Instead of: " << sizeof(TriggerDescriptor));
+		return false;
+	}
+	decodeTriggerMessage(descriptor, trigger_message);
+	return true;
+}
+
+bool SharedMemoryManager::stealTriggerMessage(uint consumer_id, TriggerMessager &trigger_message) {
+	/*
+	 * Steal from the largest backlog. A live consumer keeps the event it will take next, the backlog of a dead
+	 * or unregistered one is taken completely
+	 */
+	const uint64_t now = getMonotonicMicros();
+	int victim = -1;
+	int64_t victim_backlog = 0;
+	for (uint other = 0; other != MAX_TRIGGER_CONSUMERS; other++) {
+		if (other == consumer_id) {
+			continue;
+		}
+		const TriggerConsumerState& consumer = trigger_consumers_->consumers[other];
+		const int64_t backlog = consumer.queued.load(std::memory_order_relaxed) - (isConsumerAlive(consumer, now) ? 1 : 0);
+		if (backlog > victim_backlog) {
+			victim = other;
+			victim_backlog = backlog;
+		}
+	}
+	if (victim == -1 || !tryReceiveTriggerMessage(consumer_queues_[victim], trigger_message)) {
+		return false;
+	}
+	trigger_consumers_->consumers[victim].queued.fetch_sub(1, std::memory_order_relaxed);
+	trigger_consumers_->consumers[consumer_id].stolen.fetch_add(1, std::memory_order_relaxed);
+	return true;
+}
+
+bool SharedMemoryManager::getNextEvent(uint consumer_id, Event* & event, TriggerMessager & trigger_message) {
+	TriggerConsumerState& consumer = trigger_consumers_->consumers[consumer_id];
+	boost::interprocess::message_queue* own_queue = consumer_queues_[consumer_id];
+
+	while (true) {
+		heartbeatTriggerConsumer(consumer_id);
+
+		bool received = false;
+		if (tryReceiveTriggerMessage(own_queue, trigger_message)) {
+			consumer.queued.fetch_sub(1, std::memory_order_relaxed);
+			received = true;
+		} else {
+			received = stealTriggerMessage(consumer_id, trigger_message)
+					|| tryReceiveTriggerMessage(trigger_queue_, trigger_message);
+		}
+
+		if (!received) {
+			// Wait on the own sub-queue, but come back regularly to send a heartbeat and to look for work to steal
+			TriggerDescriptor descriptor;
+			std::size_t recvd_size;
+			uint priority;
+			try {
+				received = own_queue->timed_receive(&descriptor, sizeof(TriggerDescriptor), recvd_size, priority,
+						boost::posix_time::microsec_clock::universal_time() + boost::posix_time::milliseconds(10))
+						&& recvd_size == sizeof(TriggerDescriptor);
+			} catch (boost::interprocess::interprocess_exception &ex) {
+				LOG_ERROR("trigger_queue_" << consumer_id << "_ receive error: " << ex.what());
+				return false;
+			}
+			if (!received) {
+				continue;
+			}
+			consumer.queued.fetch_sub(1, std::memory_order_relaxed);
+			decodeTriggerMessage(descriptor, trigger_message);
+		}
+
+		consumer.inFlight.fetch_add(1, std::memory_order_relaxed);
+		event = new Event((EVENT_HDR*) (l1_mem_array_ + trigger_message.memory_id), 1);
+		return true;
+	}
+}
 
-	LOG_ERROR("How did we get here??");
+bool SharedMemoryManager::pushTriggerResponseQueue(uint consumer_id, TriggerMessager &trigger_message) {
+	TriggerConsumerState& consumer = trigger_consumers_->consumers[consumer_id];
+	const uint64_t now = getMonotonicMicros();
+	const uint64_t latency = now > trigger_message.dispatch_time_micros ? now - trigger_message.dispatch_time_micros : 0;
+
+	consumer.latencySumMicros.fetch_add(latency, std::memory_order_relaxed);
+	uint64_t max = consumer.latencyMaxMicros.load(std::memory_order_relaxed);
+	while (latency > max && !consumer.latencyMaxMicros.compare_exchange_weak(max, latency, std::memory_order_relaxed)) {
+	}
+	consumer.completed.fetch_add(1, std::memory_order_relaxed);
+	consumer.inFlight.fetch_sub(1, std::memory_order_relaxed);
+	consumer.heartbeatMicros.store(now, std::memory_order_relaxed);
+
+	return pushTriggerResponseQueue(trigger_message);
+}
+
+TriggerConsumerStats SharedMemoryManager::getTriggerConsumerStats(uint consumer_id) {
+	const TriggerConsumerState& consumer = trigger_consumers_->consumers[consumer_id];
+	TriggerConsumerStats stats;
+	stats.registered = consumer.registered.load(std::memory_order_relaxed);
+	stats.alive = isConsumerAlive(consumer, getMonotonicMicros());
+	stats.pid = consumer.pid.load(std::memory_order_relaxed);
+	stats.queued = consumer.queued.load(std::memory_order_relaxed);
+	stats.inFlight = consumer.inFlight.load(std::memory_order_relaxed);
+	stats.completed = consumer.completed.load(std::memory_order_relaxed);
+	stats.stolen = consumer.stolen.load(std::memory_order_relaxed);
+	stats.latencySumMicros = consumer.latencySumMicros.load(std::memory_order_relaxed);
+	stats.latencyMaxMicros = consumer.latencyMaxMicros.load(std::memory_order_relaxed);
+	return stats;
+}
+
+//L2 Shared Memory Functions
+void SharedMemoryManager::initializeL2(uint l2_mem_size) {
+	l2_mem_size_ = l2_mem_size;
+
+	try {
+		l2_shm_ = new boost::interprocess::managed_shared_memory(boost::interprocess::create_only, l2_shm_name_, l2_mem_size_);
+	} catch(boost::interprocess::interprocess_exception& e) {
+		l2_shm_ = new boost::interprocess::managed_shared_memory(boost::interprocess::open_or_create, l2_shm_name_, l2_mem_size_);
+	}
+
+	bool createdFreeQueues = false;
+	for (uint slab_class = 0; slab_class != L2_NUMBER_OF_SLAB_CLASSES; slab_class++) {
+		const std::string slab_name = getL2SlabName(slab_class);
+		std::pair<char*, std::size_t> slab = l2_shm_->find<char>(slab_name.c_str());
+		if (slab.first) {
+			l2_slabs_[slab_class] = slab.first;
+			l2_num_slots_[slab_class] = slab.second / l2_slab_sizes_[slab_class];
+		} else {
+			/*
+			 * The segment management needs some space of its own: leave 1% of the segment unused
+			 */
+			l2_num_slots_[slab_class] = (uint64_t) l2_mem_size_ * l2_slab_shares_[slab_class] * 99 / 10000
+					/ l2_slab_sizes_[slab_class];
+			try {
+				l2_slabs_[slab_class] = l2_shm_->construct<char>(slab_name.c_str())[(size_t) l2_num_slots_[slab_class]
+						* l2_slab_sizes_[slab_class]](0);
+			} catch (boost::interprocess::interprocess_exception& ex) {
+				LOG_ERROR(ex.what() << " Unable to create the L2 slab of " << l2_num_slots_[slab_class] << " x " << l2_slab_sizes_[slab_class] << " B");
+				l2_slabs_[slab_class] = nullptr;
+				l2_num_slots_[slab_class] = 0;
+			}
+		}
+		LOG_INFO("Shared memory L2 slab class " << l2_slab_sizes_[slab_class] << " B: " << l2_num_slots_[slab_class] << " slots");
+
+		const std::string queue_name = getL2FreeQueueName(slab_class);
+		const uint queue_size = std::max(l2_num_slots_[slab_class], 1u);
+		try {
+			l2_free_queues_[slab_class] = new boost::interprocess::message_queue(boost::interprocess::create_only, queue_name.c_str(), queue_size, sizeof(uint));
+			createdFreeQueues = true;
+		} catch (boost::interprocess::interprocess_exception& ex) {
+			LOG_INFO(ex.what()<< " L2 Free Queue " << slab_class << " exists");
+			l2_free_queues_[slab_class] = new boost::interprocess::message_queue(boost::interprocess::open_or_create, queue_name.c_str(), queue_size, sizeof(uint));
+		}
+	}
+	if (createdFreeQueues) {
+		LOG_INFO("Pushing all free L2 slots onto the L2 free queues");
+		fillL2FreeQueues();
+	}
+
+	uint total_slots = 0;
+	for (uint slab_class = 0; slab_class != L2_NUMBER_OF_SLAB_CLASSES; slab_class++) {
+		total_slots += l2_num_slots_[slab_class];
+	}
+	try {
+		l2_trigger_queue_ = new boost::interprocess::message_queue(boost::interprocess::create_only, l2_trigger_queue_name_, std::max(total_slots, 1u), sizeof(TriggerDescriptor));
+	} catch (boost::interprocess::interprocess_exception& ex) {
+		LOG_INFO(ex.what()<< " L2 Trigger Queue exists");
+		l2_trigger_queue_ = new boost::interprocess::message_queue(boost::interprocess::open_or_create, l2_trigger_queue_name_, std::max(total_slots, 1u), sizeof(TriggerDescriptor));
+	}
+}
+
+bool SharedMemoryManager::storeL2Event(const Event* event) {
+	EVENT_HDR* serialized_event;
+	try {
+		serialized_event = SmartEventSerializer::SerializeEvent(event);
+	} catch(SerializeError &) {
+		L2EventsDroppedTooLarge_.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	const uint length = serialized_event->length * 4;
+
+	/*
+	 * Take a slot of the smallest class the event fits in, or of a larger one if that class is exhausted
+	 */
+	uint slab_class = 0;
+	while (slab_class != L2_NUMBER_OF_SLAB_CLASSES && l2_slab_sizes_[slab_class] < length) {
+		slab_class++;
+	}
+	if (slab_class == L2_NUMBER_OF_SLAB_CLASSES) {
+		delete[] (char*) serialized_event;
+		L2EventsDroppedTooLarge_.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	uint slot;
+	std::size_t recvd_size;
+	uint priority;
+	bool got_slot = false;
+	for (; slab_class != L2_NUMBER_OF_SLAB_CLASSES && !got_slot; slab_class++) {
+		try {
+			got_slot = l2_num_slots_[slab_class] != 0
+					&& l2_free_queues_[slab_class]->try_receive(&slot, sizeof(uint), recvd_size, priority)
+					&& recvd_size == sizeof(uint);
+		} catch (boost::interprocess::interprocess_exception &ex) {
+			LOG_ERROR("L2 free queue receive error: " << ex.what());
+		}
+		if (got_slot) {
+			break;
+		}
+	}
+	if (!got_slot) {
+		delete[] (char*) serialized_event;
+		L2EventsDroppedNoSlot_.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	const uint memory_id = (slab_class << L2_SLAB_CLASS_SHIFT) | slot;
+	memcpy(getL2Event(memory_id), serialized_event, length);
+	delete[] (char*) serialized_event;
+
+	TriggerMessager trigger_message;
+	trigger_message.memory_id = memory_id;
+	trigger_message.event_id = event->getEventNumber();
+	trigger_message.burst_id = event->getBurstID();
+	trigger_message.level = 2;
+	trigger_message.l2_trigger_type_word = 0;
+	trigger_message.trigger_result = false;
+	trigger_message.isL1WhileTimeout = false;
+	trigger_message.isRequestZeroSuppressed = false;
+	const TriggerDescriptor descriptor = TriggerMessageCodec::toDescriptor(trigger_message, false);
+	try {
+		if (l2_trigger_queue_->try_send(&descriptor, sizeof(TriggerDescriptor), 0)) {
+			L2EventsStored_.fetch_add(1, std::memory_order_relaxed);
+			L2EventsInFlight_.fetch_add(1, std::memory_order_relaxed);
+			return true;
+		}
+	} catch (boost::interprocess::interprocess_exception &ex) {
+		LOG_ERROR("l2_trigger_queue send error: " << ex.what());
+	}
+	pushL2FreeQueue(slab_class, slot);
+	L2EventsDroppedQueueFull_.fetch_add(1, std::memory_order_relaxed);
 	return false;
 }
 
+bool SharedMemoryManager::getNextL2Event(Event* & event, TriggerMessager & trigger_message) {
+	TriggerDescriptor descriptor;
+	std::size_t recvd_size;
+	uint priority;
+	try {
+		l2_trigger_queue_->receive(&descriptor, sizeof(TriggerDescriptor), recvd_size, priority); // Blocking
+	} catch (boost::interprocess::interprocess_exception &ex) {
+		LOG_ERROR("l2_trigger_queue receive error: " << ex.what());
+		return false;
+	}
+	if (recvd_size != sizeof(TriggerDescriptor)) {
+		LOG_ERROR("Unexpected l2_trigger_queue_ message received recvd side: " << recvd_size << " Instead of: " << sizeof(TriggerDescriptor));
+		return false;
+	}
+	decodeTriggerMessage(descriptor, trigger_message);
+	event = new Event(getL2Event(trigger_message.memory_id), false);
+	return true;
+}
+
+bool SharedMemoryManager::removeL2Event(uint memory_id) {
+	L2EventsInFlight_.fetch_sub(1, std::memory_order_relaxed);
+	if (pushL2FreeQueue(memory_id >> L2_SLAB_CLASS_SHIFT, memory_id & ((1u << L2_SLAB_CLASS_SHIFT) - 1))) {
+		return true;
+	}
+	LOG_ERROR("Unable to push on the L2 free queue");
+	return false;
+}
+
+bool SharedMemoryManager::pushL2FreeQueue(uint slab_class, uint slot) {
+	try {
+		l2_free_queues_[slab_class]->send(&slot, sizeof(uint), 0);
+	} catch (boost::interprocess::interprocess_exception &ex) {
+		LOG_ERROR("pushL2FreeQueue error: " << ex.what());
+		return false;
+	}
+	return true;
+}
+
+void SharedMemoryManager::fillL2FreeQueues() {
+	for (uint slab_class = 0; slab_class != L2_NUMBER_OF_SLAB_CLASSES; slab_class++) {
+		for (uint slot = 0; slot != l2_num_slots_[slab_class]; slot++) {
+			pushL2FreeQueue(slab_class, slot);
+		}
+	}
+}
+
+bool SharedMemoryManager::checkL2FreeQueueConsistency() {
+	bool consistent = true;
+	for (uint slab_class = 0; slab_class != L2_NUMBER_OF_SLAB_CLASSES; slab_class++) {
+		consistent &= l2_free_queues_[slab_class]->get_num_msg() == l2_num_slots_[slab_class];
+	}
+	if (consistent || L2EventsInFlight_ != 0) {
+		return true;
+	}
+
+	//some slots have been lost: refill all queues
+	uint slot;
+	std::size_t recvd_size;
+	uint priority;
+	for (uint slab_class = 0; slab_class != L2_NUMBER_OF_SLAB_CLASSES; slab_class++) {
+		while (l2_free_queues_[slab_class]->try_receive(&slot, sizeof(uint), recvd_size, priority)) {
+			continue;
+		}
+	}
+	fillL2FreeQueues();
+	return false;
+}
+
+void SharedMemoryManager::eraseL2All() {
+	try {
+		boost::interprocess::message_queue::remove(l2_trigger_queue_name_);
+		for (uint slab_class = 0; slab_class != L2_NUMBER_OF_SLAB_CLASSES; slab_class++) {
+			boost::interprocess::message_queue::remove(getL2FreeQueueName(slab_class).c_str());
+		}
+		boost::interprocess::shared_memory_object::remove(l2_shm_name_);
+	} catch(boost::interprocess::interprocess_exception& ex) {
+		LOG_ERROR(ex.what());
+	}
+}
+
 bool SharedMemoryManager::removeL1Event(uint memory_id){
 	if (pushL1FreeQueue(memory_id)) {
 		return true;
@@ -150,6 +650,21 @@ bool SharedMemoryManager::getNextEvent(Event* & event, TriggerMessager & trigger
 
 //Queue Functions
 //================
+void SharedMemoryManager::decodeTriggerMessage(const TriggerDescriptor& descriptor, TriggerMessager &trigger_message) {
+	TriggerMessageCodec::fromDescriptor(descriptor, trigger_message);
+	if (descriptor.level != 1) {
+		return;
+	}
+	const char* area = getL1ResultArea(descriptor.memory_id);
+	if (descriptor.flags & TriggerMessageCodec::HAS_RESULT_RECORD) {
+		if (!TriggerMessageCodec::decodeResult(area, L1_TRIGGER_RESULT_AREA_SIZE, trigger_message)) {
+			LOG_ERROR("Corrupt L1 result of event " << descriptor.event_id << " in slot " << descriptor.memory_id);
+		}
+	} else {
+		trigger_message.dispatch_time_micros = TriggerMessageCodec::readDispatchTime(area);
+	}
+}
+
 bool SharedMemoryManager::popTriggerQueue(TriggerMessager &trigger_message, uint &priority) {
 	return popQueue(1, trigger_message, priority);
 }
@@ -159,7 +674,8 @@ bool SharedMemoryManager::popTriggerResponseQueue(TriggerMessager &trigger_messa
 }
 
 bool SharedMemoryManager::popQueue(bool is_trigger_message_queue, TriggerMessager &trigger_message, uint &priority) {
-	std::size_t struct_size = sizeof(TriggerMessager);
+	TriggerDescriptor descriptor;
+	std::size_t struct_size = sizeof(TriggerDescriptor);
 	std::size_t recvd_size;
 	boost::interprocess::message_queue *queue;
 
@@ -170,9 +686,10 @@ bool SharedMemoryManager::popQueue(bool is_trigger_message_queue, TriggerMessage
 	}
 
 	try {
-		queue->receive((void *) &trigger_message, struct_size, recvd_size, priority); // Blocking
+		queue->receive((void *) &descriptor, struct_size, recvd_size, priority); // Blocking
 		//Check that is the expected type
 		if (recvd_size == struct_size) {
+			decodeTriggerMessage(descriptor, trigger_message);
 			return true;
 		}
 	} catch (boost::interprocess::interprocess_exception &ex) {
@@ -185,9 +702,22 @@ bool SharedMemoryManager::popQueue(bool is_trigger_message_queue, TriggerMessage
 }
 
 bool SharedMemoryManager::pushTriggerResponseQueue(TriggerMessager &trigger_message) {
+	/*
+	 * Only level 1 slots have a result area, the L2 verdict fits into the descriptor
+	 */
+	bool has_result_record = false;
+	if (trigger_message.level == 1) {
+		has_result_record = TriggerMessageCodec::encodeResult(trigger_message, getL1ResultArea(trigger_message.memory_id),
+				L1_TRIGGER_RESULT_AREA_SIZE);
+		if (!has_result_record) {
+			LOG_ERROR("L1 result of event " << trigger_message.event_id << " exceeds the result area of " << L1_TRIGGER_RESULT_AREA_SIZE << " B");
+		}
+	}
+	const TriggerDescriptor descriptor = TriggerMessageCodec::toDescriptor(trigger_message, has_result_record);
+
 	uint priority = 0;
 	try {
-		trigger_response_queue_->send(&trigger_message, sizeof(TriggerMessager), priority); //Blocking
+		trigger_response_queue_->send(&descriptor, sizeof(TriggerDescriptor), priority); //Blocking
 	} catch (boost::interprocess::interprocess_exception &ex) {
 		LOG_ERROR("Trigger response queue send error: " << ex.what());
 		return false;
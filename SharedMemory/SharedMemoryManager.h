@@ -12,6 +12,7 @@
 
 #include "structs/TriggerMessager.h"
 #include "options/Logging.h"
+#include "TriggerConsumerRegistry.h"
 #include "structs/SerialEvent.h"
 #include "structs/Event.h"
 
@@ -30,6 +31,11 @@
  * Mean L1 serialized event size ~  2 Kb
  */
 
+/*
+ * Number of size classes of the L2 segment, see SharedMemoryManager::initializeL2
+ */
+#define L2_NUMBER_OF_SLAB_CLASSES 4
+
 namespace na62 {
 
 class SharedMemoryManager {
@@ -57,6 +63,78 @@ private:
 	static std::atomic<uint64_t> FragmentStored_;
 	static std::atomic<uint64_t> FragmentNonStored_;
 
+	/*
+	 * L2 segment: one slab of fixed size slots per size class, each with its own free queue of slot numbers.
+	 * The memory_id of a level 2 TriggerMessager is (slabClass << L2_SLAB_CLASS_SHIFT) | slot
+	 */
+	static const uint L2_SLAB_CLASS_SHIFT = 24;
+	static const uint l2_slab_sizes_[L2_NUMBER_OF_SLAB_CLASSES];
+	static const uint l2_slab_shares_[L2_NUMBER_OF_SLAB_CLASSES];
+
+	static uint l2_mem_size_;
+	static uint l2_num_slots_[L2_NUMBER_OF_SLAB_CLASSES];
+
+	static boost::interprocess::managed_shared_memory *l2_shm_; static constexpr char l2_shm_name_[] = "l2_shm_";
+	static char *l2_slabs_[L2_NUMBER_OF_SLAB_CLASSES];
+	static boost::interprocess::message_queue *l2_free_queues_[L2_NUMBER_OF_SLAB_CLASSES];
+	static boost::interprocess::message_queue *l2_trigger_queue_; static constexpr char l2_trigger_queue_name_[] = "l2_trigger_queue_";
+
+	/*
+	 * L2 stats: events are dropped instead of blocking the caller if the L2 processes do not keep up
+	 */
+	static std::atomic<uint64_t> L2EventsStored_;
+	static std::atomic<uint64_t> L2EventsDroppedNoSlot_;
+	static std::atomic<uint64_t> L2EventsDroppedQueueFull_;
+	static std::atomic<uint64_t> L2EventsDroppedTooLarge_;
+	static std::atomic<int64_t> L2EventsInFlight_;
+
+	static std::string getL2SlabName(uint slab_class) {
+		return "l2_slab_" + std::to_string(slab_class) + "_";
+	}
+
+	static std::string getL2FreeQueueName(uint slab_class) {
+		return "l2_free_queue_" + std::to_string(slab_class) + "_";
+	}
+
+	static bool pushL2FreeQueue(uint slab_class, uint slot);
+	static void fillL2FreeQueues();
+
+	/*
+	 * Trigger process pool: every registered trigger process has its own sub-queue. The farm dispatches each
+	 * event to the live consumer with the smallest backlog, idle consumers steal from the others. The shared
+	 * trigger_queue_ is still used if no consumer is registered or all sub-queues are full
+	 */
+	static boost::interprocess::managed_shared_memory *consumer_shm_; static constexpr char consumer_shm_name_[] = "trigger_consumers_shm_";
+	static TriggerConsumerRegistry *trigger_consumers_; static constexpr char trigger_consumers_name_[] = "trigger_consumers_";
+	static boost::interprocess::message_queue *consumer_queues_[MAX_TRIGGER_CONSUMERS];
+
+	static uint consumer_queue_size_;
+	static std::atomic<uint64_t> consumer_heartbeat_timeout_micros_;
+
+	static std::atomic<uint64_t> EventsDispatchedToConsumers_;
+	static std::atomic<uint64_t> EventsDispatchedShared_;
+
+	static std::string getConsumerQueueName(uint consumer_id) {
+		return "trigger_queue_" + std::to_string(consumer_id) + "_";
+	}
+
+	static uint64_t getMonotonicMicros();
+
+	/*
+	 * The consumer may send a heartbeat after <now> has been read: a heartbeat newer than <now> is alive
+	 */
+	static inline bool isConsumerAlive(const TriggerConsumerState& consumer, const uint64_t now) {
+		if (!consumer.registered.load(std::memory_order_acquire)) {
+			return false;
+		}
+		const uint64_t heartbeat = consumer.heartbeatMicros.load(std::memory_order_relaxed);
+		return heartbeat >= now || now - heartbeat < consumer_heartbeat_timeout_micros_.load(std::memory_order_relaxed);
+	}
+
+	static bool dispatchTriggerMessage(TriggerMessager &trigger_message);
+	static bool tryReceiveTriggerMessage(boost::interprocess::message_queue *queue, TriggerMessager &trigger_message);
+	static bool stealTriggerMessage(uint consumer_id, TriggerMessager &trigger_message);
+
 	//Stats send/receive
 	static std::map<uint_fast32_t, std::pair<std::atomic<int64_t>, std::atomic<int64_t>>> l1_event_counter_;
 	static std::map<uint_fast32_t, std::pair<std::atomic<int64_t>, std::atomic<int64_t>>> l1_request_stored_;
@@ -84,6 +162,15 @@ private:
 		l1_num_events_ = num;
 	}
 
+	static inline char* getL1ResultArea(uint memory_id) {
+		return (char*) (l1_mem_array_ + memory_id) + sizeof(l1_SerializedEvent) - L1_TRIGGER_RESULT_AREA_SIZE;
+	}
+
+	/*
+	 * Rebuilds the message from the descriptor and, for level 1, from the result area of its slot
+	 */
+	static void decodeTriggerMessage(const TriggerDescriptor& descriptor, TriggerMessager &trigger_message);
+
 	static bool popL1FreeQueue(uint &memory_id);
 	static bool pushL1FreeQueue(uint memory_id);
 	static bool popQueue(bool is_trigger_message_queue, TriggerMessager &trigger_message, uint &priority);
@@ -207,6 +294,7 @@ public:
 		eraseTriggerResponseQueue();
 		eraseL1FreeQueue();
 		destroyL1MemArray();
+		eraseTriggerConsumers();
 	}
 
 	static bool storeL1Event(const Event* event);
@@ -214,6 +302,126 @@ public:
 	static bool getNextEvent(Event* & event, TriggerMessager & trigger_message);
 	static bool removeL1Event(uint memory_id);
 
+	/*
+	 * Creates or opens the consumer registry and one sub-queue of <queue_size> messages per consumer slot.
+	 * Called after initialize() by the farm and by every trigger process using the pool
+	 */
+	static void initializeTriggerConsumers(uint queue_size = 4096);
+
+	static void eraseTriggerConsumers();
+
+	/*
+	 * For the trigger processes: takes a free slot, or the slot of a consumer whose process does not exist anymore.
+	 * Returns the consumer id or -1 if all MAX_TRIGGER_CONSUMERS slots are in use
+	 */
+	static int registerTriggerConsumer();
+	static void unregisterTriggerConsumer(uint consumer_id);
+
+	/*
+	 * A consumer without heartbeat for the timeout gets no new events and its backlog is stolen by the others.
+	 * getNextEvent(consumer_id, ...) sends a heartbeat while waiting, long running processing should call
+	 * heartbeatTriggerConsumer on its own
+	 */
+	static inline void heartbeatTriggerConsumer(uint consumer_id) {
+		trigger_consumers_->consumers[consumer_id].heartbeatMicros.store(getMonotonicMicros(), std::memory_order_relaxed);
+	}
+
+	static inline void setTriggerConsumerHeartbeatTimeout(uint millis) {
+		consumer_heartbeat_timeout_micros_ = (uint64_t) millis * 1000;
+	}
+
+	/*
+	 * Blocks until an event is available in the sub-queue of <consumer_id>, in the sub-queue of another consumer
+	 * or in the shared trigger queue, in this order
+	 */
+	static bool getNextEvent(uint consumer_id, Event* & event, TriggerMessager & trigger_message);
+
+	/*
+	 * Same as pushTriggerResponseQueue(trigger_message) but accounts the event as completed by <consumer_id>
+	 */
+	static bool pushTriggerResponseQueue(uint consumer_id, TriggerMessager &trigger_message);
+
+	static TriggerConsumerStats getTriggerConsumerStats(uint consumer_id);
+
+	static inline bool hasTriggerConsumers() {
+		return trigger_consumers_ != nullptr;
+	}
+
+	static inline uint64_t getEventsDispatchedToConsumers() {
+		return EventsDispatchedToConsumers_;
+	}
+
+	static inline uint64_t getEventsDispatchedShared() {
+		return EventsDispatchedShared_;
+	}
+
+	/*
+	 * Creates or opens the L2 segment of <l2_mem_size> bytes and its queues. The memory is split over
+	 * slot sizes of 16, 20, 24 and 64 kB matching the L2 event size distribution above.
+	 * Called by the farm and by every external L2 process
+	 */
+	static void initializeL2(uint l2_mem_size = 1500000000);
+
+	/*
+	 * Serializes the L0 and L1 data of <event> into the L2 segment and enqueues it for the L2 processes.
+	 * Never blocks: returns false and counts the drop if no slot is free or the L2 queue is full.
+	 * The verdict comes back through the trigger response queue as a message with level 2
+	 */
+	static bool storeL2Event(const Event* event);
+
+	/*
+	 * For the L2 processes: blocks until the next event is available. The returned event must be deleted after
+	 * the verdict has been pushed to the trigger response queue with the same memory_id
+	 */
+	static bool getNextL2Event(Event* & event, TriggerMessager & trigger_message);
+
+	/*
+	 * Called by the farm for every level 2 verdict to release the slot
+	 */
+	static bool removeL2Event(uint memory_id);
+
+	static inline EVENT_HDR* getL2Event(uint memory_id) {
+		const uint slab_class = memory_id >> L2_SLAB_CLASS_SHIFT;
+		const uint slot = memory_id & ((1u << L2_SLAB_CLASS_SHIFT) - 1);
+		return (EVENT_HDR*) (l2_slabs_[slab_class] + (size_t) slot * l2_slab_sizes_[slab_class]);
+	}
+
+	/*
+	 * Refills the L2 free queues if slots have been lost, e.g. by a crashed L2 process. Only done while no L2
+	 * event is in flight. Returns false if the queues had to be refilled
+	 */
+	static bool checkL2FreeQueueConsistency();
+
+	static void eraseL2All();
+
+	static inline uint getL2NumSlots(uint slab_class) {
+		return l2_num_slots_[slab_class];
+	}
+
+	static inline uint getL2SlabSize(uint slab_class) {
+		return l2_slab_sizes_[slab_class];
+	}
+
+	static inline uint64_t getL2EventsStored() {
+		return L2EventsStored_;
+	}
+
+	static inline uint64_t getL2EventsDroppedNoSlot() {
+		return L2EventsDroppedNoSlot_;
+	}
+
+	static inline uint64_t getL2EventsDroppedQueueFull() {
+		return L2EventsDroppedQueueFull_;
+	}
+
+	static inline uint64_t getL2EventsDroppedTooLarge() {
+		return L2EventsDroppedTooLarge_;
+	}
+
+	static inline int64_t getL2EventsInFlight() {
+		return L2EventsInFlight_;
+	}
+
 	static bool pushTriggerResponseQueue(TriggerMessager &trigger_message);
 	static bool popTriggerResponseQueue(TriggerMessager &trigger_message, uint &priority);
 
@@ -0,0 +1,59 @@
+/*
+ * TriggerConsumerRegistry.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: NA62 collaboration
+ */
+
+#pragma once
+#ifndef TRIGGERCONSUMERREGISTRY_H_
+#define TRIGGERCONSUMERREGISTRY_H_
+
+#include <sys/types.h>
+#include <atomic>
+#include <cstdint>
+
+#define MAX_TRIGGER_CONSUMERS 64
+
+namespace na62 {
+
+/*
+ * State of one trigger process, shared between the farm and all trigger processes. Only lock free
+ * atomics are used so that a crashed process can not leave anything locked. Times are CLOCK_MONOTONIC
+ * microseconds which are comparable between processes.
+ */
+struct alignas(64) TriggerConsumerState {
+	std::atomic<uint32_t> registered;
+	std::atomic<int32_t> pid;
+	std::atomic<uint64_t> heartbeatMicros;
+
+	std::atomic<int64_t> queued; // Events waiting in the sub-queue of this consumer
+	std::atomic<int64_t> inFlight; // Events taken by this consumer without response yet
+	std::atomic<uint64_t> completed;
+	std::atomic<uint64_t> stolen; // Events this consumer took from the sub-queue of another one
+	std::atomic<uint64_t> latencySumMicros; // Dispatch to response
+	std::atomic<uint64_t> latencyMaxMicros;
+};
+
+struct TriggerConsumerRegistry {
+	TriggerConsumerState consumers[MAX_TRIGGER_CONSUMERS];
+};
+
+/*
+ * Copy of the statistics of one consumer
+ */
+struct TriggerConsumerStats {
+	bool registered;
+	bool alive;
+	int32_t pid;
+	int64_t queued;
+	int64_t inFlight;
+	uint64_t completed;
+	uint64_t stolen;
+	uint64_t latencySumMicros;
+	uint64_t latencyMaxMicros;
+};
+
+} /* namespace na62 */
+
+#endif /* TRIGGERCONSUMERREGISTRY_H_ */
@@ -0,0 +1,317 @@
+/*
+ * TriggerMessageCodec.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: NA62 collaboration
+ */
+
+#include "TriggerMessageCodec.h"
+
+#include <cstddef>
+#include <cstring>
+
+namespace na62 {
+
+namespace {
+
+/*
+ * Accessors of all L1InfoToStorage fields in the order of their bit in the mask of their section.
+ * The order must never change, new fields are appended
+ */
+typedef uint_fast8_t (L1InfoToStorage::*WordGetter)(uint);
+typedef void (L1InfoToStorage::*WordSetter)(uint, uint_fast8_t);
+
+const WordGetter wordGetters[] = { &L1InfoToStorage::getL1CHODTrgWrd, &L1InfoToStorage::getL1KTAGTrgWrd,
+		&L1InfoToStorage::getL1LAVTrgWrd, &L1InfoToStorage::getL1IRCSACTrgWrd, &L1InfoToStorage::getL1StrawTrgWrd,
+		&L1InfoToStorage::getL1MUV3TrgWrd, &L1InfoToStorage::getL1NewCHODTrgWrd };
+const WordSetter wordSetters[] = { &L1InfoToStorage::setL1CHODTrgWrd, &L1InfoToStorage::setL1KTAGTrgWrd,
+		&L1InfoToStorage::setL1LAVTrgWrd, &L1InfoToStorage::setL1IRCSACTrgWrd, &L1InfoToStorage::setL1StrawTrgWrd,
+		&L1InfoToStorage::setL1MUV3TrgWrd, &L1InfoToStorage::setL1NewCHODTrgWrd };
+const uint NUMBER_OF_DETECTOR_WORDS = sizeof(wordGetters) / sizeof(WordGetter);
+
+struct FlagAccessor {
+	bool (*get)(L1InfoToStorage&);
+	void (*set)(L1InfoToStorage&);
+};
+
+#define L1_FLAG(name) { [](L1InfoToStorage& info) {return (bool) info.is##name();}, [](L1InfoToStorage& info) {info.set##name();} }
+
+const FlagAccessor flags[] = { L1_FLAG(L1CHODProcessed), L1_FLAG(L1CHODEmptyPacket), L1_FLAG(L1CHODBadData),
+		L1_FLAG(L1KTAGProcessed), L1_FLAG(L1KTAGEmptyPacket), L1_FLAG(L1KTAGBadData), L1_FLAG(L1LAVProcessed),
+		L1_FLAG(L1LAVEmptyPacket), L1_FLAG(L1LAVBadData), L1_FLAG(L1IRCSACProcessed), L1_FLAG(L1IRCSACEmptyPacket),
+		L1_FLAG(L1IRCSACBadData), L1_FLAG(L1StrawProcessed), L1_FLAG(L1StrawEmptyPacket), L1_FLAG(L1StrawBadData),
+		L1_FLAG(L1StrawOverflow), L1_FLAG(L1MUV3TriggerMultiProcessed), L1_FLAG(L1MUV3TriggerLeftRightProcessed),
+		L1_FLAG(L1MUV3TriggerNeighboursProcessed), L1_FLAG(L1MUV3EmptyPacket), L1_FLAG(L1MUV3BadData),
+		L1_FLAG(L1NewCHODProcessed), L1_FLAG(L1NewCHODEmptyPacket), L1_FLAG(L1NewCHODBadData) };
+const uint NUMBER_OF_FLAGS = sizeof(flags) / sizeof(FlagAccessor);
+
+struct CounterAccessor {
+	uint (*get)(L1InfoToStorage&);
+	void (*set)(L1InfoToStorage&, uint);
+};
+
+#define L1_COUNTER(name) { [](L1InfoToStorage& info) {return (uint) info.get##name();}, [](L1InfoToStorage& info, uint value) {info.set##name(value);} }
+
+const CounterAccessor counters[] = { L1_COUNTER(L1CHODNHits), L1_COUNTER(L1KTAGNSectorsL0TP), L1_COUNTER(
+		L1KTAGNSectorsCHOD), L1_COUNTER(L1LAVNHits), L1_COUNTER(L1IRCSACNHits), L1_COUNTER(L1StrawNTracks), L1_COUNTER(
+		L1MUV3NTiles), L1_COUNTER(L1NewCHODNHits), L1_COUNTER(L1RefTimeL0TP) };
+const uint NUMBER_OF_COUNTERS = sizeof(counters) / sizeof(CounterAccessor);
+
+struct MeasurementAccessor {
+	double (*get)(L1InfoToStorage&);
+	void (*set)(L1InfoToStorage&, double);
+};
+
+#define L1_MEASUREMENT(name) { [](L1InfoToStorage& info) {return info.get##name();}, [](L1InfoToStorage& info, double value) {info.set##name(value);} }
+#define L1_TRACK(name, track) { [](L1InfoToStorage& info) {return info.get##name(track);}, [](L1InfoToStorage& info, double value) {info.set##name(track, value);} }
+
+const MeasurementAccessor measurements[] = { L1_MEASUREMENT(CHODAverageTime), L1_MEASUREMENT(NewCHODAverageTime),
+		L1_MEASUREMENT(L1StrawExo2TrkCDA), L1_MEASUREMENT(L1StrawExo2TrkVtxToBeamDistance), L1_TRACK(L1StrawTrackP, 0),
+		L1_TRACK(L1StrawTrackP, 1), L1_TRACK(L1StrawTrackP, 2), L1_TRACK(L1StrawTrackP, 3), L1_TRACK(L1StrawTrackP, 4),
+		L1_TRACK(L1StrawTrackVz, 0), L1_TRACK(L1StrawTrackVz, 1), L1_TRACK(L1StrawTrackVz, 2), L1_TRACK(L1StrawTrackVz,
+				3), L1_TRACK(L1StrawTrackVz, 4) };
+const uint NUMBER_OF_MEASUREMENTS = sizeof(measurements) / sizeof(MeasurementAccessor);
+
+#undef L1_FLAG
+#undef L1_COUNTER
+#undef L1_MEASUREMENT
+#undef L1_TRACK
+
+const uint SECTION_HEADER_SIZE = 2;
+const uint MAX_SECTION_PAYLOAD = 255;
+
+/*
+ * Payload of a masked section: a 16 bit mask of the non zero values followed by these values
+ */
+class MaskedPayload {
+public:
+	MaskedPayload() :
+			mask_(0), length_(sizeof(uint16_t)) {
+	}
+
+	template<typename T>
+	void add(const uint index, const T value) {
+		if (value != 0) {
+			mask_ |= 1 << index;
+			std::memcpy(payload_ + length_, &value, sizeof(T));
+			length_ += sizeof(T);
+		}
+	}
+
+	bool empty() const {
+		return mask_ == 0;
+	}
+
+	const char* data() {
+		std::memcpy(payload_, &mask_, sizeof(uint16_t));
+		return payload_;
+	}
+
+	uint length() const {
+		return length_;
+	}
+
+private:
+	uint16_t mask_;
+	uint length_;
+	char payload_[MAX_SECTION_PAYLOAD];
+};
+
+/*
+ * Calls <read>(index, payload) for every index in the mask of a masked section of values of <valueSize> bytes
+ */
+template<typename Reader>
+bool readMaskedPayload(const char* payload, const uint length, const uint valueSize, const uint numberOfValues,
+		Reader read) {
+	if (length < sizeof(uint16_t)) {
+		return false;
+	}
+	uint16_t mask;
+	std::memcpy(&mask, payload, sizeof(uint16_t));
+	uint offset = sizeof(uint16_t);
+	for (uint index = 0; index != numberOfValues; index++) {
+		if (mask & (1 << index)) {
+			if (offset + valueSize > length) {
+				return false;
+			}
+			read(index, payload + offset);
+			offset += valueSize;
+		}
+	}
+	return true;
+}
+
+bool writeSection(char* area, uint& offset, const uint area_size, const uint8_t tag, const char* payload,
+		const uint length) {
+	if (offset + SECTION_HEADER_SIZE + length > area_size) {
+		return false;
+	}
+	area[offset] = tag;
+	area[offset + 1] = (uint8_t) length;
+	std::memcpy(area + offset + SECTION_HEADER_SIZE, payload, length);
+	offset += SECTION_HEADER_SIZE + length;
+	return true;
+}
+
+bool writeMaskedSection(char* area, uint& offset, const uint area_size, const uint8_t tag, MaskedPayload& payload) {
+	return payload.empty() || writeSection(area, offset, area_size, tag, payload.data(), payload.length());
+}
+
+} /* namespace */
+
+TriggerDescriptor TriggerMessageCodec::toDescriptor(const TriggerMessager& trigger_message,
+		const bool has_result_record) {
+	TriggerDescriptor descriptor;
+	descriptor.memory_id = trigger_message.memory_id;
+	descriptor.event_id = trigger_message.event_id;
+	descriptor.burst_id = trigger_message.burst_id;
+	descriptor.level = trigger_message.level;
+	descriptor.flags = (trigger_message.trigger_result ? TRIGGER_RESULT : 0)
+			| (trigger_message.isL1WhileTimeout ? L1_WHILE_TIMEOUT : 0)
+			| (trigger_message.isRequestZeroSuppressed ? REQUEST_ZERO_SUPPRESSED : 0)
+			| (has_result_record ? HAS_RESULT_RECORD : 0);
+	descriptor.trigger_type_word =
+			trigger_message.level == 2 ? trigger_message.l2_trigger_type_word : trigger_message.l1_trigger_type_word;
+	descriptor.reserved = 0;
+	return descriptor;
+}
+
+void TriggerMessageCodec::fromDescriptor(const TriggerDescriptor& descriptor, TriggerMessager& trigger_message) {
+	trigger_message.memory_id = descriptor.memory_id;
+	trigger_message.event_id = descriptor.event_id;
+	trigger_message.burst_id = descriptor.burst_id;
+	trigger_message.level = descriptor.level;
+	trigger_message.dispatch_time_micros = 0;
+	trigger_message.trigger_result = descriptor.flags & TRIGGER_RESULT;
+	trigger_message.isL1WhileTimeout = descriptor.flags & L1_WHILE_TIMEOUT;
+	trigger_message.isRequestZeroSuppressed = descriptor.flags & REQUEST_ZERO_SUPPRESSED;
+	trigger_message.l1_trigger_type_word = descriptor.level == 2 ? 0 : descriptor.trigger_type_word;
+	trigger_message.l2_trigger_type_word = descriptor.level == 2 ? descriptor.trigger_type_word : 0;
+	trigger_message.l1TriggerWords.fill(0);
+	trigger_message.l1Info = L1InfoToStorage();
+}
+
+void TriggerMessageCodec::writeDispatchTime(char* area, const uint64_t dispatch_time_micros) {
+	ResultHeader header;
+	std::memset(&header, 0, sizeof(ResultHeader));
+	header.dispatch_time_micros = dispatch_time_micros;
+	header.version = RESULT_RECORD_VERSION;
+	std::memcpy(area, &header, sizeof(ResultHeader));
+}
+
+uint64_t TriggerMessageCodec::readDispatchTime(const char* area) {
+	uint64_t dispatch_time_micros;
+	std::memcpy(&dispatch_time_micros, area + offsetof(ResultHeader, dispatch_time_micros), sizeof(uint64_t));
+	return dispatch_time_micros;
+}
+
+bool TriggerMessageCodec::encodeResult(TriggerMessager& trigger_message, char* area, const uint area_size) {
+	L1InfoToStorage& info = trigger_message.l1Info;
+	uint offset = sizeof(ResultHeader);
+	bool fits = true;
+
+	MaskedPayload triggerWords;
+	for (uint mask = 0; mask != trigger_message.l1TriggerWords.size(); mask++) {
+		triggerWords.add(mask, (uint8_t) trigger_message.l1TriggerWords[mask]);
+	}
+	fits &= writeMaskedSection(area, offset, area_size, TAG_TRIGGER_WORDS, triggerWords);
+
+	for (uint detector = 0; detector != NUMBER_OF_DETECTOR_WORDS; detector++) {
+		MaskedPayload words;
+		for (uint mask = 0; mask != 16; mask++) {
+			words.add(mask, (uint8_t) (info.*wordGetters[detector])(mask));
+		}
+		fits &= writeMaskedSection(area, offset, area_size, TAG_CHOD_WORDS + detector, words);
+	}
+
+	uint32_t flagBits = 0;
+	for (uint flag = 0; flag != NUMBER_OF_FLAGS; flag++) {
+		flagBits |= (uint32_t) flags[flag].get(info) << flag;
+	}
+	if (flagBits != 0) {
+		fits &= writeSection(area, offset, area_size, TAG_FLAGS, (const char*) &flagBits, sizeof(uint32_t));
+	}
+
+	MaskedPayload counterValues;
+	for (uint counter = 0; counter != NUMBER_OF_COUNTERS; counter++) {
+		counterValues.add(counter, (uint32_t) counters[counter].get(info));
+	}
+	fits &= writeMaskedSection(area, offset, area_size, TAG_COUNTERS, counterValues);
+
+	MaskedPayload measurementValues;
+	for (uint measurement = 0; measurement != NUMBER_OF_MEASUREMENTS; measurement++) {
+		measurementValues.add(measurement, measurements[measurement].get(info));
+	}
+	fits &= writeMaskedSection(area, offset, area_size, TAG_MEASUREMENTS, measurementValues);
+
+	const uint16_t length = fits ? offset - sizeof(ResultHeader) : 0;
+	std::memcpy(area + offsetof(ResultHeader, length), &length, sizeof(uint16_t));
+	area[offsetof(ResultHeader, version)] = RESULT_RECORD_VERSION;
+	return fits;
+}
+
+bool TriggerMessageCodec::decodeResult(const char* area, const uint area_size, TriggerMessager& trigger_message) {
+	ResultHeader header;
+	std::memcpy(&header, area, sizeof(ResultHeader));
+	trigger_message.dispatch_time_micros = header.dispatch_time_micros;
+	if (header.version != RESULT_RECORD_VERSION || sizeof(ResultHeader) + header.length > area_size) {
+		return false;
+	}
+
+	L1InfoToStorage& info = trigger_message.l1Info;
+	uint offset = sizeof(ResultHeader);
+	const uint end = sizeof(ResultHeader) + header.length;
+	while (offset != end) {
+		if (offset + SECTION_HEADER_SIZE > end) {
+			return false;
+		}
+		const uint8_t tag = area[offset];
+		const uint length = (uint8_t) area[offset + 1];
+		const char* payload = area + offset + SECTION_HEADER_SIZE;
+		offset += SECTION_HEADER_SIZE + length;
+		if (offset > end) {
+			return false;
+		}
+
+		bool valid = true;
+		if (tag == TAG_TRIGGER_WORDS) {
+			valid = readMaskedPayload(payload, length, sizeof(uint8_t), trigger_message.l1TriggerWords.size(),
+					[&](uint mask, const char* value) {trigger_message.l1TriggerWords[mask] = (uint8_t) *value;});
+		} else if (tag >= TAG_CHOD_WORDS && tag < TAG_CHOD_WORDS + NUMBER_OF_DETECTOR_WORDS) {
+			const WordSetter setter = wordSetters[tag - TAG_CHOD_WORDS];
+			valid = readMaskedPayload(payload, length, sizeof(uint8_t), 16,
+					[&](uint mask, const char* value) {(info.*setter)(mask, (uint8_t) *value);});
+		} else if (tag == TAG_FLAGS) {
+			uint32_t flagBits;
+			valid = length == sizeof(uint32_t);
+			if (valid) {
+				std::memcpy(&flagBits, payload, sizeof(uint32_t));
+				for (uint flag = 0; flag != NUMBER_OF_FLAGS; flag++) {
+					if (flagBits & (1u << flag)) {
+						flags[flag].set(info);
+					}
+				}
+			}
+		} else if (tag == TAG_COUNTERS) {
+			valid = readMaskedPayload(payload, length, sizeof(uint32_t), NUMBER_OF_COUNTERS,
+					[&](uint counter, const char* value) {
+						uint32_t number;
+						std::memcpy(&number, value, sizeof(uint32_t));
+						counters[counter].set(info, number);
+					});
+		} else if (tag == TAG_MEASUREMENTS) {
+			valid = readMaskedPayload(payload, length, sizeof(double), NUMBER_OF_MEASUREMENTS,
+					[&](uint measurement, const char* value) {
+						double number;
+						std::memcpy(&number, value, sizeof(double));
+						measurements[measurement].set(info, number);
+					});
+		}
+		if (!valid) {
+			return false;
+		}
+	}
+	return true;
+}
+
+} /* namespace na62 */
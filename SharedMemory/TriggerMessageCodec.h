@@ -0,0 +1,80 @@
+/*
+ * TriggerMessageCodec.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: NA62 collaboration
+ */
+
+#pragma once
+#ifndef TRIGGERMESSAGECODEC_H_
+#define TRIGGERMESSAGECODEC_H_
+
+#include <sys/types.h>
+#include <cstdint>
+
+#include "structs/TriggerMessager.h"
+
+namespace na62 {
+
+/*
+ * Converts TriggerMessager to the 16 byte TriggerDescriptor sent through the queues and to the result record
+ * written into the result area of the event slot.
+ *
+ * The result record is a fixed header followed by tagged sections of the form [tag][payload length][payload].
+ * Sections with only zeros are not written, so a typical record is a few dozen bytes instead of the full
+ * L1InfoToStorage. Unknown tags are skipped by the decoder
+ */
+class TriggerMessageCodec {
+public:
+	enum DescriptorFlag {
+		TRIGGER_RESULT = 1, L1_WHILE_TIMEOUT = 2, REQUEST_ZERO_SUPPRESSED = 4, HAS_RESULT_RECORD = 8
+	};
+
+	enum SectionTag {
+		TAG_TRIGGER_WORDS = 1,
+		TAG_CHOD_WORDS, // One section per detector up to TAG_NEWCHOD_WORDS
+		TAG_KTAG_WORDS,
+		TAG_LAV_WORDS,
+		TAG_IRCSAC_WORDS,
+		TAG_STRAW_WORDS,
+		TAG_MUV3_WORDS,
+		TAG_NEWCHOD_WORDS,
+		TAG_FLAGS,
+		TAG_COUNTERS,
+		TAG_MEASUREMENTS
+	};
+
+	static const uint8_t RESULT_RECORD_VERSION = 1;
+
+	struct ResultHeader {
+		uint64_t dispatch_time_micros; // Written by the farm and kept by the trigger process
+		uint16_t length; // Bytes of all sections
+		uint8_t version;
+		uint8_t reserved[5];
+	};
+
+	static TriggerDescriptor toDescriptor(const TriggerMessager& trigger_message, const bool has_result_record);
+
+	/*
+	 * Resets all fields of <trigger_message> that are not part of the descriptor
+	 */
+	static void fromDescriptor(const TriggerDescriptor& descriptor, TriggerMessager& trigger_message);
+
+	static void writeDispatchTime(char* area, const uint64_t dispatch_time_micros);
+	static uint64_t readDispatchTime(const char* area);
+
+	/*
+	 * Writes the L1 results of <trigger_message> behind the header of <area>. Returns false if they do not fit
+	 * into <area_size> bytes
+	 */
+	static bool encodeResult(TriggerMessager& trigger_message, char* area, const uint area_size);
+
+	/*
+	 * Fills the L1 results of <trigger_message> from <area>. Returns false if the record is corrupt
+	 */
+	static bool decodeResult(const char* area, const uint area_size, TriggerMessager& trigger_message);
+};
+
+} /* namespace na62 */
+
+#endif /* TRIGGERMESSAGECODEC_H_ */
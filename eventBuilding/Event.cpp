@@ -11,12 +11,14 @@
 #include <sys/types.h>
 #include <cstdbool>
 #include <functional>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
 #include <array>
 
+#include "../monitoring/ArrivalSkewStatistics.h"
 #include "../monitoring/DetectorStatistics.h"
 #include "../exceptions/CommonExceptions.h"
 #include "../l0/MEP.h"
@@ -30,45 +32,45 @@
 #include "../structs/L0TPHeader.h"
 #include "../utils/DataDumper.h"
 #include "EventPool.h"
+#include "EventTimeoutWheel.h"
 #include "UnfinishedEventsCollector.h"
 #include <structs/LkrCrateSlotDecoder.h>
 
 namespace na62 {
 
 //std::atomic<uint64_t>** Event::ReceivedEventsBySourceNumBySubId_;
-std::atomic<uint64_t>* Event::MissingEventsBySourceNum_;
-std::atomic<uint64_t>* Event::MissingL1EventsBySourceNum_;
+DynamicShardedCounters Event::MissingEventsBySourceNum_[NA62_BURST_BANKS];
+DynamicShardedCounters Event::MissingL1EventsBySourceNum_[NA62_BURST_BANKS];
+std::shared_ptr<const MissingFragmentsSnapshot> Event::sealedMissingFragments_;
 std::atomic<uint64_t> Event::nonRequestsL1FramesReceived_;
 bool Event::printCompletedSourceIDs_ = false;
 
 Event::Event(uint_fast32_t eventNumber) :
 		eventNumber_(eventNumber), numberOfL0Fragments_(0), numberOfMEPFragments_(0), burstID_(0), triggerTypeWord_(0), triggerFlags_(0), triggerDataType_(
 				0), timestamp_(0), finetime_(0), SOBtimestamp_(0), processingID_(0), requestZeroSuppressedCreamData_(
-		false), nonZSuppressedDataRequestedNum(0), L1Processed_(false), L2Accepted_(
-		false), unfinished_(false), lastEventOfBurst_(false), l1CallCounter_(0)
+		false), nonZSuppressedDataRequestedNum(0), nonSuppressedLkrFragments_(nullptr), L1Processed_(false), L2Accepted_(
+		false), unfinished_(false), lastEventOfBurst_(false), l1CallCounter_(0), insertionState_(0)
 #ifdef MEASURE_TIME
+				, firstEventPartAddedTicks_(0) //We'll start the first time addL0Event is called
 				, l0BuildingTime_(0), l1ProcessingTime_(0), l1BuildingTime_(0), l2ProcessingTime_(0)
 #endif
 {
-#ifdef MEASURE_TIME
-	firstEventPartAddedTime_.stop(); //We'll start the first time addL0Event is called
-#endif
 
 	resetTriggerWords();
 
 	/*
 	 * Initialize subevents at the existing sourceIDs as position
 	 */
-	L0Subevents = new l0::Subevent*[SourceIDManager::NUMBER_OF_L0_DATA_SOURCES];
-	for (int i = SourceIDManager::NUMBER_OF_L0_DATA_SOURCES - 1; i >= 0; i--) {
+	L0Subevents = new l0::Subevent*[SourceIDManager::getNumberOfL0DataSources()];
+	for (int i = SourceIDManager::getNumberOfL0DataSources() - 1; i >= 0; i--) {
 		/*
 		 * Initialize subevents[sourceID] with new Subevent(Number of expected Events)
 		 */
 		L0Subevents[i] = new l0::Subevent(SourceIDManager::getExpectedPacksBySourceNum(i), SourceIDManager::sourceNumToID(i));
 	}
 
-	L1Subevents = new l1::Subevent*[SourceIDManager::NUMBER_OF_L1_DATA_SOURCES];
-	for (int i = SourceIDManager::NUMBER_OF_L1_DATA_SOURCES - 1; i >= 0; i--) {
+	L1Subevents = new l1::Subevent*[SourceIDManager::getNumberOfL1DataSources()];
+	for (int i = SourceIDManager::getNumberOfL1DataSources() - 1; i >= 0; i--) {
 		/*
 		 * Initialize subevents[sourceID] with new Subevent(Number of expected Events)
 		 */
@@ -80,15 +82,19 @@ Event::Event(EVENT_HDR* serializedEvent, bool onlyL0) :
 		eventNumber_(serializedEvent->eventNum), numberOfL0Fragments_(0), numberOfMEPFragments_(0), burstID_(serializedEvent->burstID), triggerTypeWord_(
 				serializedEvent->triggerWord), triggerFlags_(0), triggerDataType_(0), timestamp_(serializedEvent->timestamp), finetime_(
 				serializedEvent->fineTime), SOBtimestamp_(serializedEvent->SOBtimestamp), processingID_(serializedEvent->processingID), requestZeroSuppressedCreamData_(
-				false), nonZSuppressedDataRequestedNum(0), L1Processed_(false), L2Accepted_(false), unfinished_(false), lastEventOfBurst_(
-				false),is_mep_header_corrupted_(false) {
+				false), L1Subevents(nullptr), nonZSuppressedDataRequestedNum(0), nonSuppressedLkrFragments_(nullptr), L1Processed_(false), isL1Requested_(
+				false), l0CallCounter_(0), l1CallCounter_(0), L2Accepted_(false), unfinished_(false), lastEventOfBurst_(false),is_mep_header_corrupted_(false), insertionState_(0)
+#ifdef MEASURE_TIME
+				, firstEventPartAddedTicks_(0)
+#endif
+{
 
 	//std::cout << "Creating event with ID " << (int) eventNumber_ << std::endl;
 
 	resetTriggerWords();
 
 	// Helper variables to navigate through serialized event;
-	//uint sizeOfPointerTable = 4 * (SourceIDManager::NUMBER_OF_L0_DATA_SOURCES + SourceIDManager::NUMBER_OF_L1_DATA_SOURCES);
+	//uint sizeOfPointerTable = 4 * (SourceIDManager::getNumberOfL0DataSources() + SourceIDManager::getNumberOfL1DataSources());
 	//uint pointerTableOffset = sizeof(EVENT_HDR);
 	//uint eventOffset = sizeof(EVENT_HDR) + sizeOfPointerTable;
 
@@ -99,8 +105,8 @@ Event::Event(EVENT_HDR* serializedEvent, bool onlyL0) :
 	/*
 	 * Initialize subevents at the existing sourceIDs as position for L0 detectors
 	 */
-	L0Subevents = new l0::Subevent*[SourceIDManager::NUMBER_OF_L0_DATA_SOURCES];
-	for (int i = SourceIDManager::NUMBER_OF_L0_DATA_SOURCES - 1; i >= 0; i--) {
+	L0Subevents = new l0::Subevent*[SourceIDManager::getNumberOfL0DataSources()];
+	for (int i = SourceIDManager::getNumberOfL0DataSources() - 1; i >= 0; i--) {
 		/*
 		 * Initialize subevents[sourceID] with new Subevent(Number of expected Events)
 		 */
@@ -112,7 +118,7 @@ Event::Event(EVENT_HDR* serializedEvent, bool onlyL0) :
 	//std::cout << "Now populate the fragments" << std::endl;
 
 	EVENT_DATA_PTR* sourceIdAndOffsets = serializedEvent->getDataPointer();
-	for (int sourceNum = 0; sourceNum != SourceIDManager::NUMBER_OF_L0_DATA_SOURCES; sourceNum++) {
+	for (int sourceNum = 0; sourceNum != SourceIDManager::getNumberOfL0DataSources(); sourceNum++) {
 		EVENT_DATA_PTR sourceIdAndOffset = sourceIdAndOffsets[sourceNum];
 		//std::cout << "Found detector " << std::hex << (int) sourceIdAndOffset.sourceID << " Starting at: " << std::dec << sourceIdAndOffset.offset << " in the serialized event." << std::dec << std::endl;
 		const char* detectorData = serializedBuf + (sourceIdAndOffset.offset * 4);
@@ -126,6 +132,8 @@ Event::Event(EVENT_HDR* serializedEvent, bool onlyL0) :
 			//std::cout << "Create MEPFragment " << j << " and size " << (int) l0b->dataBlockSize << " with subID 0x" << std::hex << (int) l0b->sourceSubID << std::dec << std::endl;
 			l0::MEPFragment * myFrag = new l0::MEPFragment(fragData, eventNumber_, sourceIdAndOffset.sourceID, l0b->sourceSubID);
 			se->addFragment(myFrag);
+			// Counted like addL0Fragment calls so that destroy() frees the fragments
+			l0CallCounter_.fetch_add(1, std::memory_order_relaxed);
 			//std::cout << "Added fragment to subevent 0x" << std::hex << (int) se->getSourceID() << std::dec << std::endl;
 			fragOffset += l0b->dataBlockSize;
 		}
@@ -136,16 +144,16 @@ Event::Event(EVENT_HDR* serializedEvent, bool onlyL0) :
 		 * Initialize subevents at the existing sourceIDs as position for L1 detectors
 		 */
 
-		L1Subevents = new l1::Subevent*[SourceIDManager::NUMBER_OF_L1_DATA_SOURCES];
-		for (int i = SourceIDManager::NUMBER_OF_L1_DATA_SOURCES - 1; i >= 0; i--) {
+		L1Subevents = new l1::Subevent*[SourceIDManager::getNumberOfL1DataSources()];
+		for (int i = SourceIDManager::getNumberOfL1DataSources() - 1; i >= 0; i--) {
 			/*
 			 * Initialize subevents[sourceID] with new Subevent(Number of expected Events)
 			 */
 			L1Subevents[i] = new l1::Subevent(SourceIDManager::getExpectedL1PacksBySourceNum(i), SourceIDManager::l1SourceNumToID(i));
 		}
 
-		for (int sourceNum = SourceIDManager::NUMBER_OF_L0_DATA_SOURCES;
-				sourceNum != SourceIDManager::NUMBER_OF_L0_DATA_SOURCES + SourceIDManager::NUMBER_OF_L1_DATA_SOURCES; sourceNum++) {
+		for (int sourceNum = SourceIDManager::getNumberOfL0DataSources();
+				sourceNum != SourceIDManager::getNumberOfL0DataSources() + SourceIDManager::getNumberOfL1DataSources(); sourceNum++) {
 			EVENT_DATA_PTR sourceIdAndOffset = sourceIdAndOffsets[sourceNum];
 			const char* detectorData = serializedBuf + (sourceIdAndOffset.offset * 4);
 			l1::Subevent * se = L1Subevents[SourceIDManager::l1SourceIDToNum(sourceIdAndOffset.sourceID)];
@@ -163,32 +171,78 @@ Event::Event(EVENT_HDR* serializedEvent, bool onlyL0) :
 
 Event::~Event() {
 	LOG_INFO("Destructor of Event "<< (int) this->getEventNumber());
+	LkrFragmentTable* lkrFragments = nonSuppressedLkrFragments_.exchange(nullptr);
+	if (lkrFragments != nullptr) {
+		LkrFragmentTable::release(lkrFragments);
+	}
 
 }
 
 void Event::initialize(bool printCompletedSourceIDs) {
 
 	Event::printCompletedSourceIDs_ = printCompletedSourceIDs;
-	Event::MissingEventsBySourceNum_ = new std::atomic<uint64_t>[SourceIDManager::NUMBER_OF_L0_DATA_SOURCES];
-	Event::MissingL1EventsBySourceNum_ = new std::atomic<uint64_t>[SourceIDManager::NUMBER_OF_L1_DATA_SOURCES];
-	resetCounters();
-
+#ifdef MEASURE_TIME
+	TscClock::calibrate();
+#endif
+	for (uint bank = 0; bank != NA62_BURST_BANKS; bank++) {
+		Event::MissingEventsBySourceNum_[bank].init(SourceIDManager::getNumberOfL0DataSources());
+		Event::MissingL1EventsBySourceNum_[bank].init(SourceIDManager::getNumberOfL1DataSources());
+	}
+	UnfinishedEventsCollector::initialize();
+	EventLatencyStatistics::initialize();
+	resetBanks();
+
+	static std::once_flag sealListenerFlag;
+	std::call_once(sealListenerFlag, []() {
+		BurstIdHandler::addBurstSealListener(&Event::sealBurst);
+	});
 }
 void Event::resetCounters() {
-	for (size_t i = 0; i != SourceIDManager::NUMBER_OF_L0_DATA_SOURCES; ++i)
-		MissingEventsBySourceNum_[i] = 0;
-	for (size_t i = 0; i != SourceIDManager::NUMBER_OF_L1_DATA_SOURCES; ++i)
-		MissingL1EventsBySourceNum_[i] = 0;
+}
+
+void Event::resetBanks() {
+	for (uint bank = 0; bank != NA62_BURST_BANKS; bank++) {
+		MissingEventsBySourceNum_[bank].reset();
+		MissingL1EventsBySourceNum_[bank].reset();
+	}
+	std::atomic_store(&sealedMissingFragments_, std::shared_ptr<const MissingFragmentsSnapshot>());
+}
+
+void Event::sealBurst(const uint_fast32_t burstID, const uint_fast32_t nextBurstID) {
+	const uint bank = BurstIdHandler::getBank(burstID);
+	std::shared_ptr<MissingFragmentsSnapshot> snapshot = std::make_shared<MissingFragmentsSnapshot>();
+	snapshot->burstID = burstID;
+	for (uint sourceNum = 0; sourceNum != SourceIDManager::getNumberOfL0DataSources(); sourceNum++) {
+		snapshot->missingL0Events.push_back(MissingEventsBySourceNum_[bank].get(sourceNum));
+	}
+	for (uint sourceNum = 0; sourceNum != SourceIDManager::getNumberOfL1DataSources(); sourceNum++) {
+		snapshot->missingL1Events.push_back(MissingL1EventsBySourceNum_[bank].get(sourceNum));
+	}
+	std::atomic_store(&sealedMissingFragments_, std::shared_ptr<const MissingFragmentsSnapshot>(snapshot));
+
+	const uint nextBank = BurstIdHandler::getBank(nextBurstID);
+	MissingEventsBySourceNum_[nextBank].reset();
+	MissingL1EventsBySourceNum_[nextBank].reset();
 }
 
 /**
  * Process data coming from the TEL boards
  */
 bool Event::addL0Fragment(l0::MEPFragment* fragment, uint_fast32_t burstID) {
+	return addL0Fragment(fragment, burstID, fragment->getSourceIDNum());
+}
+
+bool Event::addL0Fragment(l0::MEPFragment* fragment, uint_fast32_t burstID, uint_fast8_t sourceIDNum) {
+	InsertionScope insertion(insertionState_);
 	l0CallCounter_.fetch_add(1, std::memory_order_relaxed);
 #ifdef MEASURE_TIME
-	if (firstEventPartAddedTime_.is_stopped()) {
-		firstEventPartAddedTime_.start();
+	if (firstEventPartAddedTicks_.load(std::memory_order_relaxed) == 0) {
+		uint64_t notStarted = 0;
+		const uint64_t now = TscClock::now();
+		if (firstEventPartAddedTicks_.compare_exchange_strong(notStarted, now,
+				std::memory_order_relaxed)) {
+			EventTimeoutWheel::arm(this, now);
+		}
 	}
 #endif
 	unfinished_ = true;
@@ -216,7 +270,7 @@ bool Event::addL0Fragment(l0::MEPFragment* fragment, uint_fast32_t burstID) {
 		if (burstID > getBurstID()) {
 			if (unfinishedEventMutex_.try_lock()) {
 				LOG_ERROR("Identified non cleared event " << (uint) getEventNumber() << " from previous burst!");
-				EventPool::freeEvent(this);
+				destroyLocked();
 				unfinishedEventMutex_.unlock();
 			} else {
 				/*
@@ -227,7 +281,7 @@ bool Event::addL0Fragment(l0::MEPFragment* fragment, uint_fast32_t burstID) {
 			/*
 			 * Add the event after this or another thread has destroyed this event
 			 */
-			return addL0Fragment(fragment, burstID);
+			return addL0Fragment(fragment, burstID, sourceIDNum);
 		} else if (burstID < getBurstID()) {
 			LOG_ERROR("Received fragment from a previous burst for event " << (uint) getEventNumber());
 			delete fragment;
@@ -235,37 +289,49 @@ bool Event::addL0Fragment(l0::MEPFragment* fragment, uint_fast32_t burstID) {
 		}
 	}
 
-	l0::Subevent* subevent = L0Subevents[fragment->getSourceIDNum()];
+	l0::Subevent* subevent = L0Subevents[sourceIDNum];
 
 	if (!subevent->addFragment(fragment)) {
 		/*
-		 * Already received enough packets from that sourceID! Eliminate fragment
+		 * Already received this subID or the subID is not enabled! Eliminate fragment
 		 */
 #ifdef USE_ERS
 		ers::error(DuplicateFragment(ERS_HERE, SourceIDManager::sourceIdToDetectorName(fragment->getSourceID()), fragment->getSourceSubID(), this->getEventNumber()));
 #else
 		LOG_ERROR(
-				"type = BadEv : Already received all fragments from sourceID 0x" << std::hex << ((int) fragment->getSourceID()) << " sourceSubID 0x" << ((int) fragment->getSourceSubID()) << " for event " << std::dec << (int)(this->getEventNumber()));
+				"type = BadEv : Duplicate or not enabled subID from sourceID 0x" << std::hex << ((int) fragment->getSourceID()) << " sourceSubID 0x" << ((int) fragment->getSourceSubID()) << " for event " << std::dec << (int)(this->getEventNumber()));
 #endif
 		delete fragment;
 		return false;
 	}
 
+	Tracer::trace(TRACE_L0_FRAGMENT_RECEIVED, getBurstID(), eventNumber_, fragment->getSourceID(), fragment->getSourceSubID());
+
 	uint currentValue = numberOfL0Fragments_.fetch_add(1, std::memory_order_release) + 1;
-	//std::cout<<"fragment: "<<currentValue<<" / "<< SourceIDManager::NUMBER_OF_EXPECTED_L0_PACKETS_PER_EVENT << std::endl;
+	if (currentValue == SourceIDManager::getNumberOfExpectedL0PacketsPerEvent()) {
+		Tracer::trace(TRACE_L0_COMPLETE, getBurstID(), eventNumber_);
+	}
 #ifdef MEASURE_TIME
-	bool result = currentValue == SourceIDManager::NUMBER_OF_EXPECTED_L0_PACKETS_PER_EVENT;
-	if (currentValue == SourceIDManager::NUMBER_OF_EXPECTED_L0_PACKETS_PER_EVENT) {
+	if (ArrivalSkewStatistics::isSampled(eventNumber_)) {
+		ArrivalSkewStatistics::record(burstID, sourceIDNum, fragment->getSourceSubID(),
+				getTimeSinceFirstMEPReceived(), currentValue == SourceIDManager::getNumberOfExpectedL0PacketsPerEvent());
+	}
+#endif
+	//std::cout<<"fragment: "<<currentValue<<" / "<< SourceIDManager::getNumberOfExpectedL0PacketsPerEvent() << std::endl;
+#ifdef MEASURE_TIME
+	bool result = currentValue == SourceIDManager::getNumberOfExpectedL0PacketsPerEvent();
+	if (currentValue == SourceIDManager::getNumberOfExpectedL0PacketsPerEvent()) {
 		l0BuildingTime_ = getTimeSinceFirstMEPReceived();
-		if (currentValue > SourceIDManager::NUMBER_OF_EXPECTED_L0_PACKETS_PER_EVENT) {
-			LOG_ERROR("Too many L0 Packets:" << currentValue << "/" << SourceIDManager::NUMBER_OF_EXPECTED_L0_PACKETS_PER_EVENT);
+		EventLatencyStatistics::record(LATENCY_L0_BUILDING, l0BuildingTime_, getBurstID());
+		if (currentValue > SourceIDManager::getNumberOfExpectedL0PacketsPerEvent()) {
+			LOG_ERROR("Too many L0 Packets:" << currentValue << "/" << SourceIDManager::getNumberOfExpectedL0PacketsPerEvent());
 		}
 	}
 	return result;
 
 #else
 	return currentValue
-	== SourceIDManager::NUMBER_OF_EXPECTED_L0_PACKETS_PER_EVENT;
+	== SourceIDManager::getNumberOfExpectedL0PacketsPerEvent();
 #endif
 }
 
@@ -276,37 +342,46 @@ bool Event::storeNonZSuppressedLkrFragemnt(l1::MEPFragment* fragment) {
 
 	const uint_fast16_t crateCREAMID = fragment->getSourceSubID();
 
-	/*
-	 * We were waiting for non zero suppressed data
-	 */
-	auto lb = nonSuppressedLkrFragmentsByCrateCREAMID.lower_bound(crateCREAMID);
+	LkrFragmentTable* table = nonSuppressedLkrFragments_.load(std::memory_order_acquire);
+	if (table == nullptr) {
+		LkrFragmentTable* newTable = LkrFragmentTable::acquire();
+		if (nonSuppressedLkrFragments_.compare_exchange_strong(table, newTable, std::memory_order_acq_rel)) {
+			table = newTable;
+		} else {
+			LkrFragmentTable::release(newTable);
+		}
+	}
 
-	if (lb != nonSuppressedLkrFragmentsByCrateCREAMID.end()
-			&& !(nonSuppressedLkrFragmentsByCrateCREAMID.key_comp()(crateCREAMID, lb->first))) {
+	uint_fast16_t numberOfFragments;
+	switch (table->insert(crateCREAMID, fragment, numberOfFragments)) {
+	case LkrFragmentTable::LKR_INSERTED:
+		return numberOfFragments == nonZSuppressedDataRequestedNum;
+	case LkrFragmentTable::LKR_INVALID_CRATE_SLOT:
+		LOG_ERROR(
+				"Non zero suppressed LKr fragment with EventNumber " << (int) fragment->getEventNumber() << " has the invalid crate/creamID " << std::hex << (int) crateCREAMID << std::dec << "! Dropping the fragment");
+		nonRequestsL1FramesReceived_.fetch_add(1, std::memory_order_relaxed);
+		delete fragment;
+		return false;
+	case LkrFragmentTable::LKR_DUPLICATE:
 		if (unfinishedEventMutex_.try_lock()) {
 			LOG_INFO(
 					"Non zero suppressed LKr event with EventNumber " << (int) fragment->getEventNumber() << ", crate/creamID " << std::hex << (int) fragment->getSourceSubID() << std::dec << " received twice! Will delete the whole event!");
 			nonRequestsL1FramesReceived_.fetch_add(1, std::memory_order_relaxed);
 
-			EventPool::freeEvent(this);
+			destroyLocked();
 			unfinishedEventMutex_.unlock();
 		}
 		delete fragment;
 		return false;
-	} else {
-		/*
-		 * Event does not yet exist -> add it to the map
-		 */
-		nonSuppressedLkrFragmentsByCrateCREAMID.insert(lb, std::map<uint_fast16_t, l1::MEPFragment*>::value_type(crateCREAMID, fragment));
 	}
-// TODO: this must be synchronized
-	return nonSuppressedLkrFragmentsByCrateCREAMID.size() == nonZSuppressedDataRequestedNum;
+	return false;
 }
 
 /**
  * Process data coming from the CREAMs
  */
 bool Event::addL1Fragment(l1::MEPFragment* fragment) {
+	InsertionScope insertion(insertionState_);
 	l1CallCounter_.fetch_add(1, std::memory_order_relaxed);
 
 	if (!L1Processed_) {
@@ -345,11 +420,17 @@ bool Event::addL1Fragment(l1::MEPFragment* fragment) {
 			return false;
 		}
 
+		Tracer::trace(TRACE_L1_FRAGMENT_RECEIVED, getBurstID(), eventNumber_, fragment->getSourceID(), fragment->getSourceSubID());
+
 		uint_fast16_t numberOfMEPFragments = numberOfMEPFragments_.fetch_add(1, std::memory_order_release) + 1;
+		if (numberOfMEPFragments == SourceIDManager::getNumberOfExpectedL1PacketsPerEvent()) {
+			Tracer::trace(TRACE_L1_COMPLETE, getBurstID(), eventNumber_);
+		}
 
 #ifdef MEASURE_TIME
-		if (numberOfMEPFragments == SourceIDManager::NUMBER_OF_EXPECTED_L1_PACKETS_PER_EVENT) {
+		if (numberOfMEPFragments == SourceIDManager::getNumberOfExpectedL1PacketsPerEvent()) {
 			l1BuildingTime_ = getTimeSinceFirstMEPReceived() - (l1ProcessingTime_ + l0BuildingTime_);
+			EventLatencyStatistics::record(LATENCY_L1_BUILDING, l1BuildingTime_, getBurstID());
 //			LOG_INFO("l1BuildingTime_ " << l1BuildingTime_);
 			return true;
 		}
@@ -357,7 +438,7 @@ bool Event::addL1Fragment(l1::MEPFragment* fragment) {
 #else
 
 		return numberOfMEPFragments
-		== SourceIDManager::NUMBER_OF_EXPECTED_L1_PACKETS_PER_EVENT;
+		== SourceIDManager::getNumberOfExpectedL1PacketsPerEvent();
 #endif
 	}
 }
@@ -395,23 +476,41 @@ void Event::resetTriggerWords() {
 }
 
 void Event::destroy() {
-	tbb::spin_mutex::scoped_lock my_lock(destroyMutex_);
+	/*
+	 * The same lock as the expiry by the EventTimeoutWheel (flushUnfinished), so that the burst cleanup
+	 * does not free an event which is being flushed
+	 */
+	tbb::spin_mutex::scoped_lock my_lock(unfinishedEventMutex_);
+	destroyLocked();
+}
+
+void Event::destroyLocked() {
+	Tracer::trace(TRACE_DESTROYED, getBurstID(), eventNumber_);
 	//std::cout << "Event::destroy() for "<< (int) (this->getEventNumber())<< std::endl;
 #ifdef MEASURE_TIME
-	firstEventPartAddedTime_.stop();
+	firstEventPartAddedTicks_ = 0;
 #endif
 
-	for (uint_fast8_t i = 0; i != SourceIDManager::NUMBER_OF_L0_DATA_SOURCES; i++) {
-		L0Subevents[i]->destroy();
+	/*
+	 * Skip the Subevents if no fragment can have been added: every call of addL0Fragment and every L0 fragment
+	 * added by the deserializing constructor is counted. L1 fragments are only stored after L1 processing, which
+	 * the deserializing constructor sets if it adds L1 fragments
+	 */
+	if (l0CallCounter_ != 0) {
+		for (uint_fast8_t i = 0; i != SourceIDManager::getNumberOfL0DataSources(); i++) {
+			L0Subevents[i]->destroy();
+		}
 	}
-	for (uint_fast8_t i = 0; i != SourceIDManager::NUMBER_OF_L1_DATA_SOURCES; i++) {
-		L1Subevents[i]->destroy();
+	if (L1Processed_) {
+		for (uint_fast8_t i = 0; i != SourceIDManager::getNumberOfL1DataSources(); i++) {
+			L1Subevents[i]->destroy();
+		}
 	}
 
-	for (auto& pair : nonSuppressedLkrFragmentsByCrateCREAMID) {
-		delete pair.second;
+	LkrFragmentTable* lkrFragments = nonSuppressedLkrFragments_.exchange(nullptr, std::memory_order_acq_rel);
+	if (lkrFragments != nullptr) {
+		LkrFragmentTable::release(lkrFragments);
 	}
-	nonSuppressedLkrFragmentsByCrateCREAMID.clear();
 
 	reset();
 }
@@ -443,12 +542,38 @@ uint_fast8_t Event::readTriggerTypeWordAndFineTime() {
 	return 1;
 }
 
+bool Event::flushUnfinished(const uint64_t firstEventPartAddedTicks) {
+	if (!unfinishedEventMutex_.try_lock()) {
+		// Another thread is already freeing this event
+		return false;
+	}
+#ifdef MEASURE_TIME
+	if (firstEventPartAddedTicks_.load(std::memory_order_relaxed) != firstEventPartAddedTicks) {
+		// The event has been completed and reused in the meantime
+		unfinishedEventMutex_.unlock();
+		return false;
+	}
+#endif
+
+	updateMissingEventsStats();
+	for (uint_fast8_t sourceNum = 0; sourceNum != SourceIDManager::getNumberOfL0DataSources(); sourceNum++) {
+		l0::Subevent* subevent = getL0SubeventBySourceIDNum(sourceNum);
+		for (uint_fast16_t ifrag = 0; ifrag < subevent->getNumberOfFragments(); ifrag++) {
+			UnfinishedEventsCollector::addReceivedSubSourceIdFromUnfinishedEvent(sourceNum,
+					subevent->getFragment(ifrag)->getSourceSubID());
+		}
+	}
+	destroyLocked();
+	unfinishedEventMutex_.unlock();
+	return true;
+}
+
 void Event::updateMissingEventsStats() {
 
-	for (int sourceNum = SourceIDManager::NUMBER_OF_L0_DATA_SOURCES - 1; sourceNum >= 0; sourceNum--) {
+	for (int sourceNum = SourceIDManager::getNumberOfL0DataSources() - 1; sourceNum >= 0; sourceNum--) {
 		l0::Subevent* subevent = getL0SubeventBySourceIDNum(sourceNum);
 		if (subevent->getNumberOfFragments() != subevent->getNumberOfExpectedFragments()) {
-			MissingEventsBySourceNum_[sourceNum].fetch_add(1, std::memory_order_relaxed);
+			MissingEventsBySourceNum_[BurstIdHandler::getBank(getBurstID())].add(sourceNum, 1);
 //#ifdef USE_ERS
 //			ers::warning(MissingFragments(ERS_HERE, this->getEventNumber(), subevent->getNumberOfExpectedFragments() - subevent->getNumberOfFragments(),
 //							subevent->getNumberOfExpectedFragments(), SourceIDManager::sourceIdToDetectorName(SourceIDManager::sourceNumToID(sourceNum))));
@@ -457,15 +582,15 @@ void Event::updateMissingEventsStats() {
 		int DetId = (int) (SourceIDManager::sourceNumToID(sourceNum));
 		for (uint_fast16_t ifrag = 0; ifrag < subevent->getNumberOfFragments(); ifrag++) {
 			int SubId = (int) (subevent->getFragment(ifrag)->getSourceSubID());
-			DetectorStatistics::incrementL0stat(DetId, SubId);
+			DetectorStatistics::incrementL0stat(DetId, SubId, getBurstID());
 		}
 	}
 
 	if (L1Processed_) {
-		for (int sourceNum = SourceIDManager::NUMBER_OF_L1_DATA_SOURCES - 1; sourceNum >= 0; sourceNum--) {
+		for (int sourceNum = SourceIDManager::getNumberOfL1DataSources() - 1; sourceNum >= 0; sourceNum--) {
 			l1::Subevent* subevent = getL1SubeventBySourceIDNum(sourceNum);
 			if (subevent->getNumberOfFragments() != subevent->getNumberOfExpectedFragments()) {
-				MissingL1EventsBySourceNum_[sourceNum].fetch_add(1, std::memory_order_relaxed);
+				MissingL1EventsBySourceNum_[BurstIdHandler::getBank(getBurstID())].add(sourceNum, 1);
 //#ifdef USE_ERS
 //				ers::warning(MissingFragments(ERS_HERE, this->getEventNumber(), subevent->getNumberOfExpectedFragments() - subevent->getNumberOfFragments(),
 //								subevent->getNumberOfExpectedFragments(), SourceIDManager::sourceIdToDetectorName(SourceIDManager::l1SourceNumToID(sourceNum))));
@@ -476,7 +601,7 @@ void Event::updateMissingEventsStats() {
 				int SubId = (int) (subevent->getFragment(ifrag)->getSourceSubID());
 				int Crate = (SubId >> 5) & 0x3f;
 				int Slot = SubId & 0x1f;
-				DetectorStatistics::incrementL1stat(Crate, Slot);
+				DetectorStatistics::incrementL1stat(Crate, Slot, getBurstID());
 			}
 		}
 	}
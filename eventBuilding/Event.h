@@ -14,17 +14,25 @@
 #include <algorithm>
 #include <cstdint>
 #include <map>
+#include <memory>
 #include <atomic>
 #include <array>
-#ifdef MEASURE_TIME
-#include <boost/timer/timer.hpp>
-#endif
+#include <thread>
+#include <vector>
 #include <boost/noncopyable.hpp>
 #include <tbb/spin_mutex.h>
+#include "LkrFragmentTable.h"
 #include "SourceIDManager.h"
 #include "../structs/Event.h"
 #include "../options/Logging.h"
 #include "../l1/L1InfoToStorage.h"
+#include "../monitoring/BurstIdHandler.h"
+#include "../monitoring/Tracer.h"
+#include "../utils/ThreadShard.h"
+#ifdef MEASURE_TIME
+#include "../monitoring/EventLatencyStatistics.h"
+#include "../utils/TscClock.h"
+#endif
 
 #include <iostream>
 
@@ -42,6 +50,15 @@ class Subevent;
 
 namespace na62 {
 
+/*
+ * Missing fragment counters of one sealed burst, indexed by sourceNum
+ */
+struct MissingFragmentsSnapshot {
+	uint_fast32_t burstID;
+	std::vector<uint64_t> missingL0Events;
+	std::vector<uint64_t> missingL1Events;
+};
+
 class Event: boost::noncopyable {
 public:
 	Event(uint_fast32_t eventNumber_);
@@ -56,6 +73,12 @@ public:
 	 */
 	bool addL0Fragment(l0::MEPFragment* e, uint_fast32_t burstID);
 
+	/*
+	 * Same as above with the sourceID number already resolved by the caller, as done by EventPool::addL0Mep
+	 * once for all fragments of a MEP
+	 */
+	bool addL0Fragment(l0::MEPFragment* e, uint_fast32_t burstID, uint_fast8_t sourceIDNum);
+
 	/*
 	 * DO NOT USE THIS METHOD IF YOUR ARE IMPLEMENTING TRIGGER ALGORITHMS
 	 *
@@ -65,6 +88,8 @@ public:
 
 	/*
 	 * DO NOT USE THIS METHOD IF YOUR ARE IMPLEMENTING TRIGGER ALGORITHMS
+	 *
+	 * Takes unfinishedEventMutex_, so it waits for a running flushUnfinished of this event
 	 */
 	void destroy();
 
@@ -96,10 +121,12 @@ public:
 	void setL1Processed(const uint_fast16_t L0L1TriggerTypeWord) {
 #ifdef MEASURE_TIME
 		l1ProcessingTime_ = getTimeSinceFirstMEPReceived() - l0BuildingTime_;
+		EventLatencyStatistics::record(LATENCY_L1_PROCESSING, l1ProcessingTime_, getBurstID());
 #endif
 
 		triggerTypeWord_ = L0L1TriggerTypeWord;
 		L1Processed_ = true;
+		Tracer::trace(TRACE_L1_PROCESSED, getBurstID(), eventNumber_);
 	}
 
 	/**
@@ -112,6 +139,7 @@ public:
 	void setL2Processed(const uint_fast8_t L2TriggerTypeWord) {
 #ifdef MEASURE_TIME
 		l2ProcessingTime_ = getTimeSinceFirstMEPReceived() - (l1BuildingTime_ + l1ProcessingTime_ + l0BuildingTime_);
+		EventLatencyStatistics::record(LATENCY_L2_PROCESSING, l2ProcessingTime_, getBurstID());
 //		LOG_INFO("*******************l2ProcessingTime_ " << l2ProcessingTime_);
 #endif
 
@@ -119,6 +147,7 @@ public:
 		// Move the L2 trigger type word to the third byte of triggerTypeWord_
 		triggerTypeWord_ |= L2TriggerTypeWord << 16;
 		unfinished_ = false;
+		Tracer::trace(TRACE_L2_PROCESSED, getBurstID(), eventNumber_);
 	}
 
 	uint_fast32_t getEventNumber() const {
@@ -295,6 +324,24 @@ public:
 		return L0Subevents[sourceIDNum];
 	}
 
+	/*
+	 * Prefetch stages of the insertion pipeline in EventPool::addL0Mep/addL1Mep: first all lines of this
+	 * object, then, once these have arrived, the entry of the subevent table that is dereferenced next
+	 */
+	inline void prefetch() const {
+		for (uint offset = 0; offset < sizeof(Event); offset += NA62_CACHE_LINE_SIZE) {
+			__builtin_prefetch(reinterpret_cast<const char*>(this) + offset, 1);
+		}
+	}
+
+	inline void prefetchL0SubeventPointer(const uint_fast8_t sourceIDNum) const {
+		__builtin_prefetch(&L0Subevents[sourceIDNum]);
+	}
+
+	inline void prefetchL1SubeventPointer(const uint_fast8_t sourceIDNum) const {
+		__builtin_prefetch(&L1Subevents[sourceIDNum]);
+	}
+
 	/*
 	 *	See table 50 in the TDR for the source IDs.
 	 */
@@ -386,18 +433,34 @@ public:
 	}
 
 	/**
-	 * Get the received non zero suppressed LKr Event by the crateCREAMID
+	 * Get the received non zero suppressed LKr Event by the crateCREAMID or nullptr if it has not been received
 	 */
 	inline l1::MEPFragment* getNonZSuppressedLkrFragment(const uint_fast16_t crateCREAMID) const {
-		return nonSuppressedLkrFragmentsByCrateCREAMID.at(crateCREAMID);
+		const LkrFragmentTable* table = nonSuppressedLkrFragments_.load(std::memory_order_acquire);
+		return table == nullptr ? nullptr : table->get(crateCREAMID);
 	}
 
 	/**
-	 * Returns the map containing all received non zero suppressed LKR Events.
-	 * The keys are the 16-bit crate-ID and CREAM-ID concatenations
+	 * Returns the table of all received non zero suppressed LKR Events or nullptr if none has been received.
+	 * The keys are the 11-bit crate-ID and CREAM-ID concatenations
+	 */
+	inline const LkrFragmentTable* getNonSuppressedLkrFragmentTable() const {
+		return nonSuppressedLkrFragments_.load(std::memory_order_acquire);
+	}
+
+	/**
+	 * Returns a copy of all received non zero suppressed LKR Events. Prefer getNonSuppressedLkrFragmentTable
+	 * which does not copy
 	 */
 	inline std::map<uint_fast16_t, l1::MEPFragment*> getNonSuppressedLkrFragments() const {
-		return nonSuppressedLkrFragmentsByCrateCREAMID;
+		std::map<uint_fast16_t, l1::MEPFragment*> fragments;
+		const LkrFragmentTable* table = getNonSuppressedLkrFragmentTable();
+		if (table != nullptr) {
+			table->forEach([&fragments](const uint_fast16_t crateCREAMID, l1::MEPFragment* fragment) {
+				fragments.insert(fragments.end(), std::make_pair(crateCREAMID, fragment));
+			});
+		}
+		return fragments;
 	}
 
 	/*
@@ -456,11 +519,21 @@ public:
 	 * Find the missing sourceIDs
 	 */
 	void updateMissingEventsStats();
+	/*
+	 * Counters of the current burst
+	 */
 	static uint_fast64_t getMissingL0EventsBySourceNum(const uint_fast16_t sourceNum) {
-		return MissingEventsBySourceNum_[sourceNum];
+		return MissingEventsBySourceNum_[BurstIdHandler::getBank(BurstIdHandler::getCurrentBurstId())].get(sourceNum);
 	}
 	static uint_fast64_t getMissingL1EventsBySourceNum(const uint_fast16_t sourceNum) {
-		return MissingL1EventsBySourceNum_[sourceNum];
+		return MissingL1EventsBySourceNum_[BurstIdHandler::getBank(BurstIdHandler::getCurrentBurstId())].get(sourceNum);
+	}
+
+	/*
+	 * Counters of the last sealed burst or nullptr
+	 */
+	static std::shared_ptr<const MissingFragmentsSnapshot> getSealedMissingFragments() {
+		return std::atomic_load(&sealedMissingFragments_);
 	}
 
 	std::map<uint, std::vector<uint>> getFilledL0SourceIDs();
@@ -470,12 +543,72 @@ public:
 		return nonRequestsL1FramesReceived_;
 	}
 
+	uint_fast16_t getNumberOfL0Fragments() const {
+		return numberOfL0Fragments_;
+	}
+
+	uint_fast16_t getNumberOfL1Fragments() const {
+		return numberOfMEPFragments_;
+	}
+
+#ifdef MEASURE_TIME
+	/*
+	 * TscClock timestamp of the first fragment or 0. Identifies the current use of this pooled object
+	 */
+	uint64_t getFirstEventPartAddedTicks() const {
+		return firstEventPartAddedTicks_.load(std::memory_order_relaxed);
+	}
+#endif
+
+	/*
+	 * Frees an event that will not be completed anymore: the missing sources are counted, the received
+	 * sourceSubIDs are reported to the UnfinishedEventsCollector and all fragments are deleted.
+	 * Does nothing if the event is being freed by another thread or, if <firstEventPartAddedTicks> does not
+	 * match, if it has been reused in the meantime. Returns true if the event has been freed.
+	 *
+	 * The caller must hold the expiry claim (see claimForExpiry) so that no fragment is added meanwhile
+	 */
+	bool flushUnfinished(const uint64_t firstEventPartAddedTicks);
+
+	/*
+	 * Gives the EventTimeoutWheel exclusive access to the event. Only succeeds while no addL0Fragment or
+	 * addL1Fragment call is running on it; until releaseExpiryClaim() all further calls wait. As the last
+	 * missing fragment might have been added just before, the state of the event must be checked again
+	 * after claiming it
+	 */
+	bool claimForExpiry() {
+		uint_fast32_t idle = 0;
+		return insertionState_.compare_exchange_strong(idle, EXPIRY_CLAIMED, std::memory_order_acquire,
+				std::memory_order_relaxed);
+	}
+
+	void releaseExpiryClaim() {
+		insertionState_.fetch_and(~EXPIRY_CLAIMED, std::memory_order_release);
+	}
+
+	/*
+	 * True if all requested L1 data has been received: all L1 fragments or, if non zero suppressed LKr data
+	 * has been requested, all requested LKr fragments
+	 */
+	bool isL1Complete() const {
+		if (isWaitingForNonZSuppressedLKrData()) {
+			const LkrFragmentTable* table = getNonSuppressedLkrFragmentTable();
+			return table != nullptr && table->size() >= nonZSuppressedDataRequestedNum;
+		}
+		return getNumberOfL1Fragments() >= SourceIDManager::getNumberOfExpectedL1PacketsPerEvent();
+	}
+
 #ifdef MEASURE_TIME
 	/*
 	 * Returns the number of wall microseconds since the first event part has been added to this event
+	 * or 0 if no fragment has been added yet
 	 */
 	u_int32_t getTimeSinceFirstMEPReceived() const {
-		return firstEventPartAddedTime_.elapsed().wall / 1E3;
+		const uint64_t firstEventPartAddedTicks = firstEventPartAddedTicks_.load(std::memory_order_relaxed);
+		if (firstEventPartAddedTicks == 0) {
+			return 0;
+		}
+		return TscClock::ticksToMicros(TscClock::now() - firstEventPartAddedTicks);
 	}
 
 	/*
@@ -515,6 +648,8 @@ public:
 
 	void setSerializationTime() {
 		SerializationTime_ = getTimeSinceFirstMEPReceived() - l1BuildingTime_ - l1ProcessingTime_ - l0BuildingTime_ - l2ProcessingTime_;
+		EventLatencyStatistics::record(LATENCY_SERIALIZATION, SerializationTime_, getBurstID());
+		Tracer::trace(TRACE_SERIALIZED, getBurstID(), eventNumber_);
 	}
 
 	uint_fast16_t getL0CallCounter() const {
@@ -539,9 +674,27 @@ public:
 #endif
 
 	static void initialize(bool printCompletedSourceIDs);
+
+	/*
+	 * Does nothing: the banks are reset by initialize and recycled by sealBurst at the end of a burst.
+	 * Kept for callers resetting the counters at every EOB, which would wipe the burst being sealed
+	 */
 	static void resetCounters();
 
+	/*
+	 * Publishes the missing fragment counters of <burstID> and clears the bank of <nextBurstID>.
+	 * Called by the BurstIdHandler
+	 */
+	static void sealBurst(const uint_fast32_t burstID, const uint_fast32_t nextBurstID);
+
 private:
+	static void resetBanks();
+
+	/*
+	 * destroy() for callers already holding unfinishedEventMutex_, which is not recursive
+	 */
+	void destroyLocked();
+
 	void setBurstID(const uint_fast32_t burstID) {
 		burstID_ = burstID;
 	}
@@ -586,11 +739,10 @@ private:
 	std::atomic<uint_fast16_t> nonZSuppressedDataRequestedNum;
 
 	/*
-	 * zSuppressedLkrFragmentsByLocalCREAMID[SourceIDManager::getLocalCREAMID()] is the cream event fragment of the
-	 * corresponding cream/create
+	 * Allocated with the first non zero suppressed LKr fragment and then kept for the lifetime of the event,
+	 * as only a small fraction of the events ever requests them
 	 */
-
-	std::map<uint_fast16_t, l1::MEPFragment*> nonSuppressedLkrFragmentsByCrateCREAMID;
+	std::atomic<LkrFragmentTable*> nonSuppressedLkrFragments_;
 
 	std::atomic<bool> L1Processed_;
 	std::array<uint_fast8_t, 16> l1TriggerWords_;
@@ -607,17 +759,57 @@ private:
 	std::atomic<uint_fast8_t> lastEventOfBurstSeed_;
 	std::atomic<bool> is_mep_header_corrupted_;
 
-	tbb::spin_mutex destroyMutex_;
+	/*
+	 * Held while the event is destroyed, see destroy() and destroyLocked()
+	 */
 	tbb::spin_mutex unfinishedEventMutex_;
 
-	static std::atomic<uint64_t>* MissingEventsBySourceNum_;
-	static std::atomic<uint64_t>* MissingL1EventsBySourceNum_;
+	/*
+	 * Number of addL0Fragment/addL1Fragment calls running on this event, plus EXPIRY_CLAIMED while the
+	 * EventTimeoutWheel owns it. Not touched by reset() as insertions may be running while the event is recycled
+	 */
+	std::atomic<uint_fast32_t> insertionState_;
+	static const uint_fast32_t EXPIRY_CLAIMED = 0x80000000;
+
+	/*
+	 * Registers an insertion for the lifetime of this object. Waits as long as the event is claimed for expiry
+	 */
+	class InsertionScope {
+	public:
+		explicit InsertionScope(std::atomic<uint_fast32_t>& insertionState) :
+				insertionState_(insertionState) {
+			while (insertionState_.fetch_add(1, std::memory_order_acquire) & EXPIRY_CLAIMED) {
+				insertionState_.fetch_sub(1, std::memory_order_relaxed);
+				while (insertionState_.load(std::memory_order_relaxed) & EXPIRY_CLAIMED) {
+					std::this_thread::yield();
+				}
+			}
+		}
+
+		~InsertionScope() {
+			insertionState_.fetch_sub(1, std::memory_order_release);
+		}
+
+	private:
+		std::atomic<uint_fast32_t>& insertionState_;
+	};
+
+	/*
+	 * Sharded per thread as they are updated for every event by all worker threads.
+	 * Every event is counted in the bank of its burst ID (see HltStatistics)
+	 */
+	static DynamicShardedCounters MissingEventsBySourceNum_[NA62_BURST_BANKS];
+	static DynamicShardedCounters MissingL1EventsBySourceNum_[NA62_BURST_BANKS];
+	static std::shared_ptr<const MissingFragmentsSnapshot> sealedMissingFragments_;
 
 	static std::atomic<uint64_t> nonRequestsL1FramesReceived_;
 	static bool printCompletedSourceIDs_;
 
 #ifdef MEASURE_TIME
-	boost::timer::cpu_timer firstEventPartAddedTime_;
+	/*
+	 * TscClock timestamp of the first fragment, 0 as long as no fragment has been added
+	 */
+	std::atomic<uint64_t> firstEventPartAddedTicks_;
 
 	/*
 	 * Times in microseconds
@@ -13,7 +13,14 @@
 #include <cmath>
 
 #include "../exceptions/CommonExceptions.h"
+#include "../l0/MEP.h"
+#include "../l0/MEPFragment.h"
+#include "../l0/Subevent.h"
+#include "../l1/MEP.h"
+#include "../l1/MEPFragment.h"
+#include "../l1/Subevent.h"
 #include "../options/Logging.h"
+#include "../structs/MEPParseStatus.h"
 
 #include "Event.h"
 
@@ -28,6 +35,65 @@ uint_fast32_t EventPool::mepFactorxNodes_;
 
 std::atomic<uint16_t>* EventPool::L0PacketCounter_;
 std::atomic<uint16_t>* EventPool::L1PacketCounter_;
+std::atomic<uint64_t>* EventPool::touchedEvents_;
+uint_fast32_t EventPool::touchedEventsWords_;
+uint_fast16_t EventPool::prefetchDistance_ = 0;
+
+namespace {
+/*
+ * Number of bitmap words checked at once while scanning: a block of 512 untouched events (one cache line
+ * of the bitmap) is skipped with a single branch
+ */
+const uint_fast32_t TOUCHED_SCAN_BLOCK = 8;
+
+/*
+ * Issues the prefetches of all four pipeline stages for the iteration inserting fragment <i>. Negative
+ * values of <i> fill the pipeline before the first insertion
+ */
+inline void prefetchL0Insertion(Event* const * events, const int i, const int numberOfFragments, const int distance,
+		const uint_fast8_t sourceIDNum) {
+	int ahead = i + 4 * distance;
+	if (ahead >= 0 && ahead < numberOfFragments && events[ahead] != nullptr) {
+		events[ahead]->prefetch();
+	}
+	ahead = i + 3 * distance;
+	if (ahead >= 0 && ahead < numberOfFragments && events[ahead] != nullptr) {
+		events[ahead]->prefetchL0SubeventPointer(sourceIDNum);
+	}
+	ahead = i + 2 * distance;
+	if (ahead >= 0 && ahead < numberOfFragments && events[ahead] != nullptr) {
+		__builtin_prefetch(events[ahead]->getL0SubeventBySourceIDNum(sourceIDNum), 1);
+	}
+	ahead = i + distance;
+	if (ahead >= 0 && ahead < numberOfFragments && events[ahead] != nullptr) {
+		__builtin_prefetch(events[ahead]->getL0SubeventBySourceIDNum(sourceIDNum)->getEventFragments(), 1);
+	}
+}
+
+/*
+ * L1 fragments of one MEP may come from different sources so the sourceID number is taken per fragment
+ */
+inline void prefetchL1Insertion(Event* const * events, l1::MEPFragment* const * fragments, const int i,
+		const int numberOfFragments, const int distance) {
+	int ahead = i + 4 * distance;
+	if (ahead >= 0 && ahead < numberOfFragments && events[ahead] != nullptr) {
+		events[ahead]->prefetch();
+	}
+	ahead = i + 3 * distance;
+	if (ahead >= 0 && ahead < numberOfFragments && events[ahead] != nullptr) {
+		events[ahead]->prefetchL1SubeventPointer(fragments[ahead]->getSourceIDNum());
+	}
+	ahead = i + 2 * distance;
+	if (ahead >= 0 && ahead < numberOfFragments && events[ahead] != nullptr) {
+		__builtin_prefetch(events[ahead]->getL1SubeventBySourceIDNum(fragments[ahead]->getSourceIDNum()), 1);
+	}
+	ahead = i + distance;
+	if (ahead >= 0 && ahead < numberOfFragments && events[ahead] != nullptr) {
+		__builtin_prefetch(
+				events[ahead]->getL1SubeventBySourceIDNum(fragments[ahead]->getSourceIDNum())->getEventFragments(), 1);
+	}
+}
+}
 
 void EventPool::initialize(uint numberOfEventsToBeStored, uint numberOfNodes, uint logicalNodeID, uint mepFactor) {
 	poolSize_ = numberOfEventsToBeStored;
@@ -60,6 +126,13 @@ void EventPool::initialize(uint numberOfEventsToBeStored, uint numberOfNodes, ui
 
 	L0PacketCounter_= new std::atomic<uint16_t>[poolSize_];
 	L1PacketCounter_= new std::atomic<uint16_t>[poolSize_];
+
+	touchedEventsWords_ = (poolSize_ + 63) / 64;
+	touchedEventsWords_ = (touchedEventsWords_ + TOUCHED_SCAN_BLOCK - 1) / TOUCHED_SCAN_BLOCK * TOUCHED_SCAN_BLOCK;
+	touchedEvents_ = new std::atomic<uint64_t>[touchedEventsWords_];
+	for (uint_fast32_t i = 0; i != touchedEventsWords_; i++) {
+		touchedEvents_[i].store(0, std::memory_order_relaxed);
+	}
 }
 
 Event* EventPool::getEvent(uint_fast32_t eventNumber) {
@@ -100,6 +173,7 @@ Event* EventPool::getEvent(uint_fast32_t eventNumber) {
     if (index > largestIndexTouched_) {
     	largestIndexTouched_ = index;
     }
+    markTouched(index);
 
     return events_[index];
 
@@ -109,5 +183,111 @@ void EventPool::freeEvent(Event* event) {
 	event->destroy();
 }
 
+uint_fast16_t EventPool::addL0Mep(l0::MEP* mep, uint_fast32_t burstID, Event** completedEvents) {
+	l0::MEPFragment* fragments[MAX_L0_FRAGMENTS_PER_MEP];
+	Event* events[MAX_L0_FRAGMENTS_PER_MEP];
+
+	/*
+	 * Read everything needed from the MEP before the first insertion might delete it
+	 */
+	const uint_fast16_t numberOfFragments = mep->getNumberOfFragments();
+	const uint_fast8_t sourceIDNum = mep->getSourceIDNum();
+	for (uint_fast16_t i = 0; i != numberOfFragments; i++) {
+		fragments[i] = mep->getFragment(i);
+		events[i] = getEvent(fragments[i]->getEventNumber());
+	}
+
+	const int distance = prefetchDistance_;
+	if (distance != 0) {
+		for (int i = -4 * distance; i != 0; i++) {
+			prefetchL0Insertion(events, i, numberOfFragments, distance, sourceIDNum);
+		}
+	}
+
+	uint_fast16_t numberOfCompletedEvents = 0;
+	for (uint_fast16_t i = 0; i != numberOfFragments; i++) {
+		if (distance != 0) {
+			prefetchL0Insertion(events, i, numberOfFragments, distance, sourceIDNum);
+		}
+		if (events[i] == nullptr) {
+			delete fragments[i];
+			continue;
+		}
+		if (events[i]->addL0Fragment(fragments[i], burstID, sourceIDNum)) {
+			completedEvents[numberOfCompletedEvents++] = events[i];
+		}
+	}
+	return numberOfCompletedEvents;
+}
+
+uint_fast16_t EventPool::addL1Mep(l1::MEP* mep, Event** completedEvents) {
+	l1::MEPFragment* fragments[MAX_L1_FRAGMENTS_PER_MEP];
+	Event* events[MAX_L1_FRAGMENTS_PER_MEP];
+
+	const uint_fast16_t numberOfFragments = mep->getNumberOfEvents();
+	for (uint_fast16_t i = 0; i != numberOfFragments; i++) {
+		fragments[i] = mep->getEvent(i);
+		events[i] = getEvent(fragments[i]->getEventNumber());
+	}
+
+	const int distance = prefetchDistance_;
+	if (distance != 0) {
+		for (int i = -4 * distance; i != 0; i++) {
+			prefetchL1Insertion(events, fragments, i, numberOfFragments, distance);
+		}
+	}
+
+	uint_fast16_t numberOfCompletedEvents = 0;
+	for (uint_fast16_t i = 0; i != numberOfFragments; i++) {
+		if (distance != 0) {
+			prefetchL1Insertion(events, fragments, i, numberOfFragments, distance);
+		}
+		if (events[i] == nullptr) {
+			delete fragments[i];
+			continue;
+		}
+		if (events[i]->addL1Fragment(fragments[i])) {
+			completedEvents[numberOfCompletedEvents++] = events[i];
+		}
+	}
+	return numberOfCompletedEvents;
+}
+
+void EventPool::forEachTouchedEvent(const std::function<void(Event*)>& function, bool clearTouched) {
+	tbb::parallel_for(tbb::blocked_range<uint_fast32_t>(0, touchedEventsWords_ / TOUCHED_SCAN_BLOCK),
+			[&function, clearTouched](const tbb::blocked_range<uint_fast32_t>& r) {
+				for (uint_fast32_t block = r.begin(); block != r.end(); ++block) {
+					const uint_fast32_t firstWord = block * TOUCHED_SCAN_BLOCK;
+
+					uint64_t any = 0;
+					for (uint_fast32_t i = 0; i != TOUCHED_SCAN_BLOCK; i++) {
+						any |= touchedEvents_[firstWord + i].load(std::memory_order_relaxed);
+					}
+					if (any == 0) {
+						continue;
+					}
+
+					for (uint_fast32_t word = firstWord; word != firstWord + TOUCHED_SCAN_BLOCK; word++) {
+						uint64_t bits = clearTouched ?
+						touchedEvents_[word].exchange(0, std::memory_order_acquire) :
+						touchedEvents_[word].load(std::memory_order_acquire);
+						while (bits != 0) {
+							const uint_fast32_t index = word * 64 + __builtin_ctzll(bits);
+							bits &= bits - 1;
+							function(events_[index]);
+						}
+					}
+				}
+			});
+}
+
+uint_fast32_t EventPool::getNumberOfTouchedEvents() {
+	uint_fast32_t touched = 0;
+	for (uint_fast32_t word = 0; word != touchedEventsWords_; word++) {
+		touched += __builtin_popcountll(touchedEvents_[word].load(std::memory_order_relaxed));
+	}
+	return touched;
+}
+
 }
 /* namespace na62 */
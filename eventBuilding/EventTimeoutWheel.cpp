@@ -0,0 +1,174 @@
+/*
+ * EventTimeoutWheel.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: NA62 collaboration
+ */
+
+#include "EventTimeoutWheel.h"
+
+#include <unistd.h>
+
+#include "../utils/TscClock.h"
+#include "Event.h"
+#include "SourceIDManager.h"
+
+namespace na62 {
+
+std::atomic<bool> EventTimeoutWheel::running_(false);
+tbb::concurrent_queue<EventTimeoutWheel::Entry> EventTimeoutWheel::intake_;
+std::function<void(Event*)> EventTimeoutWheel::expiredEventHandler_(nullptr);
+std::atomic<uint64_t> EventTimeoutWheel::expiredL0Events_(0);
+std::atomic<uint64_t> EventTimeoutWheel::expiredL1Events_(0);
+
+EventTimeoutWheel::EventTimeoutWheel(const uint l0TimeoutMillis, const uint l1TimeoutMillis) :
+		l0TimeoutMillis_(l0TimeoutMillis), l1TimeoutMillis_(l1TimeoutMillis), startTicks_(0), tscTicksPerMilli_(
+				1), currentTick_(0) {
+}
+
+EventTimeoutWheel::~EventTimeoutWheel() {
+}
+
+uint64_t EventTimeoutWheel::ticksToWheelTicks(const uint64_t tscTicks) const {
+	// Events started before the wheel are treated as if they started with it
+	return tscTicks <= startTicks_ ? 0 : (tscTicks - startTicks_) / tscTicksPerMilli_;
+}
+
+void EventTimeoutWheel::insert(Entry entry) {
+	if (entry.deadline <= currentTick_) {
+		entry.deadline = currentTick_ + 1;
+	}
+	const uint64_t delta = entry.deadline - currentTick_;
+	if (delta < EVENT_TIMEOUT_WHEEL_SLOTS) {
+		inner_[entry.deadline & (EVENT_TIMEOUT_WHEEL_SLOTS - 1)].push_back(entry);
+		return;
+	}
+
+	/*
+	 * Deadlines beyond the outer wheel are parked in its last slot and checked again when they cascade
+	 */
+	const uint64_t maxDelta = (uint64_t) EVENT_TIMEOUT_WHEEL_SLOTS * (EVENT_TIMEOUT_WHEEL_SLOTS - 1);
+	const uint64_t slotTick = delta < maxDelta ? entry.deadline : currentTick_ + maxDelta;
+	outer_[(slotTick >> EVENT_TIMEOUT_WHEEL_BITS) & (EVENT_TIMEOUT_WHEEL_SLOTS - 1)].push_back(entry);
+}
+
+void EventTimeoutWheel::advance() {
+	currentTick_++;
+
+	if ((currentTick_ & (EVENT_TIMEOUT_WHEEL_SLOTS - 1)) == 0) {
+		std::vector<Entry> cascading;
+		cascading.swap(outer_[(currentTick_ >> EVENT_TIMEOUT_WHEEL_BITS) & (EVENT_TIMEOUT_WHEEL_SLOTS - 1)]);
+		for (const Entry& entry : cascading) {
+			insert(entry);
+		}
+	}
+
+	std::vector<Entry> expired;
+	expired.swap(inner_[currentTick_ & (EVENT_TIMEOUT_WHEEL_SLOTS - 1)]);
+	for (const Entry& entry : expired) {
+		if (entry.deadline > currentTick_) {
+			insert(entry);
+		} else {
+			check(entry);
+		}
+	}
+}
+
+bool EventTimeoutWheel::isCurrent(const Entry& entry) const {
+	// Otherwise freed, reused or already through L2
+	return entry.event->getFirstEventPartAddedTicks() == entry.firstEventPartAddedTicks
+			&& entry.event->isUnfinished();
+}
+
+bool EventTimeoutWheel::isExpired(const Entry& entry, uint64_t& nextDeadline) const {
+	Event* event = entry.event;
+	const uint64_t started = ticksToWheelTicks(entry.firstEventPartAddedTicks);
+	if (event->getNumberOfL0Fragments() < SourceIDManager::getNumberOfExpectedL0PacketsPerEvent()) {
+		nextDeadline = started + l0TimeoutMillis_;
+	} else if (event->isL1Processed() && event->isL1Requested() && !event->isL1Complete()) {
+		nextDeadline = started + l1TimeoutMillis_;
+	} else {
+		// Still being processed: check again later
+		nextDeadline = currentTick_ + l1TimeoutMillis_;
+		return false;
+	}
+	return currentTick_ >= nextDeadline;
+}
+
+void EventTimeoutWheel::check(const Entry& entry) {
+	Event* event = entry.event;
+	if (!isCurrent(entry)) {
+		return;
+	}
+
+	Entry next = entry;
+	if (!isExpired(entry, next.deadline)) {
+		insert(next);
+		return;
+	}
+
+	/*
+	 * Fragments may be added concurrently: only free the event while holding it exclusively and check it
+	 * again, as the last missing fragment might have completed it in the meantime
+	 */
+	if (!event->claimForExpiry()) {
+		next.deadline = currentTick_ + 1;
+		insert(next);
+		return;
+	}
+	if (!isCurrent(entry)) {
+		event->releaseExpiryClaim();
+		return;
+	}
+	if (!isExpired(entry, next.deadline)) {
+		event->releaseExpiryClaim();
+		insert(next);
+		return;
+	}
+
+	if (event->getNumberOfL0Fragments() < SourceIDManager::getNumberOfExpectedL0PacketsPerEvent()) {
+		expiredL0Events_.fetch_add(1, std::memory_order_relaxed);
+	} else {
+		expiredL1Events_.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	if (expiredEventHandler_) {
+		expiredEventHandler_(event);
+	} else {
+		event->flushUnfinished(entry.firstEventPartAddedTicks);
+	}
+	event->releaseExpiryClaim();
+}
+
+void EventTimeoutWheel::thread() {
+	TscClock::calibrate();
+	tscTicksPerMilli_ = TscClock::getTicksPerMicrosecond() * 1000;
+	if (tscTicksPerMilli_ == 0) {
+		tscTicksPerMilli_ = 1;
+	}
+	startTicks_ = TscClock::now();
+	currentTick_ = 0;
+	running_ = true;
+
+	LOG_INFO("Expiring events after " << l0TimeoutMillis_ << " ms without L0 and " << l1TimeoutMillis_ << " ms without L1 data");
+
+	Entry entry;
+	while (running_) {
+		while (intake_.try_pop(entry)) {
+			entry.deadline = ticksToWheelTicks(entry.firstEventPartAddedTicks) + l0TimeoutMillis_;
+			insert(entry);
+		}
+
+		const uint64_t now = ticksToWheelTicks(TscClock::now());
+		while (currentTick_ < now) {
+			advance();
+		}
+		usleep(1000);
+	}
+}
+
+void EventTimeoutWheel::onInterruption() {
+	running_ = false;
+}
+
+} /* namespace na62 */
@@ -0,0 +1,109 @@
+/*
+ * EventTimeoutWheel.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: NA62 collaboration
+ */
+
+#pragma once
+#ifndef EVENTTIMEOUTWHEEL_H_
+#define EVENTTIMEOUTWHEEL_H_
+
+#include <sys/types.h>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include <tbb/concurrent_queue.h>
+
+#include "../utils/AExecutable.h"
+
+#define EVENT_TIMEOUT_WHEEL_BITS 8
+#define EVENT_TIMEOUT_WHEEL_SLOTS (1 << EVENT_TIMEOUT_WHEEL_BITS)
+
+namespace na62 {
+class Event;
+
+/*
+ * Expires events that stay incomplete for too long so that their fragments (and the MEPs they pin) are
+ * released during the burst instead of at the burst cleanup.
+ *
+ * Every event is armed with the timestamp of its first fragment. The thread of this object keeps the
+ * events in a two level timing wheel with a resolution of one millisecond (256 ms inner wheel, 65 s outer
+ * wheel). When the deadline of an event is reached it is checked again:
+ *   - not yet L0 complete for l0TimeoutMillis
+ *   - L1 data requested but not complete for l1TimeoutMillis
+ * Such events are passed to the expired event handler, all others are re-armed until they are freed.
+ * Expiry and fragment insertion exclude each other: the event is claimed with Event::claimForExpiry and
+ * checked again before it is handed to the handler. addL0Fragment/addL1Fragment wait until it is released.
+ *
+ * The default handler calls Event::flushUnfinished. arm() is one push into a concurrent queue.
+ */
+class EventTimeoutWheel: public AExecutable {
+public:
+	EventTimeoutWheel(const uint l0TimeoutMillis, const uint l1TimeoutMillis);
+	virtual ~EventTimeoutWheel();
+
+	static inline void arm(Event* event, const uint64_t firstEventPartAddedTicks) {
+		if (running_.load(std::memory_order_relaxed)) {
+			intake_.push(Entry { event, firstEventPartAddedTicks, 0 });
+		}
+	}
+
+	/*
+	 * Replaces the default handler, e.g. to serialize expired events as incomplete events.
+	 * The handler is called while the event is claimed and must be done with it when it returns.
+	 * Must be set before the thread is started
+	 */
+	static void setExpiredEventHandler(const std::function<void(Event*)>& handler) {
+		expiredEventHandler_ = handler;
+	}
+
+	static uint64_t getExpiredL0Events() {
+		return expiredL0Events_.load(std::memory_order_relaxed);
+	}
+
+	static uint64_t getExpiredL1Events() {
+		return expiredL1Events_.load(std::memory_order_relaxed);
+	}
+
+private:
+	struct Entry {
+		Event* event;
+		uint64_t firstEventPartAddedTicks;
+		uint64_t deadline; // in wheel ticks (ms)
+	};
+
+	virtual void thread();
+	virtual void onInterruption();
+
+	uint64_t ticksToWheelTicks(const uint64_t tscTicks) const;
+	void insert(Entry entry);
+	void advance();
+	void check(const Entry& entry);
+	bool isCurrent(const Entry& entry) const;
+
+	/*
+	 * Returns true if the event of <entry> has timed out, otherwise sets <nextDeadline> to the tick of its next check
+	 */
+	bool isExpired(const Entry& entry, uint64_t& nextDeadline) const;
+
+	const uint l0TimeoutMillis_;
+	const uint l1TimeoutMillis_;
+	uint64_t startTicks_;
+	uint64_t tscTicksPerMilli_;
+	uint64_t currentTick_;
+
+	std::vector<Entry> inner_[EVENT_TIMEOUT_WHEEL_SLOTS];
+	std::vector<Entry> outer_[EVENT_TIMEOUT_WHEEL_SLOTS];
+
+	static std::atomic<bool> running_;
+	static tbb::concurrent_queue<Entry> intake_;
+	static std::function<void(Event*)> expiredEventHandler_;
+	static std::atomic<uint64_t> expiredL0Events_;
+	static std::atomic<uint64_t> expiredL1Events_;
+};
+
+} /* namespace na62 */
+
+#endif /* EVENTTIMEOUTWHEEL_H_ */
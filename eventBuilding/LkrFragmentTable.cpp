@@ -0,0 +1,51 @@
+/*
+ * LkrFragmentTable.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: NA62 collaboration
+ */
+
+#include "LkrFragmentTable.h"
+
+#include "../l1/MEPFragment.h"
+
+namespace na62 {
+
+tbb::concurrent_queue<LkrFragmentTable*> LkrFragmentTable::freeTables_;
+
+LkrFragmentTable::LkrFragmentTable() :
+		numberOfFragments_(0) {
+	for (uint crateSlot = 0; crateSlot != LKR_CRATE_SLOT_ENTRIES; crateSlot++) {
+		entries_[crateSlot].store(nullptr, std::memory_order_relaxed);
+	}
+	for (uint word = 0; word != OCCUPANCY_WORDS; word++) {
+		occupancy_[word].store(0, std::memory_order_relaxed);
+	}
+}
+
+LkrFragmentTable* LkrFragmentTable::acquire() {
+	LkrFragmentTable* table;
+	if (freeTables_.try_pop(table)) {
+		return table;
+	}
+	return new LkrFragmentTable();
+}
+
+void LkrFragmentTable::release(LkrFragmentTable* table) {
+	table->clear();
+	freeTables_.push(table);
+}
+
+void LkrFragmentTable::clear() {
+	for (uint word = 0; word != OCCUPANCY_WORDS; word++) {
+		uint64_t bits = occupancy_[word].exchange(0, std::memory_order_acquire);
+		while (bits != 0) {
+			const uint_fast16_t crateSlot = word * 64 + __builtin_ctzll(bits);
+			bits &= bits - 1;
+			delete entries_[crateSlot].exchange(nullptr, std::memory_order_relaxed);
+		}
+	}
+	numberOfFragments_.store(0, std::memory_order_release);
+}
+
+} /* namespace na62 */
@@ -0,0 +1,121 @@
+/*
+ * LkrFragmentTable.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: NA62 collaboration
+ */
+
+#pragma once
+#ifndef LKRFRAGMENTTABLE_H_
+#define LKRFRAGMENTTABLE_H_
+
+#include <sys/types.h>
+#include <tbb/concurrent_queue.h>
+#include <atomic>
+#include <cstdint>
+
+/*
+ * 6 bit crate and 5 bit slot, see lkr_crate_slot_decoder
+ */
+#define LKR_CRATE_SLOT_ENTRIES 2048
+
+namespace na62 {
+namespace l1 {
+class MEPFragment;
+} /* namespace l1 */
+
+/*
+ * The non zero suppressed LKr fragments of one event indexed by their crate/slot subID.
+ *
+ * Insertion, lookup and the completion count are lock free. Iteration visits the occupancy bitmap, so
+ * its cost scales with the number of stored fragments and nothing is copied.
+ *
+ * Tables are taken from and given back to a shared free list via acquire() and release() and are never
+ * deallocated, so a reader racing with the destruction of its event still reads valid memory.
+ */
+class LkrFragmentTable {
+public:
+	enum InsertResult {
+		LKR_INSERTED, LKR_DUPLICATE, LKR_INVALID_CRATE_SLOT
+	};
+
+	LkrFragmentTable();
+
+	/*
+	 * Returns an empty table from the free list or a new one if the list is empty
+	 */
+	static LkrFragmentTable* acquire();
+
+	/*
+	 * Deletes all stored fragments of <table> and puts it back to the free list
+	 */
+	static void release(LkrFragmentTable* table);
+
+	/*
+	 * Stores <fragment> at <crateSlot> and writes the number of stored fragments including this one to
+	 * <numberOfFragments>. Nothing is stored if the entry is occupied or <crateSlot> is out of range
+	 */
+	inline InsertResult insert(const uint_fast16_t crateSlot, l1::MEPFragment* fragment,
+			uint_fast16_t& numberOfFragments) {
+		if (crateSlot >= LKR_CRATE_SLOT_ENTRIES) {
+			return LKR_INVALID_CRATE_SLOT;
+		}
+		const uint64_t bit = 1ull << (crateSlot % 64);
+		if (occupancy_[crateSlot / 64].fetch_or(bit, std::memory_order_relaxed) & bit) {
+			return LKR_DUPLICATE;
+		}
+		entries_[crateSlot].store(fragment, std::memory_order_release);
+		numberOfFragments = numberOfFragments_.fetch_add(1, std::memory_order_acq_rel) + 1;
+		return LKR_INSERTED;
+	}
+
+	/*
+	 * Returns nullptr if no fragment is stored for <crateSlot>
+	 */
+	inline l1::MEPFragment* get(const uint_fast16_t crateSlot) const {
+		if (crateSlot >= LKR_CRATE_SLOT_ENTRIES) {
+			return nullptr;
+		}
+		return entries_[crateSlot].load(std::memory_order_acquire);
+	}
+
+	inline uint_fast16_t size() const {
+		return numberOfFragments_.load(std::memory_order_acquire);
+	}
+
+	/*
+	 * Calls function(crateSlot, fragment) for every stored fragment in ascending crateSlot order
+	 */
+	template<typename Function>
+	void forEach(Function function) const {
+		for (uint word = 0; word != OCCUPANCY_WORDS; word++) {
+			uint64_t bits = occupancy_[word].load(std::memory_order_acquire);
+			while (bits != 0) {
+				const uint_fast16_t crateSlot = word * 64 + __builtin_ctzll(bits);
+				bits &= bits - 1;
+				l1::MEPFragment* fragment = entries_[crateSlot].load(std::memory_order_acquire);
+				if (fragment != nullptr) {
+					function(crateSlot, fragment);
+				}
+			}
+		}
+	}
+
+	/*
+	 * Deletes all stored fragments. Must not be called concurrently with insert
+	 */
+	void clear();
+
+private:
+	static const uint OCCUPANCY_WORDS = LKR_CRATE_SLOT_ENTRIES / 64;
+
+	std::atomic<l1::MEPFragment*> entries_[LKR_CRATE_SLOT_ENTRIES];
+	std::atomic<uint64_t> occupancy_[OCCUPANCY_WORDS];
+	std::atomic<uint_fast16_t> numberOfFragments_;
+
+	static tbb::concurrent_queue<LkrFragmentTable*> freeTables_;
+};
+
+} /* namespace na62 */
+
+#endif /* LKRFRAGMENTTABLE_H_ */
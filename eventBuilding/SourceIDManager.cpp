@@ -37,12 +37,16 @@ uint_fast16_t * SourceIDManager::L1_DATA_SOURCE_ID_TO_PACKNUM = 0; // Expected p
 uint_fast16_t * SourceIDManager::L1_DATA_SOURCE_NUM_TO_PACKNUM = 0;
 uint_fast16_t SourceIDManager::NUMBER_OF_EXPECTED_L1_PACKETS_PER_EVENT = 0; // The sum of all DATA_SOURCE_ID_TO_PACKNUM entries
 
+uint_fast8_t ** SourceIDManager::L0_SUB_ID_TO_SLOT = 0;
+uint64_t (*SourceIDManager::L0_ENABLED_SUB_IDS)[SourceIDManager::L0_SUB_ID_MASK_WORDS] = 0;
+
 uint_fast8_t SourceIDManager::TS_SOURCEID_NUM;
 bool SourceIDManager::L0TP_ACTIVE = false;
 
 void SourceIDManager::Initialize(const uint_fast16_t timeStampSourceID,
 		std::vector<std::pair<int, int> > l0sourceIDs,
-		std::vector<std::pair<int, int> > l1sourceIDs) {
+		std::vector<std::pair<int, int> > l1sourceIDs,
+		std::vector<std::pair<int, int> > l0SubIDs) {
 
 	/*
 	 * OPTION_DATA_SOURCE_IDS
@@ -103,14 +107,143 @@ void SourceIDManager::Initialize(const uint_fast16_t timeStampSourceID,
 				L1_DATA_SOURCE_NUM_TO_PACKNUM[i];
 	}
 
+	/*
+	 * OPTION_L0_SUB_IDS
+	 */
+	if (l0SubIDs.empty() && Options::Isset(OPTION_L0_SUB_IDS)) {
+		l0SubIDs = Options::GetIntPairList(OPTION_L0_SUB_IDS);
+	}
+	std::vector<std::vector<uint_fast8_t> > subIDsBySourceNum(NUMBER_OF_L0_DATA_SOURCES);
+	for (auto& pair : l0SubIDs) {
+		if (pair.first > LARGEST_L0_DATA_SOURCE_ID || !checkL0SourceID(pair.first) || pair.second < 0
+				|| pair.second > 0xFF) {
+			LOG_ERROR("SubID " << pair.second << " of sourceID 0x" << std::hex << pair.first << " does not belong to a configured L0 source");
+			exit(1);
+		}
+		subIDsBySourceNum[sourceIDToNum(pair.first)].push_back(pair.second);
+	}
+
+	L0_SUB_ID_TO_SLOT = new uint_fast8_t*[NUMBER_OF_L0_DATA_SOURCES];
+	L0_ENABLED_SUB_IDS = new uint64_t[NUMBER_OF_L0_DATA_SOURCES][L0_SUB_ID_MASK_WORDS];
+	for (uint_fast8_t i = 0; i < NUMBER_OF_L0_DATA_SOURCES; i++) {
+		L0_SUB_ID_TO_SLOT[i] = new uint_fast8_t[256];
+		std::vector<uint_fast8_t>& subIDs = subIDsBySourceNum[i];
+		if (subIDs.empty()) {
+			for (uint_fast16_t subID = 0; subID != L0_DATA_SOURCE_NUM_TO_PACKNUM[i]; subID++) {
+				subIDs.push_back(subID);
+			}
+		}
+		if (!setL0SubIDs(i, subIDs)) {
+			exit(1);
+		}
+	}
+
 	L0TP_ACTIVE = SourceIDManager::isL0TPActive();
 	TS_SOURCEID_NUM = sourceIDToNum(timeStampSourceID);
 	if (!SourceIDManager::checkL0SourceID(timeStampSourceID)) {
 		LOG_ERROR("The timestamp reference source ID is not part of the L0SourceIDs list");
 		exit(1);
 	}
+
+#ifdef NA62_STATIC_SOURCE_CONFIG
+	/*
+	 * The compiled in tables are only valid for the configuration they were generated from
+	 */
+	bool matches = NUMBER_OF_L0_DATA_SOURCES == STATIC_NUMBER_OF_L0_DATA_SOURCES
+			&& NUMBER_OF_L1_DATA_SOURCES == STATIC_NUMBER_OF_L1_DATA_SOURCES;
+	for (uint_fast8_t i = 0; matches && i != NUMBER_OF_L0_DATA_SOURCES; i++) {
+		matches = L0_DATA_SOURCE_IDS[i] == STATIC_L0_DATA_SOURCE_IDS[i]
+				&& L0_DATA_SOURCE_NUM_TO_PACKNUM[i] == STATIC_L0_DATA_SOURCE_NUM_TO_PACKNUM[i];
+	}
+	for (uint_fast8_t i = 0; matches && i != NUMBER_OF_L1_DATA_SOURCES; i++) {
+		matches = L1_DATA_SOURCE_IDS[i] == STATIC_L1_DATA_SOURCE_IDS[i]
+				&& L1_DATA_SOURCE_NUM_TO_PACKNUM[i] == STATIC_L1_DATA_SOURCE_NUM_TO_PACKNUM[i];
+	}
+	if (!matches) {
+		LOG_ERROR("The L0/L1 source ID configuration differs from the one compiled in via NA62_STATIC_SOURCE_CONFIG_HEADER");
+		exit(1);
+	}
+#endif
+}
+
+bool SourceIDManager::setL0SubIDs(const uint_fast8_t sourceNum, const std::vector<uint_fast8_t>& subIDs) {
+	const uint_fast8_t sourceID = L0_DATA_SOURCE_IDS[sourceNum];
+	if (subIDs.size() != L0_DATA_SOURCE_NUM_TO_PACKNUM[sourceNum]) {
+		LOG_ERROR(
+				"Got " << subIDs.size() << " subIDs for sourceID 0x" << std::hex << (int) sourceID << std::dec << " which sends " << L0_DATA_SOURCE_NUM_TO_PACKNUM[sourceNum] << " fragments per event");
+		return false;
+	}
+
+	uint_fast8_t subIDToSlot[256];
+	memset(subIDToSlot, NO_SUB_ID_SLOT, sizeof(subIDToSlot));
+	for (uint_fast8_t slot = 0; slot != subIDs.size(); slot++) {
+		if (subIDToSlot[subIDs[slot]] != NO_SUB_ID_SLOT) {
+			LOG_ERROR("SubID " << (int) subIDs[slot] << " of sourceID 0x" << std::hex << (int) sourceID << " is listed twice");
+			return false;
+		}
+		subIDToSlot[subIDs[slot]] = slot;
+	}
+	std::copy(subIDToSlot, subIDToSlot + 256, L0_SUB_ID_TO_SLOT[sourceNum]);
+
+	for (uint word = 0; word != L0_SUB_ID_MASK_WORDS; word++) {
+		L0_ENABLED_SUB_IDS[sourceNum][word] = 0;
+	}
+	for (uint_fast8_t subID : subIDs) {
+		L0_ENABLED_SUB_IDS[sourceNum][subID / 64] |= 1ull << (subID % 64);
+	}
+	return true;
+}
+
+template<typename T>
+static void writeStaticTable(std::ostream& out, const char* type, const char* name, const T* values,
+		const uint size) {
+	out << "constexpr " << type << " " << name << "[" << size << "] = {";
+	for (uint i = 0; i != size; i++) {
+		out << (i % 16 == 0 ? "\n\t\t" : " ") << (uint) values[i] << (i + 1 != size ? "," : "");
+	}
+	out << " };\n";
+}
+
+void SourceIDManager::generateStaticConfigHeader(std::ostream& out) {
+	uint_fast8_t l0IDToNum[256];
+	uint_fast16_t l0IDToPacknum[256];
+	uint_fast8_t l1IDToNum[256];
+	uint_fast16_t l1IDToPacknum[256];
+	for (uint sourceID = 0; sourceID != 256; sourceID++) {
+		const bool l0Valid = sourceID <= LARGEST_L0_DATA_SOURCE_ID && checkL0SourceID(sourceID);
+		l0IDToNum[sourceID] = l0Valid ? L0_DATA_SOURCE_ID_TO_NUM[sourceID] : 0xFF;
+		l0IDToPacknum[sourceID] = l0Valid ? L0_DATA_SOURCE_ID_TO_PACKNUM[sourceID] : 0;
+
+		const bool l1Valid = sourceID <= LARGEST_L1_DATA_SOURCE_ID && checkL1SourceID(sourceID);
+		l1IDToNum[sourceID] = l1Valid ? L1_DATA_SOURCE_ID_TO_NUM[sourceID] : 0xFF;
+		l1IDToPacknum[sourceID] = l1Valid ? L1_DATA_SOURCE_ID_TO_PACKNUM[sourceID] : 0;
+	}
+
+	out << "/*\n * StaticSourceConfig.h\n *\n * Generated by SourceIDManager::generateStaticConfigHeader\n */\n\n";
+	out << "#pragma once\n#ifndef STATICSOURCECONFIG_H_\n#define STATICSOURCECONFIG_H_\n\n";
+	out << "#include <cstdint>\n\n#define NA62_STATIC_SOURCE_CONFIG 1\n\nnamespace na62 {\n";
+	out << "constexpr uint_fast8_t STATIC_NUMBER_OF_L0_DATA_SOURCES = " << (uint) NUMBER_OF_L0_DATA_SOURCES << ";\n";
+	out << "constexpr uint_fast8_t STATIC_NUMBER_OF_L1_DATA_SOURCES = " << (uint) NUMBER_OF_L1_DATA_SOURCES << ";\n";
+	out << "constexpr uint_fast16_t STATIC_NUMBER_OF_EXPECTED_L0_PACKETS_PER_EVENT = "
+			<< NUMBER_OF_EXPECTED_L0_PACKETS_PER_EVENT << ";\n";
+	out << "constexpr uint_fast16_t STATIC_NUMBER_OF_EXPECTED_L1_PACKETS_PER_EVENT = "
+			<< NUMBER_OF_EXPECTED_L1_PACKETS_PER_EVENT << ";\n\n";
+
+	writeStaticTable(out, "uint_fast8_t", "STATIC_L0_DATA_SOURCE_IDS", L0_DATA_SOURCE_IDS, NUMBER_OF_L0_DATA_SOURCES);
+	writeStaticTable(out, "uint_fast16_t", "STATIC_L0_DATA_SOURCE_NUM_TO_PACKNUM", L0_DATA_SOURCE_NUM_TO_PACKNUM,
+			NUMBER_OF_L0_DATA_SOURCES);
+	writeStaticTable(out, "uint_fast8_t", "STATIC_L0_DATA_SOURCE_ID_TO_NUM", l0IDToNum, 256);
+	writeStaticTable(out, "uint_fast16_t", "STATIC_L0_DATA_SOURCE_ID_TO_PACKNUM", l0IDToPacknum, 256);
+	out << "\n";
+	writeStaticTable(out, "uint_fast8_t", "STATIC_L1_DATA_SOURCE_IDS", L1_DATA_SOURCE_IDS, NUMBER_OF_L1_DATA_SOURCES);
+	writeStaticTable(out, "uint_fast16_t", "STATIC_L1_DATA_SOURCE_NUM_TO_PACKNUM", L1_DATA_SOURCE_NUM_TO_PACKNUM,
+			NUMBER_OF_L1_DATA_SOURCES);
+	writeStaticTable(out, "uint_fast8_t", "STATIC_L1_DATA_SOURCE_ID_TO_NUM", l1IDToNum, 256);
+	writeStaticTable(out, "uint_fast16_t", "STATIC_L1_DATA_SOURCE_ID_TO_PACKNUM", l1IDToPacknum, 256);
+	out << "} /* namespace na62 */\n\n#endif /* STATICSOURCECONFIG_H_ */\n";
 }
 
+#ifndef NA62_STATIC_SOURCE_CONFIG
 bool SourceIDManager::checkL0SourceID(const uint_fast8_t sourceID) {
 	if (sourceID > LARGEST_L0_DATA_SOURCE_ID) {
 		return false;
@@ -124,6 +257,7 @@ bool SourceIDManager::checkL1SourceID(const uint_fast8_t sourceID) {
 	}
 	return L1_DATA_SOURCE_ID_TO_NUM[sourceID] != (uint_fast8_t) 0xFF;
 }
+#endif
 
 std::string SourceIDManager::sourceIdToDetectorName(uint_fast8_t sourceID) {
 	switch (sourceID) {
@@ -12,6 +12,8 @@
 #include <cstdint>
 #include <map>
 #include <utility>
+#include <ostream>
+#include <string>
 #include <sys/types.h>
 
 #define SOURCE_ID_CEDAR 0x04
@@ -35,6 +37,16 @@
 #define SOURCE_ID_HASC 0x3C
 #define SOURCE_ID_NSTD 0x4C
 
+/*
+ * For a fixed run configuration the source tables can be compiled in: generate the header with
+ * SourceIDManager::generateStaticConfigHeader and build with
+ * -DNA62_STATIC_SOURCE_CONFIG_HEADER='"path/to/StaticSourceConfig.h"'
+ * All lookups then index constexpr tables and the loops over all sources get constant bounds.
+ * Without the define the runtime tables filled by Initialize are used.
+ */
+#ifdef NA62_STATIC_SOURCE_CONFIG_HEADER
+#include NA62_STATIC_SOURCE_CONFIG_HEADER
+#endif
 
 namespace na62 {
 
@@ -61,6 +73,20 @@ public:
 	static uint_fast16_t * L1_DATA_SOURCE_NUM_TO_PACKNUM;
 	static uint_fast16_t NUMBER_OF_EXPECTED_L1_PACKETS_PER_EVENT; // The sum of all DATA_SOURCE_ID_TO_PACKNUM entries
 
+	/*
+	 * [sourceNum][subID] -> position of the fragment within the L0 subevent, NO_SUB_ID_SLOT for subIDs
+	 * not sending data. Built by Initialize from the l0SubIDs list, sources not listed there use the
+	 * subIDs 0 to expectedPacks-1
+	 */
+	static uint_fast8_t ** L0_SUB_ID_TO_SLOT;
+	static const uint_fast8_t NO_SUB_ID_SLOT = 0xFF;
+
+	/*
+	 * [sourceNum][subID / 64]: bit <subID % 64> is set for every subID with a slot in L0_SUB_ID_TO_SLOT
+	 */
+	static const uint L0_SUB_ID_MASK_WORDS = 4;
+	static uint64_t (*L0_ENABLED_SUB_IDS)[L0_SUB_ID_MASK_WORDS];
+
 	static uint_fast8_t TS_SOURCEID_NUM;
 
 	static bool L0TP_ACTIVE;
@@ -69,10 +95,90 @@ public:
 	 * @param timeStampSourceID The sourceID of the subdetector that should define the timestamp of every event
 	 * @param l0sourceIDs A list of pairs of available sourceIDs and the number of frames coming from each sourceID
 	 * 	@param l1sourceIDs A list of pairs of available sourceIDs and the number of frames coming from each sourceID
+	 * @param l0SubIDs A list of pairs of L0 sourceIDs and one of their subIDs sending data, for sources whose
+	 * 	boards are not numbered 0 to n-1. Every listed source needs exactly as many subIDs as frames. If empty
+	 * 	the list is taken from OPTION_L0_SUB_IDS
 	 */
 	static void Initialize(const uint_fast16_t timeStampSourceID,
 			std::vector<std::pair<int, int> > l0SourceIDs,
-			std::vector<std::pair<int, int> > l1SourceIDs);
+			std::vector<std::pair<int, int> > l1SourceIDs,
+			std::vector<std::pair<int, int> > l0SubIDs = std::vector<std::pair<int, int> >());
+
+	static inline const uint_fast8_t* getL0SubIDToSlot(const uint_fast8_t sourceNum) {
+		return L0_SUB_ID_TO_SLOT[sourceNum];
+	}
+
+	static inline const uint64_t* getL0EnabledSubIDs(const uint_fast8_t sourceNum) {
+		return L0_ENABLED_SUB_IDS[sourceNum];
+	}
+
+	/*
+	 * Writes a header with the current configuration as constexpr tables to be compiled in via
+	 * NA62_STATIC_SOURCE_CONFIG_HEADER. Must be called after Initialize
+	 */
+	static void generateStaticConfigHeader(std::ostream& out);
+
+	/*
+	 * Returns true if the tables are compiled in (NA62_STATIC_SOURCE_CONFIG_HEADER)
+	 */
+	static constexpr bool isStaticConfig() {
+#ifdef NA62_STATIC_SOURCE_CONFIG
+		return true;
+#else
+		return false;
+#endif
+	}
+
+#ifdef NA62_STATIC_SOURCE_CONFIG
+	static constexpr uint_fast8_t getNumberOfL0DataSources() {
+		return STATIC_NUMBER_OF_L0_DATA_SOURCES;
+	}
+
+	static constexpr uint_fast8_t getNumberOfL1DataSources() {
+		return STATIC_NUMBER_OF_L1_DATA_SOURCES;
+	}
+
+	static constexpr uint_fast16_t getNumberOfExpectedL0PacketsPerEvent() {
+		return STATIC_NUMBER_OF_EXPECTED_L0_PACKETS_PER_EVENT;
+	}
+
+	static constexpr uint_fast16_t getNumberOfExpectedL1PacketsPerEvent() {
+		return STATIC_NUMBER_OF_EXPECTED_L1_PACKETS_PER_EVENT;
+	}
+
+	static inline uint_fast16_t getExpectedPacksBySourceNum(
+			const uint_fast8_t sourceNum) {
+		return STATIC_L0_DATA_SOURCE_NUM_TO_PACKNUM[sourceNum];
+	}
+
+	static inline uint_fast16_t getExpectedPacksBySourceID(const uint_fast8_t sourceID) {
+		return STATIC_L0_DATA_SOURCE_ID_TO_PACKNUM[sourceID];
+	}
+
+	static inline uint_fast16_t getExpectedL1PacksBySourceNum(
+			const uint_fast8_t sourceNum) {
+		return STATIC_L1_DATA_SOURCE_NUM_TO_PACKNUM[sourceNum];
+	}
+
+	static inline uint_fast16_t getExpectedL1PacksBySourceID(const uint_fast8_t sourceID) {
+		return STATIC_L1_DATA_SOURCE_ID_TO_PACKNUM[sourceID];
+	}
+#else
+	static inline uint_fast8_t getNumberOfL0DataSources() {
+		return NUMBER_OF_L0_DATA_SOURCES;
+	}
+
+	static inline uint_fast8_t getNumberOfL1DataSources() {
+		return NUMBER_OF_L1_DATA_SOURCES;
+	}
+
+	static inline uint_fast16_t getNumberOfExpectedL0PacketsPerEvent() {
+		return NUMBER_OF_EXPECTED_L0_PACKETS_PER_EVENT;
+	}
+
+	static inline uint_fast16_t getNumberOfExpectedL1PacketsPerEvent() {
+		return NUMBER_OF_EXPECTED_L1_PACKETS_PER_EVENT;
+	}
 
 	static inline uint_fast16_t getExpectedPacksBySourceNum(
 			const uint_fast8_t sourceNum) {
@@ -91,7 +197,7 @@ public:
 	static inline uint_fast16_t getExpectedL1PacksBySourceID(const uint_fast8_t sourceID) {
 		return L1_DATA_SOURCE_ID_TO_PACKNUM[sourceID];
 	}
-
+#endif
 
 	/**
 	 * Returns true if the CEDAR is activated so that it's data is stored in every event from L1 on
@@ -221,6 +327,34 @@ public:
 	 * sourceID must be a valid SourceID! So use checkSourceID if you are not sure!
 	 * 0 <= sourceID < L1_LARGEST_DATA_SOURCE_ID
 	 */
+#ifdef NA62_STATIC_SOURCE_CONFIG
+	static inline uint_fast8_t sourceIDToNum(const uint_fast8_t sourceID) {
+		return STATIC_L0_DATA_SOURCE_ID_TO_NUM[sourceID];
+	}
+
+	static inline uint_fast8_t sourceNumToID(const uint_fast8_t sourceNum) {
+		return STATIC_L0_DATA_SOURCE_IDS[sourceNum];
+	}
+
+	static inline uint_fast8_t l1SourceIDToNum(const uint_fast8_t sourceID) {
+		return STATIC_L1_DATA_SOURCE_ID_TO_NUM[sourceID];
+	}
+
+	static inline uint_fast8_t l1SourceNumToID(const uint_fast8_t sourceNum) {
+		return STATIC_L1_DATA_SOURCE_IDS[sourceNum];
+	}
+
+	/*
+	 * The static tables cover all 256 sourceIDs so no range check is needed
+	 */
+	static inline bool checkL0SourceID(const uint_fast8_t sourceID) {
+		return STATIC_L0_DATA_SOURCE_ID_TO_NUM[sourceID] != (uint_fast8_t) 0xFF;
+	}
+
+	static inline bool checkL1SourceID(const uint_fast8_t sourceID) {
+		return STATIC_L1_DATA_SOURCE_ID_TO_NUM[sourceID] != (uint_fast8_t) 0xFF;
+	}
+#else
 	static inline uint_fast8_t sourceIDToNum(const uint_fast8_t sourceID) {
 		return L0_DATA_SOURCE_ID_TO_NUM[sourceID];
 	}
@@ -254,8 +388,17 @@ public:
 	 * @return bool <true> if the sourceID is correct, <false> else
 	 */
 	static bool checkL1SourceID(const uint_fast8_t sourceID);
+#endif
 
 	static std::string sourceIdToDetectorName(uint_fast8_t sourceID);
+
+private:
+	/*
+	 * Assigns the slots 0 to subIDs.size()-1 of the source to the given subIDs
+	 *
+	 * @return <false> if the list does not fit the configuration
+	 */
+	static bool setL0SubIDs(const uint_fast8_t sourceNum, const std::vector<uint_fast8_t>& subIDs);
 };
 
 } /* namespace na62 */
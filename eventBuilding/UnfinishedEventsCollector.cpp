@@ -7,73 +7,176 @@
 
 #include "UnfinishedEventsCollector.h"
 
-#include <iostream>
-#include <sstream>
+#include <cstring>
+#include <mutex>
 
+#include "../monitoring/BurstIdHandler.h"
 #include "SourceIDManager.h"
 
 namespace na62 {
-std::map<uint, std::map<uint, uint>> UnfinishedEventsCollector::receivedEventsBySubsourceBySourceID;
-
-void UnfinishedEventsCollector::addReceivedSubSourceIdFromUnfinishedEvent(
-		uint sourceNum, uint subSourceID) {
-	auto lb = receivedEventsBySubsourceBySourceID.lower_bound(sourceNum);
-	// Check if The sourceNum already exists
-	if (lb != receivedEventsBySubsourceBySourceID.end()
-			&& !(receivedEventsBySubsourceBySourceID.key_comp()(sourceNum,
-					lb->first))) {
-		/*
-		 *	SourceNum exists -> check if subsourceID exists
-		 */
-		auto lb2 = lb->second.lower_bound(subSourceID);
-		if (lb2 != lb->second.end()
-				&& !(lb->second.key_comp()(sourceNum, lb->first))) {
-			// SubsourceID exists -> increment it's value
-			lb2->second++;
-		} else {
-			// create a new map entry for the subsourceID
-			lb->second.insert(lb2,
-					std::map<uint, uint>::value_type(subSourceID, 1));
+uint UnfinishedEventsCollector::numberOfSources_ = 0;
+std::atomic<uint32_t>* UnfinishedEventsCollector::receivedEvents_ = nullptr;
+std::atomic<uint32_t>* UnfinishedEventsCollector::sealedEvents_ = nullptr;
+std::atomic<uint_fast32_t> UnfinishedEventsCollector::sealedBurstID_(0);
+
+namespace {
+/*
+ * Appends to a fixed buffer and remembers if it was too small
+ */
+class BufferWriter {
+public:
+	BufferWriter(char* buffer, const uint size) :
+			position_(buffer), end_(buffer + size), begin_(buffer), overflow_(false) {
+	}
+
+	void append(const char* string) {
+		const uint length = strlen(string);
+		if (position_ + length > end_) {
+			overflow_ = true;
+			return;
 		}
+		memcpy(position_, string, length);
+		position_ += length;
+	}
+
+	void append(uint number) {
+		char digits[10];
+		uint numberOfDigits = 0;
+		do {
+			digits[numberOfDigits++] = '0' + number % 10;
+			number /= 10;
+		} while (number != 0);
 
-	} else {
-		/*
-		 * Nothing stored for this sourceID -> store new map
-		 */
-		std::map<uint, uint> subsourceAndData;
-		subsourceAndData[subSourceID] = 1;
-		receivedEventsBySubsourceBySourceID.insert(lb,
-				std::map<uint, std::map<uint, uint>>::value_type(sourceNum,
-						subsourceAndData));
+		if (position_ + numberOfDigits > end_) {
+			overflow_ = true;
+			return;
+		}
+		while (numberOfDigits != 0) {
+			*position_++ = digits[--numberOfDigits];
+		}
 	}
+
+	uint length() const {
+		return overflow_ ? 0 : position_ - begin_;
+	}
+
+private:
+	char* position_;
+	char* const end_;
+	char* const begin_;
+	bool overflow_;
+};
 }
 
-std::string UnfinishedEventsCollector::toJson() {
-	std::stringstream stream;
+void UnfinishedEventsCollector::initialize() {
+	numberOfSources_ = 0;
+	delete[] receivedEvents_;
+	delete[] sealedEvents_;
+	receivedEvents_ = new std::atomic<uint32_t>[SourceIDManager::NUMBER_OF_L0_DATA_SOURCES
+			* UNFINISHED_EVENTS_MAX_SUB_IDS];
+	sealedEvents_ = new std::atomic<uint32_t>[SourceIDManager::NUMBER_OF_L0_DATA_SOURCES
+			* UNFINISHED_EVENTS_MAX_SUB_IDS];
+	for (uint i = 0; i != SourceIDManager::NUMBER_OF_L0_DATA_SOURCES * UNFINISHED_EVENTS_MAX_SUB_IDS; i++) {
+		receivedEvents_[i].store(0, std::memory_order_relaxed);
+		sealedEvents_[i].store(0, std::memory_order_relaxed);
+	}
+	numberOfSources_ = SourceIDManager::NUMBER_OF_L0_DATA_SOURCES;
 
-	stream << "{";
+	static std::once_flag sealListenerFlag;
+	std::call_once(sealListenerFlag, []() {
+		BurstIdHandler::addBurstSealListener(&UnfinishedEventsCollector::sealBurst);
+	});
+}
 
-	for (const auto& sourceAndData : receivedEventsBySubsourceBySourceID) {
-		stream << "\""
-				<< (int) SourceIDManager::sourceNumToID(sourceAndData.first)
-				<< "\":{";
+void UnfinishedEventsCollector::reset() {
+	for (uint i = 0; i != numberOfSources_ * UNFINISHED_EVENTS_MAX_SUB_IDS; i++) {
+		receivedEvents_[i].store(0, std::memory_order_relaxed);
+	}
+}
 
-		for (auto& subsourceAndEventNum : sourceAndData.second) {
-			stream << "\"" << subsourceAndEventNum.first << "\":"
-					<< subsourceAndEventNum.second;
-			if (&subsourceAndEventNum != &*(--sourceAndData.second.end())) {
-				stream << ",";
+void UnfinishedEventsCollector::sealBurst(const uint_fast32_t burstID, const uint_fast32_t /*nextBurstID*/) {
+	/*
+	 * Called after the burst cleanup: the events flushed at the end of the burst have already been counted
+	 */
+	for (uint i = 0; i != numberOfSources_ * UNFINISHED_EVENTS_MAX_SUB_IDS; i++) {
+		sealedEvents_[i].store(receivedEvents_[i].exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+	sealedBurstID_ = burstID;
+}
+
+void UnfinishedEventsCollector::forEach(
+		const std::function<void(uint, uint, uint)>& function) {
+	for (uint sourceNum = 0; sourceNum != numberOfSources_; sourceNum++) {
+		for (uint subSourceID = 0; subSourceID != UNFINISHED_EVENTS_MAX_SUB_IDS; subSourceID++) {
+			const uint32_t events = getSealedEvents(sourceNum, subSourceID);
+			if (events != 0) {
+				function(sourceNum, subSourceID, events);
 			}
 		}
+	}
+}
 
-		stream << "}";
+uint UnfinishedEventsCollector::serializeJson(char* buffer, const uint bufferSize) {
+	BufferWriter writer(buffer, bufferSize);
+	writer.append("{");
+	bool firstSource = true;
+	for (uint sourceNum = 0; sourceNum != numberOfSources_; sourceNum++) {
+		bool firstSubSource = true;
+		for (uint subSourceID = 0; subSourceID != UNFINISHED_EVENTS_MAX_SUB_IDS; subSourceID++) {
+			const uint32_t events = getSealedEvents(sourceNum, subSourceID);
+			if (events == 0) {
+				continue;
+			}
+			if (firstSubSource) {
+				writer.append(firstSource ? "\"" : ",\"");
+				writer.append((uint) SourceIDManager::sourceNumToID(sourceNum));
+				writer.append("\":{\"");
+				firstSource = false;
+				firstSubSource = false;
+			} else {
+				writer.append(",\"");
+			}
+			writer.append(subSourceID);
+			writer.append("\":");
+			writer.append(events);
+		}
+		if (!firstSubSource) {
+			writer.append("}");
+		}
+	}
+	writer.append("}");
+	return writer.length();
+}
 
-		if (&sourceAndData != &*(--receivedEventsBySubsourceBySourceID.end())) {
-			stream << ",";
+uint UnfinishedEventsCollector::serializeBinary(char* buffer, const uint bufferSize) {
+	uint length = 0;
+	for (uint sourceNum = 0; sourceNum != numberOfSources_; sourceNum++) {
+		for (uint subSourceID = 0; subSourceID != UNFINISHED_EVENTS_MAX_SUB_IDS; subSourceID++) {
+			const uint32_t events = getSealedEvents(sourceNum, subSourceID);
+			if (events == 0) {
+				continue;
+			}
+			if (length + sizeof(UnfinishedEventsEntry) > bufferSize) {
+				return 0;
+			}
+			UnfinishedEventsEntry* entry = reinterpret_cast<UnfinishedEventsEntry*>(buffer + length);
+			entry->sourceID = SourceIDManager::sourceNumToID(sourceNum);
+			entry->sourceSubID = subSourceID;
+			entry->reserved = 0;
+			entry->events = events;
+			length += sizeof(UnfinishedEventsEntry);
 		}
 	}
-	stream << "}";
-	return stream.str();
+	return length;
+}
+
+std::string UnfinishedEventsCollector::toJson() {
+	/*
+	 * Worst case: every entry takes less than 20 characters
+	 */
+	std::string json(numberOfSources_ * UNFINISHED_EVENTS_MAX_SUB_IDS * 20 + numberOfSources_ * 10 + 2, '\0');
+	json.resize(serializeJson(&json[0], json.size()));
+	return json;
 }
 
 } /* namespace na62 */
@@ -9,20 +9,90 @@
 #define MONITORING_UNFINISHEDEVENTSCOLLECTOR_H_
 
 #include <sys/types.h>
-#include <map>
+#include <atomic>
+#include <cstdint>
+#include <functional>
 #include <string>
 
+/*
+ * sourceSubIDs are 8 bit in the MEP fragment header
+ */
+#define UNFINISHED_EVENTS_MAX_SUB_IDS 256
+
 namespace na62 {
 
+/*
+ * Entry of the binary serialization
+ */
+struct UnfinishedEventsEntry {
+	uint8_t sourceID;
+	uint8_t sourceSubID;
+	uint16_t reserved;
+	uint32_t events;
+}__attribute__ ((__packed__));
+
+/*
+ * Counts the fragments received per sourceNum and sourceSubID for events that have never been completed.
+ * The counters are a preallocated matrix [NUMBER_OF_L0_DATA_SOURCES][UNFINISHED_EVENTS_MAX_SUB_IDS] of
+ * relaxed atomics, so recording is thread safe and never allocates.
+ *
+ * The counts are per burst: at the burst seal they are copied to the sealed matrix and reset. All readers
+ * report the sealed matrix, i.e. the last finished burst including its flushed events.
+ */
 class UnfinishedEventsCollector {
 public:
-	static void addReceivedSubSourceIdFromUnfinishedEvent(uint sourceNum,
-			uint subSourceID);
+	/*
+	 * Must be called after the SourceIDManager has been initialized
+	 */
+	static void initialize();
+
+	static inline void addReceivedSubSourceIdFromUnfinishedEvent(uint sourceNum,
+			uint subSourceID) {
+		if (sourceNum < numberOfSources_ && subSourceID < UNFINISHED_EVENTS_MAX_SUB_IDS) {
+			receivedEvents_[sourceNum * UNFINISHED_EVENTS_MAX_SUB_IDS + subSourceID].fetch_add(1,
+					std::memory_order_relaxed);
+		}
+	}
+
+	/*
+	 * Resets the counters of the running burst. Called by sealBurst
+	 */
+	static void reset();
+
+	static inline uint_fast32_t getSealedBurstID() {
+		return sealedBurstID_;
+	}
 
 	static std::string toJson();
 
+	/*
+	 * Writes {"sourceID":{"subID":events,...},...} with all non zero entries into <buffer> without allocating.
+	 * Returns the number of characters written (no terminating 0) or 0 if the buffer is too small
+	 */
+	static uint serializeJson(char* buffer, const uint bufferSize);
+
+	/*
+	 * Writes one UnfinishedEventsEntry per non zero entry into <buffer>.
+	 * Returns the number of bytes written or 0 if the buffer is too small
+	 */
+	static uint serializeBinary(char* buffer, const uint bufferSize);
+
+	/*
+	 * Calls <function>(sourceNum, subSourceID, numberOfEvents) for every non zero entry
+	 */
+	static void forEach(const std::function<void(uint, uint, uint)>& function);
+
 private:
-	static std::map<uint, std::map<uint, uint>> receivedEventsBySubsourceBySourceID;
+	static void sealBurst(const uint_fast32_t burstID, const uint_fast32_t nextBurstID);
+
+	static inline uint32_t getSealedEvents(const uint sourceNum, const uint subSourceID) {
+		return sealedEvents_[sourceNum * UNFINISHED_EVENTS_MAX_SUB_IDS + subSourceID].load(std::memory_order_relaxed);
+	}
+
+	static uint numberOfSources_;
+	static std::atomic<uint32_t>* receivedEvents_;
+	static std::atomic<uint32_t>* sealedEvents_;
+	static std::atomic<uint_fast32_t> sealedBurstID_;
 };
 
 } /* namespace na62 */
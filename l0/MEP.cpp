@@ -12,11 +12,13 @@
 #include <netinet/udp.h>
 #include <iostream>
 #include <new>
+#include <sstream>
 #include <string>
 
 #include "../exceptions/CommonExceptions.h"
 #include "../exceptions/BrokenPacketReceivedError.h"
 #include "../exceptions/UnknownSourceIDFound.h"
+#include "../monitoring/MEPErrorStatistics.h"
 #include "../options/Options.h"
 #include "MEPFragment.h"
 
@@ -25,66 +27,42 @@ namespace l0 {
 
 MEP::MEP(const char *data, const uint_fast16_t & dataLength,
 		const DataContainer originalData) :
-		originalData_(originalData), rawData_(reinterpret_cast<const MEP_HDR*>(data)), checkSumsVarified_(
-		false) {
-
-	if (dataLength < sizeof(MEP_HDR)) {
-#ifdef USE_ERS
-		std::ostringstream s;
-		s << "Incomplete MEP! Size " << dataLength << " smaller than MEP_HDR!";
-		throw CorruptedMEP(ERS_HERE, s.str());
-#else
-		throw BrokenPacketReceivedError(
-							"type = BadEv : Incomplete MEP! Size " + std::to_string(dataLength) + " smaller than MEP_HDR!"
-									+ std::to_string(dataLength) + " of "
-									+ std::to_string(getLength()) + " bytes");
-#endif
+		originalData_(originalData), rawData_(reinterpret_cast<const MEP_HDR*>(data)), fragments_(
+				nullptr), checkSumsVarified_(false) {
+
+	uint_fast16_t fragmentOffsets[MAX_L0_FRAGMENTS_PER_MEP];
+	const MEPParseStatus status = scanFragments(data, dataLength, fragmentOffsets);
+	if (status != MEPParseStatus::OK) {
+		MEPErrorStatistics::count(MEPErrorStatistics::L0, status,
+				dataLength < sizeof(MEP_HDR) ? MEPErrorStatistics::NO_SOURCE_ID : getSourceID());
+		throwParseError(status, dataLength);
 	}
-	fragments_ = new MEPFragment*[rawData_->eventCount];
-	if (getLength() != dataLength) {
-		if (getLength() > dataLength) {
-#ifdef USE_ERS
-			std::ostringstream s;
-			s<< "BadEv : Incomplete MEP for detector " << std::hex << (uint)getSourceID() << std::dec
-					<< ":"<< (uint) getSourceSubID() << "! Received only " << dataLength << " of "
-					<< getLength() << " bytes";
-			throw CorruptedMEP(ERS_HERE, s.str());
-#else
-			throw BrokenPacketReceivedError(
-					"type = BadEv : Incomplete MEP! Received only "
-							+ std::to_string(dataLength) + " of "
-							+ std::to_string(getLength()) + " bytes");
-#endif
-		} else {
-#ifdef USE_ERS
-			std::ostringstream s;
-			s << "Received MEP longer than 'mep length' field for detector " << std::hex << (uint) getSourceID()
-					<< std::dec << ":" << (uint) getSourceSubID()<< "! Received "
-			  << dataLength << " instead of " << getLength() <<  " bytes";
-			throw CorruptedMEP(ERS_HERE, s.str());
-#else
-			throw BrokenPacketReceivedError(
-					"type = BadEv : Received MEP longer than 'mep length' field! Received "
-							+ std::to_string(dataLength) + " instead of "
-							+ std::to_string(getLength()) + " bytes");
-#endif
-		}
 
-	}
+	initializeMEPFragments(data, fragmentOffsets);
+}
 
-	/*
-	 * Try if the sourceID is correct
-	 *
-	 * TODO: Do we need to check the sourceID? This is quite expensive!
-	 */
-	if (!SourceIDManager::checkL0SourceID(getSourceID())) {
-#ifdef USE_ERS
-		throw UnknownSourceID(ERS_HERE, getSourceID(), getSourceSubID());
-#else
-		throw UnknownSourceIDFound(getSourceID(), getSourceSubID());
-#endif
+MEP::MEP(const char *data, const DataContainer originalData,
+		const uint_fast16_t* fragmentOffsets) :
+		originalData_(originalData), rawData_(reinterpret_cast<const MEP_HDR*>(data)), fragments_(
+				nullptr), checkSumsVarified_(false) {
+	initializeMEPFragments(data, fragmentOffsets);
+}
+
+MEPParseStatus MEP::tryParse(const char *data, const uint_fast16_t dataLength,
+		const DataContainer originalData, MEP*& mep) {
+	uint_fast16_t fragmentOffsets[MAX_L0_FRAGMENTS_PER_MEP];
+	const MEPParseStatus status = scanFragments(data, dataLength, fragmentOffsets);
+	if (status != MEPParseStatus::OK) {
+		mep = nullptr;
+		MEPErrorStatistics::report(MEPErrorStatistics::L0, status,
+				dataLength < sizeof(MEP_HDR) ?
+						MEPErrorStatistics::NO_SOURCE_ID :
+						reinterpret_cast<const MEP_HDR*>(data)->sourceID, dataLength);
+		return status;
 	}
-	initializeMEPFragments(data, dataLength);
+
+	mep = new MEP(data, originalData, fragmentOffsets);
+	return status;
 }
 
 MEP::~MEP() {
@@ -102,53 +80,109 @@ MEP::~MEP() {
 	originalData_.free(); // Here we free the most important buffer used for polling in Receiver.cpp
 }
 
-void MEP::initializeMEPFragments(const char * data,
-	//const uint_fast16_t& dataLength) throw (BrokenPacketReceivedError) {
-		const uint_fast16_t& dataLength) {
-	// The first subevent starts directly after the header -> offset is 12
-	uint_fast16_t offset = sizeof(MEP_HDR);
+MEPParseStatus MEP::scanFragments(const char* data,
+		const uint_fast16_t dataLength, uint_fast16_t* fragmentOffsets) {
+	if (dataLength < sizeof(MEP_HDR)) {
+		return MEPParseStatus::TRUNCATED_HEADER;
+	}
 
-	MEPFragment* newMEPFragment;
-	uint_fast32_t expectedEventNum = getFirstEventNum();
+	const MEP_HDR* hdr = reinterpret_cast<const MEP_HDR*>(data);
+	if (hdr->mepLength > dataLength) {
+		return MEPParseStatus::TRUNCATED_MEP;
+	}
+	if (hdr->mepLength < dataLength) {
+		return MEPParseStatus::OVERSIZED_MEP;
+	}
+
+	/*
+	 * TODO: Do we need to check the sourceID? This is quite expensive!
+	 */
+	if (!SourceIDManager::checkL0SourceID(hdr->sourceID)) {
+		return MEPParseStatus::UNKNOWN_SOURCE_ID;
+	}
+
+	/*
+	 * Walk over all fragment headers. The only early exit is reading beyond the received data,
+	 * all other errors are accumulated and evaluated once after the loop.
+	 */
+	const uint_fast16_t numberOfFragments = hdr->eventCount;
+	const uint_fast8_t firstEventNumLSB = hdr->firstEventNum & 0xFF;
+	uint_fast32_t offset = sizeof(MEP_HDR); // The first subevent starts directly after the header -> offset is 8
+	bool badLength = false;
+	bool badEventNumber = false;
+
+	for (uint_fast16_t i = 0; i != numberOfFragments; i++) {
+		if (offset + sizeof(MEPFragment_HDR) > dataLength) {
+			return MEPParseStatus::TRUNCATED_FRAGMENT;
+		}
+		const MEPFragment_HDR* fragmentHdr = reinterpret_cast<const MEPFragment_HDR*>(data + offset);
+		const uint_fast16_t fragmentLength = fragmentHdr->eventLength_;
+
+		fragmentOffsets[i] = offset;
 
-	for (uint_fast16_t i = 0; i < getNumberOfFragments(); i++) {
 		/*
-		 *  Throws exception if the event number LSB has an unexpected value
+		 * The event number LSB increases by one for every event, possibly wrapping around to zero
 		 */
-		newMEPFragment = new MEPFragment(this,
-				(MEPFragment_HDR*) (data + offset), expectedEventNum);
+		badEventNumber |= fragmentHdr->eventNumberLSB_ != (uint_fast8_t) (firstEventNumLSB + i);
+		badLength |= fragmentLength < sizeof(MEPFragment_HDR);
+		offset += fragmentLength;
+	}
 
+	if (badLength) {
+		return MEPParseStatus::BAD_FRAGMENT_LENGTH;
+	}
+	if (offset > dataLength) {
+		return MEPParseStatus::TRUNCATED_FRAGMENT;
+	}
+	if (badEventNumber) {
+		return MEPParseStatus::BAD_EVENT_NUMBER;
+	}
+	// Check if too many bytes have been transmitted
+	if (offset < dataLength) {
+		return MEPParseStatus::TRAILING_BYTES;
+	}
+	return MEPParseStatus::OK;
+}
+
+void MEP::initializeMEPFragments(const char * data,
+		const uint_fast16_t* fragmentOffsets) {
+	const uint_fast16_t numberOfFragments = getNumberOfFragments();
+	fragments_ = new MEPFragment*[numberOfFragments];
+
+	uint_fast32_t expectedEventNum = getFirstEventNum();
+	for (uint_fast16_t i = 0; i != numberOfFragments; i++) {
+		fragments_[i] = new MEPFragment(this,
+				(const MEPFragment_HDR*) (data + fragmentOffsets[i]), expectedEventNum);
 		expectedEventNum++;
-		fragments_[i] = newMEPFragment;
-		if (newMEPFragment->getDataWithHeaderLength() + offset > dataLength) {
-		std::ostringstream s;
-		s << "Incomplete MEPFragment! Received only " << dataLength << " of "
-		  << offset + newMEPFragment->getDataWithHeaderLength() << " bytes";
+	}
+	eventCount_ = numberOfFragments;
+}
 
+void MEP::throwParseError(const MEPParseStatus status,
+		const uint_fast16_t dataLength) const {
+	if (status == MEPParseStatus::UNKNOWN_SOURCE_ID) {
 #ifdef USE_ERS
-			throw CorruptedMEP(ERS_HERE, s.str());
+		throw UnknownSourceID(ERS_HERE, getSourceID(), getSourceSubID());
 #else
-			throw BrokenPacketReceivedError(s.str());
+		throw UnknownSourceIDFound(getSourceID(), getSourceSubID());
 #endif
-			}
-		offset += newMEPFragment->getDataWithHeaderLength();
 	}
 
-	// Check if too many bytes have been transmitted
-	if (offset < dataLength) {
+	std::ostringstream s;
+	s << "BadEv : " << mepParseStatusToString(status);
+	if (status != MEPParseStatus::TRUNCATED_HEADER) {
+		s << " for detector " << std::hex << (uint) getSourceID() << std::dec
+				<< ":" << (uint) getSourceSubID() << " first event "
+				<< (uint) getFirstEventNum() << "! Received " << dataLength
+				<< " bytes with 'mep length' " << getLength();
+	} else {
+		s << "! Size " << dataLength;
+	}
 #ifdef USE_ERS
-		std::ostringstream s;
-		s << "Sum of MEP events + MEP Header is smaller than expected: " << offset << " instead of " << dataLength;
-		throw CorruptedMEP(ERS_HERE, s.str());
+	throw CorruptedMEP(ERS_HERE, s.str());
 #else
-		throw BrokenPacketReceivedError(
-				"type = BadEv : Sum of MEP events + MEP Header is smaller than expected: "
-						+ std::to_string(offset) + " instead of "
-						+ std::to_string(dataLength));
+	throw BrokenPacketReceivedError("type = " + s.str());
 #endif
-
-	}
-	eventCount_ = rawData_->eventCount;
 }
 
 //bool MEP::verifyChecksums() {
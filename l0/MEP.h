@@ -17,6 +17,7 @@
 #include "../exceptions/BrokenPacketReceivedError.h"
 #include "../exceptions/UnknownSourceIDFound.h"
 #include "../structs/DataContainer.h"
+#include "../structs/MEPParseStatus.h"
 
 namespace na62 {
 class BrokenPacketReceivedError;
@@ -49,10 +50,23 @@ class MEP: private boost::noncopyable {
 public:
 	/**
 	 * Reads the data coming from L0 and initializes the corresponding fields
+	 *
+	 * The whole MEP is validated by scanFragments() before any MEPFragment is created.
+	 * Throws BrokenPacketReceivedError/CorruptedMEP or UnknownSourceIDFound if the MEP is corrupt.
+	 * Use tryParse() on the receiver path instead.
 	 */
 	MEP(const char *data, const uint_fast16_t & dataLength,
 			const DataContainer originalData) ;
 
+	/**
+	 * Exception free version of the constructor: validates the data and on success writes a new
+	 * MEP to <mep>. Otherwise <mep> is set to nullptr, the failure is counted and logged (rate limited)
+	 * by MEPErrorStatistics and the caller still owns <originalData>.
+	 */
+	static MEPParseStatus tryParse(const char *data,
+			const uint_fast16_t dataLength, const DataContainer originalData,
+			MEP*& mep);
+
 	/**
 	 * Frees the data buffer (orignialData) that was created by the Receiver
 	 *
@@ -60,8 +74,15 @@ public:
 	 */
 	virtual ~MEP();
 
-	void initializeMEPFragments(const char* data,
-			const uint_fast16_t& dataLength) ;
+	/**
+	 * Validation pass over the MEP header and all fragment headers. No object is created and
+	 * nothing is thrown: the bounds of every fragment are checked and their offsets within <data>
+	 * are written to <fragmentOffsets> which must provide MAX_L0_FRAGMENTS_PER_MEP entries.
+	 *
+	 * @return MEPParseStatus::OK if the MEP is consistent
+	 */
+	static MEPParseStatus scanFragments(const char* data,
+			const uint_fast16_t dataLength, uint_fast16_t* fragmentOffsets);
 
 	/**
 	 * Returns a pointer to the n'th event within this MEP where 0<=n<getFirstEventNum()
@@ -147,6 +168,21 @@ public:
 //	bool verifyChecksums();
 
 private:
+	/**
+	 * Used by tryParse after the data has been validated successfully
+	 */
+	MEP(const char *data, const DataContainer originalData,
+			const uint_fast16_t* fragmentOffsets);
+
+	/**
+	 * Creates all MEPFragments at the offsets found by scanFragments()
+	 */
+	void initializeMEPFragments(const char* data,
+			const uint_fast16_t* fragmentOffsets);
+
+	void throwParseError(const MEPParseStatus status,
+			const uint_fast16_t dataLength) const;
+
 	std::atomic<int> eventCount_;
 
 	// The whole Ethernet frame
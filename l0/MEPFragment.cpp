@@ -32,40 +32,9 @@ MEPFragment::MEPFragment(MEP* mep, const MEPFragment_HDR *data,
 	 * mode must respond to all L0 triggers, for each following event in the MEP, this number should
 	 * increase by one, possibly wrapping around to zero (in which case the upper 8 bits of the event
 	 * number are those in the MEP header incremented by one).
+	 *
+	 * The LSB has already been checked for all fragments by MEP::scanFragments()
 	 */
-	if (rawData->eventNumberLSB_ != (expectedEventNum & 0x000000FF)
-        ){
-		LOG_INFO("++++++++++++++MEP SourceID " << (uint)(mep->getSourceID()));
-		LOG_INFO("++++++++++++++MEP SourceSubID " << (uint)(mep->getSourceIDNum()));
-		LOG_INFO("++++++++++++++MEP Length " << (uint)(mep->getLength()));
-		LOG_INFO("++++++++++++++MEP FirstEvtNum " << (uint)(mep->getFirstEventNum()));
-		LOG_INFO("++++++++++++++MEP mepFactor " << (uint)(mep->getNumberOfFragments()));
-		LOG_INFO("++++++++++++++ExpEvtNum " << (uint)expectedEventNum);
-
-		int* d=(int*)data;
-		for (uint ilength = 0; ilength < sizeof(MEPFragment_HDR)/4;
-				ilength++) {
-			LOG_INFO("++++++++++++MEP fragment (sizeof(MEPFragment_HDR)) " << (int)(sizeof(MEPFragment_HDR))
-			<< " index " << (int) ilength
-			<< " data " << std::hex << *d << std::dec);
-			d++;
-		}
-	}
-	if (rawData->eventNumberLSB_ != (expectedEventNum & 0x000000FF)) {
-#ifdef USE_ERS
-		std::ostringstream s;
-		s << "MEPFragment with bad event number LSB received: received "<< rawData->eventNumberLSB_
-		  << " but expected LSB is " << (expectedEventNum & 0x000000FF);
-		throw CorruptedMEP(ERS_HERE, s.str());
-#else
-		throw BrokenPacketReceivedError(
-				"MEPFragment with bad event number LSB received: received "
-				+ std::to_string(
-						(int) rawData->eventNumberLSB_)
-				+ " but expected LSB is "
-				+ std::to_string(expectedEventNum & 0x000000FF));
-#endif
-	}
 }
 
 MEPFragment::MEPFragment(const MEPFragment_HDR* data, uint32_t expectedEventNum, uint8_t sourceID, uint8_t sourceSubID):
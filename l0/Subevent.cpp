@@ -16,22 +16,36 @@ namespace l0 {
 
 Subevent::Subevent(const uint_fast16_t expectedPacketsNum, const uint_fast8_t sourceID) :
 		expectedPacketsNum(expectedPacketsNum), sourceID(sourceID), eventFragments(
-				new (std::nothrow) MEPFragment*[expectedPacketsNum]), fragmentCounter(
+				new (std::nothrow) MEPFragment*[expectedPacketsNum]), fragmentsBySlot(
+				new (std::nothrow) std::atomic<MEPFragment*>[expectedPacketsNum]), subIDToSlot(
+				SourceIDManager::getL0SubIDToSlot(SourceIDManager::sourceIDToNum(sourceID))), enabledSubIDs(
+				SourceIDManager::getL0EnabledSubIDs(SourceIDManager::sourceIDToNum(sourceID))), fragmentCounter(
 				0) {
+	for (uint word = 0; word != SUB_ID_MASK_WORDS; word++) {
+		receivedSubIDs[word] = 0;
+	}
+	for (uint_fast16_t slot = 0; slot != expectedPacketsNum; slot++) {
+		fragmentsBySlot[slot].store(nullptr, std::memory_order_relaxed);
+	}
 }
 
 Subevent::~Subevent() {
 //	throw NA62Error("A Subevent-Object should not be deleted! Use Subevent::destroy instead so that it can be reused by the overlaying Event!");
 	destroy();
 	delete[] eventFragments;
+	delete[] fragmentsBySlot;
 }
 
 void Subevent::destroy() {
 	for (uint_fast16_t i = 0; i != fragmentCounter; i++) {
+		fragmentsBySlot[subIDToSlot[eventFragments[i]->getSourceSubID()]].store(nullptr, std::memory_order_relaxed);
 		delete eventFragments[i];
 		eventFragments[i] = nullptr;
 	}
 	fragmentCounter = 0;
+	for (uint word = 0; word != SUB_ID_MASK_WORDS; word++) {
+		receivedSubIDs[word].store(0, std::memory_order_relaxed);
+	}
 }
 } /* namespace l0 */
 } /* namespace na62 */
@@ -32,28 +32,44 @@ public:
 	/**
 	 * If the Subevent is not complete yet the given fragment will be stored and true is returned.
 	 *
-	 * Otherwise false is returned
+	 * Otherwise false is returned, also if a fragment with the same subID has been added before or the
+	 * subID is not enabled (see SourceIDManager::L0_SUB_ID_TO_SLOT)
 	 *
 	 */
 	inline bool addFragment(MEPFragment* fragment) {
-		uint_fast16_t oldNumberOfFragments = fragmentCounter.fetch_add(1);
-
-		if (oldNumberOfFragments
-				>= SourceIDManager::getExpectedPacksBySourceID(
-						fragment->getSourceID())) {
-			/*
-			 * when more fragments are received than expected: decrement the counter back to the old value
-			 * We have to check >= as it might be > in case of a high rate where another thread could already
-			 * have incremented it without decrementing it yet
-			 */
-			fragmentCounter--;
+		const uint_fast8_t subID = fragment->getSourceSubID();
+		const uint_fast8_t slot = subIDToSlot[subID];
+		if (slot == SourceIDManager::NO_SUB_ID_SLOT) {
 			return false;
 		}
 
-		eventFragments[oldNumberOfFragments] = fragment;
+		/*
+		 * Claiming the slot of the subID detects duplicates exactly, also while other fragments are being added.
+		 * The received bit is only set afterwards, so getFragmentBySubID never sees a set bit with an empty slot.
+		 * As every enabled subID has its own slot the counter can not exceed expectedPacketsNum
+		 */
+		MEPFragment* empty = nullptr;
+		if (!fragmentsBySlot[slot].compare_exchange_strong(empty, fragment, std::memory_order_release,
+				std::memory_order_relaxed)) {
+			return false;
+		}
+		receivedSubIDs[subID / 64].fetch_or(1ull << (subID % 64), std::memory_order_release);
+
+		eventFragments[fragmentCounter.fetch_add(1, std::memory_order_acq_rel)] = fragment;
 		return true;
 	}
 
+	/*
+	 * Returns the fragment of the given subID or nullptr if it has not been received
+	 */
+	inline MEPFragment* getFragmentBySubID(const uint_fast8_t subID) const {
+		const uint_fast8_t slot = subIDToSlot[subID];
+		if (slot == SourceIDManager::NO_SUB_ID_SLOT) {
+			return nullptr;
+		}
+		return fragmentsBySlot[slot].load(std::memory_order_acquire);
+	}
+
 	/**
 	 * Returns all fragments of this Subevent
 	 * @return A pointer to an array of all received MEPFragment pointers
@@ -63,7 +79,7 @@ public:
 	}
 
 	/**
-	 * Returns the Nth event fragment that has been received
+	 * Returns the Nth event fragment that has been received (in arrival order)
 	 *
 	 * @param eventPartNumber
 	 * 						The number of the requested fragment (N). N must be smaller
@@ -75,26 +91,40 @@ public:
 	}
 
 	/**
-	 * Returns all missing source sub IDs. This only works correctly if the enabled sub IDs are consecutive numbers from 0 to ExpectedPacketsNum-1
+	 * Returns all enabled source sub IDs without fragment
 	 */
 	inline std::vector<uint> getMissingSourceSubIds() const {
 		std::vector<uint> missingSubIDs;
-
-		std::set<uint> receivedSubIDs;
-		for (uint i = 0; i != getNumberOfFragments(); i++) {
-			receivedSubIDs.insert(eventFragments[i]->getSourceSubID());
-		}
-
-		// Check which subIDs are missing
-		for (uint i = 0; i != expectedPacketsNum; i++) {
-			if (receivedSubIDs.find(i) == receivedSubIDs.end()) {
-				missingSubIDs.push_back(i);
+		for (uint word = 0; word != SUB_ID_MASK_WORDS; word++) {
+			uint64_t missing = getMissingSubIDMask(word);
+			while (missing != 0) {
+				missingSubIDs.push_back(word * 64 + __builtin_ctzll(missing));
+				missing &= missing - 1;
 			}
 		}
-
 		return missingSubIDs;
 	}
 
+	/*
+	 * Bit <subID % 64> of word <subID / 64> is set if a fragment with that subID has been added
+	 */
+	inline uint64_t getReceivedSubIDMask(const uint word) const {
+		return receivedSubIDs[word].load(std::memory_order_relaxed);
+	}
+
+	/*
+	 * Same as getReceivedSubIDMask for the enabled subIDs not yet received
+	 */
+	inline uint64_t getMissingSubIDMask(const uint word) const {
+		return enabledSubIDs[word] & ~getReceivedSubIDMask(word);
+	}
+
+	inline bool isSubIDReceived(const uint_fast8_t subID) const {
+		return getReceivedSubIDMask(subID / 64) & (1ull << (subID % 64));
+	}
+
+	static const uint SUB_ID_MASK_WORDS = SourceIDManager::L0_SUB_ID_MASK_WORDS;
+
 	/**
 	 * Returns the number of received subevent fragments
 	 *
@@ -114,7 +144,11 @@ private:
 	const uint_fast16_t expectedPacketsNum;
 	const uint_fast8_t sourceID;
 	MEPFragment ** eventFragments;
+	std::atomic<MEPFragment*>* fragmentsBySlot;
+	const uint_fast8_t* subIDToSlot;
+	const uint64_t* enabledSubIDs;
 	std::atomic<uint_fast16_t> fragmentCounter;
+	std::atomic<uint64_t> receivedSubIDs[SUB_ID_MASK_WORDS];
 };
 
 } /* namespace l0 */
@@ -9,15 +9,27 @@
 #include "MEP.h"
 
 #include <boost/lexical_cast.hpp>
+#include <sstream>
 #include <string>
 
 #include "../exceptions/CommonExceptions.h"
 #include "../exceptions/BrokenPacketReceivedError.h"
 #include "../exceptions/UnknownSourceIDFound.h"
+#include "../monitoring/MEPErrorStatistics.h"
 
 namespace na62 {
 namespace l1 {
 
+/*
+ * The sourceID of the first fragment is the one of the whole packet
+ */
+static inline uint_fast16_t getFirstSourceID(const char* data, const uint16_t dataLength) {
+	if (dataLength < sizeof(L1_EVENT_RAW_HDR)) {
+		return MEPErrorStatistics::NO_SOURCE_ID;
+	}
+	return reinterpret_cast<const L1_EVENT_RAW_HDR*>(data)->sourceID;
+}
+
 MEP::MEP(const char * data, const uint16_t& dataLength,
                 DataContainer etherFrame) :
                 dataContainer_(etherFrame), sourceID_(0xff) {
@@ -28,7 +40,38 @@ MEP::MEP(const char * data, const uint16_t& dataLength,
          */
 	eventNum_ = 0 ;
 
-	initializeMEPFragments(data, dataLength);
+	uint16_t fragmentOffsets[MAX_L1_FRAGMENTS_PER_MEP];
+	uint16_t numberOfFragments = 0;
+	const MEPParseStatus status = scanFragments(data, dataLength, fragmentOffsets, numberOfFragments);
+	if (status != MEPParseStatus::OK) {
+		MEPErrorStatistics::count(MEPErrorStatistics::L1, status, getFirstSourceID(data, dataLength));
+		throwParseError(status, data, dataLength);
+	}
+
+	initializeMEPFragments(data, fragmentOffsets, numberOfFragments);
+}
+
+MEP::MEP(const char * data, DataContainer etherFrame, const uint16_t* fragmentOffsets,
+		const uint16_t numberOfFragments) :
+                dataContainer_(etherFrame), sourceID_(0xff) {
+	eventNum_ = 0 ;
+	initializeMEPFragments(data, fragmentOffsets, numberOfFragments);
+}
+
+MEPParseStatus MEP::tryParse(const char * data, const uint16_t dataLength,
+		DataContainer originalData, MEP*& mep) {
+	uint16_t fragmentOffsets[MAX_L1_FRAGMENTS_PER_MEP];
+	uint16_t numberOfFragments = 0;
+	const MEPParseStatus status = scanFragments(data, dataLength, fragmentOffsets, numberOfFragments);
+	if (status != MEPParseStatus::OK) {
+		mep = nullptr;
+		MEPErrorStatistics::report(MEPErrorStatistics::L1, status, getFirstSourceID(data, dataLength),
+				dataLength);
+		return status;
+	}
+
+	mep = new MEP(data, originalData, fragmentOffsets, numberOfFragments);
+	return status;
 }
 
 MEP::~MEP() {
@@ -45,69 +88,81 @@ MEP::~MEP() {
         dataContainer_.free();
 }
 
-void MEP::initializeMEPFragments(const char * data, const uint16_t& dataLength) {
-	if(dataLength == 0) {
-#ifdef USE_ERS
-		throw CorruptedMEP(ERS_HERE, "Received EMPTY UDP packet!");
-#else
-		throw BrokenPacketReceivedError("Received EMPTY UDP packet!");
-#endif
+MEPParseStatus MEP::scanFragments(const char* data, const uint16_t dataLength,
+		uint16_t* fragmentOffsets, uint16_t& numberOfFragments) {
+	numberOfFragments = 0;
+	if (dataLength == 0) {
+		return MEPParseStatus::EMPTY_PACKET;
 	}
-	if(dataLength < sizeof(L1_EVENT_RAW_HDR)) {
-#ifdef USE_ERS
-		std::ostringstream s;
-		s << "Received UDP packet with size " << dataLength << " less data than a single L1 header!";
-		throw CorruptedMEP(ERS_HERE, s.str());
-#else
-		throw BrokenPacketReceivedError("Received UDP packet with less data than a single L1 header!");
-#endif
+	if (dataLength < sizeof(L1_EVENT_RAW_HDR)) {
+		return MEPParseStatus::TRUNCATED_HEADER;
 	}
-	// Get source ID from first fragment and check its validity
-	const L1_EVENT_RAW_HDR* hdr = (const L1_EVENT_RAW_HDR*)(data);
 
+	// Get source ID from first fragment and check its validity
+	const L1_EVENT_RAW_HDR* hdr = reinterpret_cast<const L1_EVENT_RAW_HDR*>(data);
 	if (!SourceIDManager::checkL1SourceID(hdr->sourceID)) {
-#ifdef USE_ERS
-		throw UnknownSourceID(ERS_HERE, hdr->sourceID, hdr->sourceSubID);
-#else
-		throw UnknownSourceIDFound(hdr->sourceID, hdr->sourceSubID);
-#endif
+		return MEPParseStatus::UNKNOWN_SOURCE_ID;
 	}
 
-	sourceID_ = hdr->sourceID;
+	uint_fast32_t offset = 0;
+	uint16_t fragmentNum = 0;
+	while (offset < dataLength) {
+		if (fragmentNum == MAX_L1_FRAGMENTS_PER_MEP) {
+			return MEPParseStatus::TOO_MANY_FRAGMENTS;
+		}
+		if (offset + sizeof(L1_EVENT_RAW_HDR) > dataLength) {
+			return MEPParseStatus::TRUNCATED_FRAGMENT;
+		}
+		hdr = reinterpret_cast<const L1_EVENT_RAW_HDR*>(data + offset);
+		const uint_fast32_t fragmentLength = hdr->numberOf4BWords * 4;
+
+		/*
+		 * A fragment must at least contain its own header, otherwise we would never leave this loop
+		 */
+		if (fragmentLength < sizeof(L1_EVENT_RAW_HDR) || fragmentLength > 9500) {
+			return MEPParseStatus::BAD_FRAGMENT_LENGTH;
+		}
+		if (offset + fragmentLength > dataLength) {
+			return MEPParseStatus::TRUNCATED_FRAGMENT;
+		}
+		fragmentOffsets[fragmentNum++] = offset;
+		offset += fragmentLength;
+	}
 
-	uint16_t offset = 0;
+	numberOfFragments = fragmentNum;
+	return MEPParseStatus::OK;
+}
 
-	MEPFragment* newEvent = nullptr;
+void MEP::initializeMEPFragments(const char * data, const uint16_t* fragmentOffsets,
+		const uint16_t numberOfFragments) {
+	sourceID_ = reinterpret_cast<const L1_EVENT_RAW_HDR*>(data)->sourceID;
 
-	while (offset < dataLength) {
+	events.reserve(numberOfFragments);
+	for (uint16_t i = 0; i != numberOfFragments; i++) {
+		events.push_back(new MEPFragment(this, (const L1_EVENT_RAW_HDR*) (data + fragmentOffsets[i])));
+	}
 
-		newEvent = new MEPFragment(this, (const L1_EVENT_RAW_HDR*)(data + offset));
+	eventNum_ = events.size();
+}
 
-		if (newEvent->getEventLength()>9500) {
-			std::ostringstream s;
-			s << "Negative event length in L1 MEP" << newEvent->getEventLength();
+void MEP::throwParseError(const MEPParseStatus status, const char* data,
+		const uint16_t dataLength) const {
+	if (status == MEPParseStatus::UNKNOWN_SOURCE_ID) {
+		const L1_EVENT_RAW_HDR* hdr = reinterpret_cast<const L1_EVENT_RAW_HDR*>(data);
 #ifdef USE_ERS
-			throw CorruptedMEP(ERS_HERE, s.str());
+		throw UnknownSourceID(ERS_HERE, hdr->sourceID, hdr->sourceSubID);
 #else
-			throw BrokenPacketReceivedError(s.str());
+		throw UnknownSourceIDFound(hdr->sourceID, hdr->sourceSubID);
 #endif
-		}
+	}
 
-		if (newEvent->getEventLength() + offset > dataLength) {
-			std::ostringstream s;
-			s << "Incomplete L1 MEP Fragment. Received only " << (uint) dataLength << " instead of " <<
-					(uint) (offset + newEvent->getEventLength()) << " bytes.";
+	std::ostringstream s;
+	s << mepParseStatusToString(status) << " in L1 MEP! Received " << (uint) dataLength << " bytes";
 #ifdef USE_ERS
-			throw CorruptedMEP(ERS_HERE, s.str());
+	throw CorruptedMEP(ERS_HERE, s.str());
 #else
-			throw BrokenPacketReceivedError(s.str());
+	throw BrokenPacketReceivedError(s.str());
 #endif
-		}
-		offset += newEvent->getEventLength();
-		events.push_back(std::move(newEvent));
-	}
-
-	eventNum_ = events.size();
 }
 
 } /* namespace l1 */
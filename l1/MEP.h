@@ -18,6 +18,7 @@
 #include "../exceptions/UnknownCREAMSourceIDFound.h"
 #include "../exceptions/BrokenPacketReceivedError.h"
 #include "../structs/DataContainer.h"
+#include "../structs/MEPParseStatus.h"
 #include "../eventBuilding/SourceIDManager.h"
 #include "MEPFragment.h"
 
@@ -28,10 +29,22 @@ class MEP: private boost::noncopyable  {
 public:
         /**
          * Reads the data coming from L0 and initializes the corresponding fields
+         *
+         * The whole packet is validated by scanFragments() before any MEPFragment is created.
+         * Throws BrokenPacketReceivedError/CorruptedMEP or UnknownSourceIDFound if the packet is corrupt.
+         * Use tryParse() on the receiver path instead.
          */
         MEP(const char * data, const uint16_t& dataLength,
                         DataContainer originalData) ;
 
+        /**
+         * Exception free version of the constructor: validates the data and on success writes a new
+         * MEP to <mep>. Otherwise <mep> is set to nullptr, the failure is counted and logged (rate limited)
+         * by MEPErrorStatistics and the caller still owns <originalData>.
+         */
+        static MEPParseStatus tryParse(const char * data, const uint16_t dataLength,
+                        DataContainer originalData, MEP*& mep);
+
         /**
          * Frees the data buffer (orignialData) that was created by the Receiver
          *
@@ -39,7 +52,15 @@ public:
          */
         ~MEP();
 
-        void initializeMEPFragments(const char* data, const uint16_t& dataLength);
+        /**
+         * Validation pass over all L1 fragment headers within one packet. No object is created and
+         * nothing is thrown: the offsets of all fragments are written to <fragmentOffsets> which must
+         * provide MAX_L1_FRAGMENTS_PER_MEP entries and their number to <numberOfFragments>.
+         *
+         * @return MEPParseStatus::OK if the packet is consistent
+         */
+        static MEPParseStatus scanFragments(const char* data, const uint16_t dataLength,
+                        uint16_t* fragmentOffsets, uint16_t& numberOfFragments);
 
         /**
          * Returns a pointer to the n'th event within this MEP where 0<=n<getFirstEventNum()
@@ -90,6 +111,21 @@ public:
         }
 
 private:
+        /**
+         * Used by tryParse after the data has been validated successfully
+         */
+        MEP(const char * data, DataContainer originalData, const uint16_t* fragmentOffsets,
+                        const uint16_t numberOfFragments);
+
+        /**
+         * Creates all MEPFragments at the offsets found by scanFragments()
+         */
+        void initializeMEPFragments(const char* data, const uint16_t* fragmentOffsets,
+                        const uint16_t numberOfFragments);
+
+        void throwParseError(const MEPParseStatus status, const char* data,
+                        const uint16_t dataLength) const;
+
     // The whole ethernet frame
     DataContainer dataContainer_;
     // Pointers to the payload of the UDP packet
@@ -36,18 +36,17 @@ public:
 	 *
 	 */
 	inline bool addFragment(MEPFragment* fragment) {
-		uint_fast16_t oldNumberOfFragments = fragmentCounter.fetch_add(1);
-
-		if (oldNumberOfFragments
-				>= SourceIDManager::getExpectedL1PacksBySourceID(fragment->getSourceID())) {
-			/*
-			 * when more fragments are received than expected: decrement the counter back to the old value
-			 * We have to check >= as it might be > in case of a high rate where another thread could already
-			 * have incremented it without decrementing it yet
-			 */
-			fragmentCounter--;
-			return false;
-		}
+		/*
+		 * Bounded claim of a slot: the counter never exceeds expectedPacketsNum, so getNumberOfFragments()
+		 * never reports more fragments than stored
+		 */
+		uint_fast16_t oldNumberOfFragments = fragmentCounter.load(std::memory_order_relaxed);
+		do {
+			if (oldNumberOfFragments >= expectedPacketsNum) {
+				return false;
+			}
+		} while (!fragmentCounter.compare_exchange_weak(oldNumberOfFragments, oldNumberOfFragments + 1,
+				std::memory_order_acq_rel, std::memory_order_relaxed));
 
 		eventFragments[oldNumberOfFragments] = fragment;
 		return true;
@@ -0,0 +1,144 @@
+/*
+ * ArrivalSkewStatistics.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: NA62 collaboration
+ */
+
+#include "ArrivalSkewStatistics.h"
+
+#include <mutex>
+#include <sstream>
+
+#include "../eventBuilding/SourceIDManager.h"
+
+namespace na62 {
+
+uint ArrivalSkewStatistics::numberOfCells_ = 0;
+uint32_t ArrivalSkewStatistics::samplingMask_ = 0;
+ArrivalSkewStatistics::AtomicCell* ArrivalSkewStatistics::cells_[NA62_BURST_BANKS];
+std::shared_ptr<const ArrivalSkewStatistics::Snapshot> ArrivalSkewStatistics::sealedSnapshot_;
+
+void ArrivalSkewStatistics::initialize(const uint samplingShift) {
+	samplingMask_ = (1u << samplingShift) - 1;
+	numberOfCells_ = SourceIDManager::NUMBER_OF_L0_DATA_SOURCES * ARRIVAL_SKEW_MAX_SUB_IDS;
+	for (uint bank = NA62_BURST_BANKS; bank-- != 0;) {
+		// bank 0 last: it enables the recording
+		cells_[bank] = new AtomicCell[numberOfCells_];
+		resetBank(bank);
+	}
+
+	static std::once_flag sealListenerFlag;
+	std::call_once(sealListenerFlag, []() {
+		BurstIdHandler::addBurstSealListener(&ArrivalSkewStatistics::sealBurst);
+	});
+	LOG_INFO("Recording fragment arrival times of every " << samplingMask_ + 1 << "th event");
+}
+
+void ArrivalSkewStatistics::resetBank(const uint bank) {
+	for (uint i = 0; i != numberOfCells_; i++) {
+		AtomicCell& cell = cells_[bank][i];
+		cell.fragments.store(0, std::memory_order_relaxed);
+		cell.sumMicros.store(0, std::memory_order_relaxed);
+		cell.lastArrivals.store(0, std::memory_order_relaxed);
+		for (uint bucket = 0; bucket != ARRIVAL_SKEW_BUCKETS; bucket++) {
+			cell.buckets[bucket].store(0, std::memory_order_relaxed);
+		}
+	}
+}
+
+void ArrivalSkewStatistics::sealBurst(const uint_fast32_t burstID, const uint_fast32_t nextBurstID) {
+	if (cells_[0] == nullptr) {
+		return;
+	}
+
+	const uint bank = BurstIdHandler::getBank(burstID);
+	std::shared_ptr<Snapshot> snapshot = std::make_shared<Snapshot>();
+	snapshot->burstID = burstID;
+	snapshot->cells.resize(numberOfCells_);
+	for (uint i = 0; i != numberOfCells_; i++) {
+		const AtomicCell& cell = cells_[bank][i];
+		Cell& copy = snapshot->cells[i];
+		copy.fragments = cell.fragments.load(std::memory_order_relaxed);
+		copy.sumMicros = cell.sumMicros.load(std::memory_order_relaxed);
+		copy.lastArrivals = cell.lastArrivals.load(std::memory_order_relaxed);
+		for (uint bucket = 0; bucket != ARRIVAL_SKEW_BUCKETS; bucket++) {
+			copy.buckets[bucket] = cell.buckets[bucket].load(std::memory_order_relaxed);
+		}
+	}
+	std::atomic_store(&sealedSnapshot_, std::shared_ptr<const Snapshot>(snapshot));
+
+	resetBank(BurstIdHandler::getBank(nextBurstID));
+}
+
+uint32_t ArrivalSkewStatistics::getPercentile(const Cell& cell, const double quantile) {
+	uint64_t rank = quantile * cell.fragments + 0.5;
+	if (rank == 0) {
+		rank = 1;
+	}
+	uint64_t seen = 0;
+	for (uint bucket = 0; bucket != ARRIVAL_SKEW_BUCKETS; bucket++) {
+		seen += cell.buckets[bucket];
+		if (seen >= rank) {
+			return bucket == 0 ? 0 : (1u << bucket) - 1;
+		}
+	}
+	return (1u << (ARRIVAL_SKEW_BUCKETS - 1)) - 1;
+}
+
+std::string ArrivalSkewStatistics::L0SkewInfo() {
+	std::shared_ptr<const Snapshot> snapshot = getSealedSnapshot();
+	std::ostringstream s;
+	if (!snapshot) {
+		return s.str();
+	}
+	for (uint sourceNum = 0; sourceNum != numberOfCells_ / ARRIVAL_SKEW_MAX_SUB_IDS; sourceNum++) {
+		s << std::hex << (uint) SourceIDManager::sourceNumToID(sourceNum) << "; " << std::dec;
+		for (uint subID = 0; subID != ARRIVAL_SKEW_MAX_SUB_IDS; subID++) {
+			const Cell& cell = snapshot->cells[sourceNum * ARRIVAL_SKEW_MAX_SUB_IDS + subID];
+			if (cell.fragments > 0) {
+				s << subID << ":" << cell.sumMicros / cell.fragments << ":" << getPercentile(cell, 0.99) << ":"
+						<< cell.lastArrivals << " ";
+			}
+		}
+		s << "|";
+	}
+	return s.str();
+}
+
+std::string ArrivalSkewStatistics::toJson() {
+	std::shared_ptr<const Snapshot> snapshot = getSealedSnapshot();
+	if (!snapshot) {
+		return "{}";
+	}
+
+	std::stringstream stream;
+	stream << "{\"burstID\":" << snapshot->burstID << ",\"sources\":{";
+	bool firstSource = true;
+	for (uint sourceNum = 0; sourceNum != numberOfCells_ / ARRIVAL_SKEW_MAX_SUB_IDS; sourceNum++) {
+		bool firstSubID = true;
+		for (uint subID = 0; subID != ARRIVAL_SKEW_MAX_SUB_IDS; subID++) {
+			const Cell& cell = snapshot->cells[sourceNum * ARRIVAL_SKEW_MAX_SUB_IDS + subID];
+			if (cell.fragments == 0) {
+				continue;
+			}
+			if (firstSubID) {
+				stream << (firstSource ? "" : ",") << "\"" << (uint) SourceIDManager::sourceNumToID(sourceNum)
+						<< "\":{";
+				firstSource = false;
+			}
+			stream << (firstSubID ? "" : ",") << "\"" << subID << "\":{\"fragments\":" << cell.fragments
+					<< ",\"meanMicros\":" << cell.sumMicros / cell.fragments << ",\"p50Micros\":"
+					<< getPercentile(cell, 0.5) << ",\"p99Micros\":" << getPercentile(cell, 0.99)
+					<< ",\"lastArrivals\":" << cell.lastArrivals << "}";
+			firstSubID = false;
+		}
+		if (!firstSubID) {
+			stream << "}";
+		}
+	}
+	stream << "}}";
+	return stream.str();
+}
+
+} /* namespace na62 */
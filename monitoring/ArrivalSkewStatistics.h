@@ -0,0 +1,124 @@
+/*
+ * ArrivalSkewStatistics.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: NA62 collaboration
+ */
+
+#pragma once
+#ifndef ARRIVALSKEWSTATISTICS_H_
+#define ARRIVALSKEWSTATISTICS_H_
+
+#include <sys/types.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "BurstIdHandler.h"
+
+// Same subID range as DetectorStatistics
+#define ARRIVAL_SKEW_MAX_SUB_IDS 32
+// Power of two buckets in microseconds: [0], [1], [2,3], [4,7] ... [2^22, inf)
+#define ARRIVAL_SKEW_BUCKETS 24
+
+namespace na62 {
+
+/*
+ * Arrival time of every L0 fragment relative to the first fragment of its event, per sourceID and subID.
+ * Additionally counts how often each board delivered the fragment completing the event, which identifies
+ * the boards defining the event building latency.
+ *
+ * Only every 2^samplingShift'th event is recorded. The cells are relaxed atomics in two banks selected by
+ * the burst ID (see HltStatistics), the finished burst is published by sealBurst.
+ */
+class ArrivalSkewStatistics {
+public:
+	struct Cell {
+		uint64_t fragments;
+		uint64_t sumMicros;
+		uint64_t lastArrivals;
+		uint32_t buckets[ARRIVAL_SKEW_BUCKETS];
+	};
+
+	struct Snapshot {
+		uint_fast32_t burstID;
+		std::vector<Cell> cells; // [sourceNum * ARRIVAL_SKEW_MAX_SUB_IDS + subID]
+	};
+
+	/*
+	 * Must be called after the SourceIDManager has been initialized. Recording is disabled until then
+	 */
+	static void initialize(const uint samplingShift);
+
+	static inline bool isSampled(const uint_fast32_t eventNumber) {
+		return cells_[0] != nullptr && (eventNumber & samplingMask_) == 0;
+	}
+
+	/*
+	 * <last> is true if the fragment completed the L0 event
+	 */
+	static inline void record(const uint_fast32_t burstID, const uint_fast8_t sourceNum,
+			const uint_fast8_t subID, const uint32_t offsetMicros, const bool last) {
+		if (subID >= ARRIVAL_SKEW_MAX_SUB_IDS) {
+			return;
+		}
+		AtomicCell& cell = cells_[BurstIdHandler::getBank(burstID)][sourceNum * ARRIVAL_SKEW_MAX_SUB_IDS + subID];
+		cell.fragments.fetch_add(1, std::memory_order_relaxed);
+		cell.sumMicros.fetch_add(offsetMicros, std::memory_order_relaxed);
+		if (last) {
+			cell.lastArrivals.fetch_add(1, std::memory_order_relaxed);
+		}
+		cell.buckets[bucketIndex(offsetMicros)].fetch_add(1, std::memory_order_relaxed);
+	}
+
+	static inline uint bucketIndex(const uint32_t offsetMicros) {
+		if (offsetMicros == 0) {
+			return 0;
+		}
+		const uint index = 32 - __builtin_clz(offsetMicros);
+		return index < ARRIVAL_SKEW_BUCKETS ? index : ARRIVAL_SKEW_BUCKETS - 1;
+	}
+
+	static void sealBurst(const uint_fast32_t burstID, const uint_fast32_t nextBurstID);
+
+	/*
+	 * Statistics of the last sealed burst or nullptr
+	 */
+	static std::shared_ptr<const Snapshot> getSealedSnapshot() {
+		return std::atomic_load(&sealedSnapshot_);
+	}
+
+	/*
+	 * Sealed burst in the format of DetectorStatistics::L0RCInfo:
+	 * "sourceID; subID:meanMicros:p99Micros:lastArrivals ... |"
+	 */
+	static std::string L0SkewInfo();
+
+	static std::string toJson();
+
+private:
+	struct AtomicCell {
+		std::atomic<uint64_t> fragments;
+		std::atomic<uint64_t> sumMicros;
+		std::atomic<uint64_t> lastArrivals;
+		std::atomic<uint32_t> buckets[ARRIVAL_SKEW_BUCKETS];
+	};
+
+	static void resetBank(const uint bank);
+
+	/*
+	 * Upper bound in microseconds of the bucket containing the given quantile
+	 */
+	static uint32_t getPercentile(const Cell& cell, const double quantile);
+
+	static uint numberOfCells_;
+	static uint32_t samplingMask_;
+	static AtomicCell* cells_[NA62_BURST_BANKS];
+	static std::shared_ptr<const Snapshot> sealedSnapshot_;
+};
+
+} /* namespace na62 */
+
+#endif /* ARRIVALSKEWSTATISTICS_H_ */
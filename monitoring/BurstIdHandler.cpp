@@ -7,6 +7,8 @@
 
 #include "BurstIdHandler.h"
 
+#include <algorithm>
+
 //#include "../eventBuilding/Event.h"
 //#include "../eventBuilding/EventPool.h"
 //#include "../eventBuilding/SourceIDManager.h"
@@ -16,8 +18,13 @@
 //#include "../structs/L0TPHeader.h"
 
 namespace na62 {
-boost::timer::cpu_timer BurstIdHandler::EOBReceivedTimer_;
-std::mutex BurstIdHandler::timerMutex_;
+std::atomic<int64_t> BurstIdHandler::EOBReceivedMillis_(
+		std::chrono::duration_cast<std::chrono::milliseconds>(
+				DeadlineScheduler::Clock::now().time_since_epoch()).count());
+DeadlineScheduler BurstIdHandler::scheduler_;
+std::mutex BurstIdHandler::deadlinesMutex_;
+std::vector<DeadlineScheduler::DeadlineID> BurstIdHandler::armedDeadlines_;
+std::vector<std::pair<uint, std::function<void(uint_fast32_t)>>> BurstIdHandler::burstDeadlines_;
 uint BurstIdHandler::nextBurstId_;
 uint BurstIdHandler::runNumber_ = 0;
 uint BurstIdHandler::currentBurstID_ = 0;
@@ -27,31 +34,71 @@ std::atomic<uint> BurstIdHandler::sobTime_(0);
 std::atomic<bool> BurstIdHandler::running_(false);
 std::atomic<bool> BurstIdHandler::flushBurst_(false);
 std::function<void()> BurstIdHandler::burstCleanupFunction_(nullptr);
+std::mutex BurstIdHandler::sealListenersMutex_;
+std::vector<std::function<void(uint_fast32_t, uint_fast32_t)>> BurstIdHandler::sealListeners_;
 
-float BurstIdHandler::flush_burst_s_(3.);
-float BurstIdHandler::clean_burst_s_(5.);
+uint BurstIdHandler::flushBurstMillis_(3000);
+uint BurstIdHandler::cleanBurstMillis_(5000);
 
+void BurstIdHandler::setNextBurstID(uint_fast32_t nextBurstID) {
+	const DeadlineScheduler::Clock::time_point now = DeadlineScheduler::Clock::now();
+	EOBReceivedMillis_ = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+	nextBurstId_ = nextBurstID;
+	LOG_INFO("Changing BurstID to " << nextBurstID);
 
-void BurstIdHandler::thread() {
-	while(BurstIdHandler::running_) {
-		//LOG_INFO("Burst ID Handler thread " << (bool) BurstIdHandler::isInBurst() << " " << (bool)BurstIdHandler::flushBurst() <<  " " << (int) BurstIdHandler::getTimeSinceLastEOB());
-		if (BurstIdHandler::isInBurst() == false and BurstIdHandler::flushBurst_ == false and BurstIdHandler::getTimeSinceLastEOB() > flush_burst_s_) {
-			// Mark that all further data shall be discarded
-			LOG_INFO("Preparing end of burst " << (int) BurstIdHandler::getCurrentBurstId());
-			BurstIdHandler::flushBurst_ = true;
-		} else if (BurstIdHandler::isInBurst() == false and BurstIdHandler::flushBurst_ == true and BurstIdHandler::getTimeSinceLastEOB() > clean_burst_s_) {
-			// Flush all events
-			LOG_INFO("Cleanup of burst " << (int) BurstIdHandler::getCurrentBurstId());
-			//onBurstFinished();
-			BurstIdHandler::burstCleanupFunction_();
-			BurstIdHandler::currentBurstID_ = BurstIdHandler::nextBurstId_;
-			BurstIdHandler::flushBurst_ = false;
-
-			LOG_INFO("Start of burst " << (int) BurstIdHandler::getCurrentBurstId());
+	std::lock_guard<std::mutex> lk(deadlinesMutex_);
+	/*
+	 * A repeated EOB restarts the transition
+	 */
+	for (DeadlineScheduler::DeadlineID id : armedDeadlines_) {
+		scheduler_.cancel(id);
+	}
+	armedDeadlines_.clear();
+
+	const uint_fast32_t finishedBurstID = currentBurstID_;
+	for (auto& deadline : burstDeadlines_) {
+		std::function<void(uint_fast32_t)> callback = deadline.second;
+		armedDeadlines_.push_back(
+				scheduler_.schedule(now + std::chrono::milliseconds(deadline.first),
+						[callback, finishedBurstID]() {callback(finishedBurstID);}));
+	}
+	armedDeadlines_.push_back(
+			scheduler_.schedule(now + std::chrono::milliseconds(flushBurstMillis_), &BurstIdHandler::onFlushDeadline));
+	armedDeadlines_.push_back(
+			scheduler_.schedule(now + std::chrono::milliseconds(std::max(flushBurstMillis_, cleanBurstMillis_)),
+					&BurstIdHandler::onCleanupDeadline));
+}
+
+void BurstIdHandler::onFlushDeadline() {
+	if (BurstIdHandler::isInBurst() == false and BurstIdHandler::flushBurst_ == false) {
+		// Mark that all further data shall be discarded
+		LOG_INFO("Preparing end of burst " << (int) BurstIdHandler::getCurrentBurstId());
+		BurstIdHandler::flushBurst_ = true;
+	}
+}
 
+void BurstIdHandler::onCleanupDeadline() {
+	if (BurstIdHandler::isInBurst() == false and BurstIdHandler::flushBurst_ == true) {
+		// Flush all events
+		LOG_INFO("Cleanup of burst " << (int) BurstIdHandler::getCurrentBurstId());
+		//onBurstFinished();
+		BurstIdHandler::burstCleanupFunction_();
+		{
+			std::lock_guard<std::mutex> lk(sealListenersMutex_);
+			for (auto& listener : sealListeners_) {
+				listener(BurstIdHandler::currentBurstID_, BurstIdHandler::nextBurstId_);
+			}
 		}
-		// Slow down polling
-		boost::this_thread::sleep(boost::posix_time::microsec(100000));
+		BurstIdHandler::currentBurstID_ = BurstIdHandler::nextBurstId_;
+		BurstIdHandler::flushBurst_ = false;
+
+		LOG_INFO("Start of burst " << (int) BurstIdHandler::getCurrentBurstId());
+	}
+}
+
+void BurstIdHandler::thread() {
+	if (BurstIdHandler::running_) {
+		scheduler_.run();
 	}
 }
 } /* namespace na62 */
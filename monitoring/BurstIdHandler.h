@@ -8,39 +8,50 @@
 #ifndef BURSTIDHANDLER_H_
 #define BURSTIDHANDLER_H_
 
-#include <boost/timer/timer.hpp>
+#include <chrono>
+#include <functional>
 #include <mutex>
 #include <atomic>
+#include <vector>
 
 #include "../utils/AExecutable.h"
+#include "../utils/DeadlineScheduler.h"
 #include "../options/Logging.h"
 
 
+/*
+ * Counters accounted per burst exist in this number of banks, selected by BurstIdHandler::getBank
+ */
+#define NA62_BURST_BANKS 2
+
 namespace na62 {
 
+/*
+ * The end of burst transition is driven by deadlines armed when the EOB is received (setNextBurstID):
+ * after flush_burst_millis all further data of the burst is discarded, after clean_burst_millis the
+ * burst is cleaned up, sealed and the next burst ID becomes current. The thread of this object executes
+ * the deadlines, so they fire exactly instead of at the next polling interval.
+ */
 class BurstIdHandler: public AExecutable {
 public:
 
 	static void initialize(int flush_burst_millis, int clean_burst_millis) {
-		flush_burst_s_ = ((float) flush_burst_millis) / 1000.;
-		clean_burst_s_ = ((float) clean_burst_millis) / 1000.;
-	}
-	static void setNextBurstID(uint_fast32_t nextBurstID) {
-		std::lock_guard<std::mutex> lk(timerMutex_);
-		//EOBReceivedTimer_.elapsed().clear();
-		EOBReceivedTimer_.start();
-		nextBurstId_ = nextBurstID;
-		LOG_INFO("Changing BurstID to " << nextBurstID);
-		//resetCounter_=true;
+		flushBurstMillis_ = flush_burst_millis;
+		cleanBurstMillis_ = clean_burst_millis;
 	}
+	static void setNextBurstID(uint_fast32_t nextBurstID);
 
 	static uint_fast32_t getCurrentBurstId() {
 		return currentBurstID_;
 	}
 
 	static long int getTimeSinceLastEOB() {
-		std::lock_guard<std::mutex> lk(timerMutex_);
-		return (EOBReceivedTimer_.elapsed().wall / 1E9);
+		return getMillisSinceLastEOB() / 1000;
+	}
+
+	static long int getMillisSinceLastEOB() {
+		return std::chrono::duration_cast<std::chrono::milliseconds>(
+				DeadlineScheduler::Clock::now().time_since_epoch()).count() - EOBReceivedMillis_;
 	}
 
 	static inline bool isInBurst() {
@@ -64,8 +75,35 @@ public:
 		burstCleanupFunction_ = burstCleanupFunction;
 	}
 
+	/*
+	 * Bank of per burst counters to be used for data of the given burst. Consecutive bursts use
+	 * different banks so that the previous burst can be sealed while the next one is already counted
+	 */
+	static inline uint getBank(const uint_fast32_t burstID) {
+		return burstID & (NA62_BURST_BANKS - 1);
+	}
+
+	/*
+	 * Registers a function called by the thread with the ID of the finished burst and the ID of the next
+	 * burst. It is called after the burst cleanup and right before the current burst ID is switched
+	 */
+	static void addBurstSealListener(std::function<void(uint_fast32_t, uint_fast32_t)> listener) {
+		std::lock_guard<std::mutex> lk(sealListenersMutex_);
+		sealListeners_.push_back(listener);
+	}
+
+	/*
+	 * Registers a function called <millisAfterEOB> after every EOB with the ID of the finished burst.
+	 * Executed by the thread of this object, so it must not block for long
+	 */
+	static void addBurstDeadline(const uint millisAfterEOB, std::function<void(uint_fast32_t)> callback) {
+		std::lock_guard<std::mutex> lk(deadlinesMutex_);
+		burstDeadlines_.push_back(std::make_pair(millisAfterEOB, callback));
+	}
+
 	static void shutDown() {
 		running_=false;
+		scheduler_.stop();
 	}
 	void thread();
 
@@ -87,8 +125,22 @@ private:
 	 */
 	//void onBurstFinished();
 
-	static boost::timer::cpu_timer EOBReceivedTimer_;
-	static std::mutex timerMutex_;
+	virtual void onInterruption() {
+		shutDown();
+	}
+
+	static void onFlushDeadline();
+	static void onCleanupDeadline();
+
+	static std::atomic<int64_t> EOBReceivedMillis_;
+	static DeadlineScheduler scheduler_;
+
+	/*
+	 * Deadlines armed for the current EOB, canceled if another EOB arrives before they fired
+	 */
+	static std::mutex deadlinesMutex_;
+	static std::vector<DeadlineScheduler::DeadlineID> armedDeadlines_;
+	static std::vector<std::pair<uint, std::function<void(uint_fast32_t)>>> burstDeadlines_;
 
 	/*
 	 * Store the current Burst ID and the next one separately. As soon as an EOB event is
@@ -102,10 +154,12 @@ private:
 	static std::atomic<bool> running_;
 	static std::atomic<bool> flushBurst_;
 	static std::function<void()> burstCleanupFunction_;
+	static std::mutex sealListenersMutex_;
+	static std::vector<std::function<void(uint_fast32_t, uint_fast32_t)>> sealListeners_;
 	static std::atomic<uint> eobTime_;
 	static std::atomic<uint> sobTime_;
-	static float flush_burst_s_;
-	static float clean_burst_s_;
+	static uint flushBurstMillis_;
+	static uint cleanBurstMillis_;
 };
 
 }
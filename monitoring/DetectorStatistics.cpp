@@ -19,12 +19,14 @@
 #include <ctime>
 #include <chrono>
 #include <atomic>
+#include <mutex>
 
 namespace na62 {
 int DetectorStatistics::maxL0index;
 int DetectorStatistics::maxL1index;
-std::atomic<uint>** DetectorStatistics::L0receivedSourceIdsSubIds;
-std::atomic<uint>** DetectorStatistics::L1receivedSourceIdsSubIds;
+DynamicShardedCounters DetectorStatistics::L0receivedSourceIdsSubIds[NA62_BURST_BANKS];
+DynamicShardedCounters DetectorStatistics::L1receivedSourceIdsSubIds[NA62_BURST_BANKS];
+std::shared_ptr<const DetectorStatisticsSnapshot> DetectorStatistics::sealedSnapshot_;
 
 DetectorStatistics::DetectorStatistics() {
 
@@ -34,14 +36,35 @@ DetectorStatistics::~DetectorStatistics() {
 }
 
 void DetectorStatistics::init(int maxL0, int maxL1) {
-	L0receivedSourceIdsSubIds = new std::atomic<uint>*[maxL0];
-	for (int i = 0; i < maxL0; i++)
-		L0receivedSourceIdsSubIds[i] = new std::atomic<uint>[32];
-	L1receivedSourceIdsSubIds = new std::atomic<uint>*[maxL1];
-	for (int i = 0; i < maxL1; i++)
-		L1receivedSourceIdsSubIds[i] = new std::atomic<uint>[21];
+	for (uint bank = 0; bank != NA62_BURST_BANKS; bank++) {
+		L0receivedSourceIdsSubIds[bank].init(maxL0 * 32);
+		L1receivedSourceIdsSubIds[bank].init(maxL1 * 21);
+	}
+	std::atomic_store(&sealedSnapshot_, std::shared_ptr<const DetectorStatisticsSnapshot>());
 	maxL0index = maxL0;
 	maxL1index = maxL1;
+
+	static std::once_flag sealListenerFlag;
+	std::call_once(sealListenerFlag, []() {
+		BurstIdHandler::addBurstSealListener(&DetectorStatistics::sealBurst);
+	});
+}
+
+void DetectorStatistics::sealBurst(const uint_fast32_t burstID, const uint_fast32_t nextBurstID) {
+	const uint bank = BurstIdHandler::getBank(burstID);
+	std::shared_ptr<DetectorStatisticsSnapshot> snapshot = std::make_shared<DetectorStatisticsSnapshot>();
+	snapshot->burstID = burstID;
+	for (int index = 0; index != maxL0index * 32; index++) {
+		snapshot->L0receivedSourceIdsSubIds.push_back(L0receivedSourceIdsSubIds[bank].get(index));
+	}
+	for (int index = 0; index != maxL1index * 21; index++) {
+		snapshot->L1receivedSourceIdsSubIds.push_back(L1receivedSourceIdsSubIds[bank].get(index));
+	}
+	std::atomic_store(&sealedSnapshot_, std::shared_ptr<const DetectorStatisticsSnapshot>(snapshot));
+
+	const uint nextBank = BurstIdHandler::getBank(nextBurstID);
+	L0receivedSourceIdsSubIds[nextBank].reset();
+	L1receivedSourceIdsSubIds[nextBank].reset();
 }
 
 void DetectorStatistics::shutdown() {
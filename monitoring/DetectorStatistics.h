@@ -10,12 +10,31 @@
 #include <cstdlib>
 #include <sys/types.h>
 #include <atomic>
+#include <memory>
 #include <sstream>
 #include <string>
+#include <vector>
+
+#include "../utils/ThreadShard.h"
+#include "BurstIdHandler.h"
 
 using namespace std;
 namespace na62 {
 
+/*
+ * Fragments received per source of one burst
+ */
+struct DetectorStatisticsSnapshot {
+	uint_fast32_t burstID;
+	std::vector<uint64_t> L0receivedSourceIdsSubIds;
+	std::vector<uint64_t> L1receivedSourceIdsSubIds;
+};
+
+/*
+ * Like the HltStatistics counters the fragment counters exist in NA62_BURST_BANKS banks and every fragment
+ * is counted in the bank of the burst of its event. At the burst seal the finished bank is published as
+ * snapshot and the bank of the next burst is reset. All getters and the RC strings report the sealed burst.
+ */
 class DetectorStatistics {
 public:
 	DetectorStatistics();
@@ -24,51 +43,75 @@ public:
 	static void init(int, int);
 	static void shutdown();
 
+	/*
+	 * The banks are recycled by sealBurst: kept for compatibility with callers clearing the counters at
+	 * every EOB, which would otherwise wipe the burst being sealed
+	 */
 	static void clearL0DetectorStatistics() {
-		for (int i = 0; i < maxL0index; ++i) {
-			for (int j = 0; j < 32; ++j) {
-				L0receivedSourceIdsSubIds[i][j] = 0;
-			}
-		}
 	}
 
 	static void clearL1DetectorStatistics() {
-		for (int i = 0; i < maxL1index; ++i) {
-			for (int j = 0; j < 21; ++j) {
-				L1receivedSourceIdsSubIds[i][j] = 0;
-			}
-		}
 	}
 
-	static void incrementL0stat(int detId, int detSubId) {
-		L0receivedSourceIdsSubIds[detId / 4][detSubId].fetch_add(1,
-				std::memory_order_relaxed);
+	/*
+	 * Called for every fragment of every event: only the shard of the calling thread is written
+	 */
+	static inline void incrementL0stat(int detId, int detSubId, uint_fast32_t burstID) {
+		L0receivedSourceIdsSubIds[BurstIdHandler::getBank(burstID)].add((detId / 4) * 32 + detSubId, 1);
+	}
+
+	static inline void incrementL1stat(int crate, int slot, uint_fast32_t burstID) {
+		L1receivedSourceIdsSubIds[BurstIdHandler::getBank(burstID)].add(crate * 21 + slot, 1);
+	}
+
+	/*
+	 * Snapshot of the last sealed burst or nullptr if no burst has been sealed yet
+	 */
+	static std::shared_ptr<const DetectorStatisticsSnapshot> getSealedSnapshot() {
+		return std::atomic_load(&sealedSnapshot_);
+	}
+
+	static inline uint64_t getL0stat(int detId, int detSubId) {
+		std::shared_ptr<const DetectorStatisticsSnapshot> snapshot = getSealedSnapshot();
+		return snapshot ? snapshot->L0receivedSourceIdsSubIds[(detId / 4) * 32 + detSubId] : 0;
+	}
+
+	static inline uint64_t getL1stat(int crate, int slot) {
+		std::shared_ptr<const DetectorStatisticsSnapshot> snapshot = getSealedSnapshot();
+		return snapshot ? snapshot->L1receivedSourceIdsSubIds[crate * 21 + slot] : 0;
 	}
 
-	static void incrementL1stat(int crate, int slot) {
-		L1receivedSourceIdsSubIds[crate][slot].fetch_add(1,
-				std::memory_order_relaxed);
+	static inline int getMaxL0Index() {
+		return maxL0index;
+	}
+
+	static inline int getMaxL1Index() {
+		return maxL1index;
 	}
 
 	static string L0RCInfo() {
+		std::shared_ptr<const DetectorStatisticsSnapshot> snapshot = getSealedSnapshot();
 		ostringstream s;
 		for (int i = 0; i < maxL0index; ++i) {
 			s << hex << i * 4 << "; " << dec;
-			for (int j = 0; j < 32; ++j) {
-				if (L0receivedSourceIdsSubIds[i][j] > 0)
-					s << j << ":" << L0receivedSourceIdsSubIds[i][j] << " ";
+			for (int j = 0; snapshot && j < 32; ++j) {
+				const uint64_t received = snapshot->L0receivedSourceIdsSubIds[i * 32 + j];
+				if (received > 0)
+					s << j << ":" << received << " ";
 			}
 			s << "|";
 		}
 		return s.str();
 	}
 	static string L1RCInfo() {
+		std::shared_ptr<const DetectorStatisticsSnapshot> snapshot = getSealedSnapshot();
 		ostringstream s;
 		for (int i = 0; i < maxL1index; ++i) {
 			s << i << "; ";
-			for (int j = 0; j < 21; ++j) {
-				if (L1receivedSourceIdsSubIds[i][j] > 0)
-					s << j << ":" << L1receivedSourceIdsSubIds[i][j] << " ";
+			for (int j = 0; snapshot && j < 21; ++j) {
+				const uint64_t received = snapshot->L1receivedSourceIdsSubIds[i * 21 + j];
+				if (received > 0)
+					s << j << ":" << received << " ";
 			}
 			s << "|";
 		}
@@ -76,10 +119,14 @@ public:
 	}
 
 private:
+	static void sealBurst(const uint_fast32_t burstID, const uint_fast32_t nextBurstID);
+
 	static int maxL0index;
 	static int maxL1index;
-	static std::atomic<uint>** L0receivedSourceIdsSubIds;
-	static std::atomic<uint>** L1receivedSourceIdsSubIds;
+	// [detId/4][subId] with 32 subIds and [crate][slot] with 21 slots, sharded per thread, one bank per burst parity
+	static DynamicShardedCounters L0receivedSourceIdsSubIds[NA62_BURST_BANKS];
+	static DynamicShardedCounters L1receivedSourceIdsSubIds[NA62_BURST_BANKS];
+	static std::shared_ptr<const DetectorStatisticsSnapshot> sealedSnapshot_;
 
 };
 
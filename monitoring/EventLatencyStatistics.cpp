@@ -0,0 +1,94 @@
+/*
+ * EventLatencyStatistics.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: NA62 collaboration
+ */
+
+#include "EventLatencyStatistics.h"
+
+#include <mutex>
+#include <sstream>
+
+namespace na62 {
+
+LatencyHistogram EventLatencyStatistics::histograms_[NA62_BURST_BANKS][NUMBER_OF_LATENCY_STAGES];
+std::shared_ptr<const LatencySnapshot> EventLatencyStatistics::sealedSnapshot_;
+
+void EventLatencyStatistics::initialize() {
+	resetHistograms();
+
+	static std::once_flag sealListenerFlag;
+	std::call_once(sealListenerFlag, []() {
+		BurstIdHandler::addBurstSealListener(&EventLatencyStatistics::sealBurst);
+	});
+}
+
+const char* EventLatencyStatistics::getStageName(const LatencyStage stage) {
+	switch (stage) {
+	case LATENCY_L0_BUILDING:
+		return "L0Building";
+	case LATENCY_L1_PROCESSING:
+		return "L1Processing";
+	case LATENCY_L1_BUILDING:
+		return "L1Building";
+	case LATENCY_L2_PROCESSING:
+		return "L2Processing";
+	case LATENCY_SERIALIZATION:
+		return "Serialization";
+	default:
+		return "Unknown";
+	}
+}
+
+void EventLatencyStatistics::sealBurst(const uint_fast32_t burstID, const uint_fast32_t nextBurstID) {
+	const uint bank = BurstIdHandler::getBank(burstID);
+	std::shared_ptr<LatencySnapshot> snapshot = std::make_shared<LatencySnapshot>();
+	snapshot->burstID = burstID;
+	for (uint stage = 0; stage != NUMBER_OF_LATENCY_STAGES; stage++) {
+		const LatencyHistogram& histogram = histograms_[bank][stage];
+		LatencySnapshot::Stage& copy = snapshot->stages[stage];
+		copy.count = histogram.copyBuckets(copy.buckets);
+		copy.sum = histogram.getSum();
+		copy.max = histogram.getMax();
+	}
+	std::atomic_store(&sealedSnapshot_, std::shared_ptr<const LatencySnapshot>(snapshot));
+
+	resetBank(BurstIdHandler::getBank(nextBurstID));
+}
+
+std::string EventLatencyStatistics::toJson() {
+	std::shared_ptr<const LatencySnapshot> snapshot = getSealedSnapshot();
+	if (!snapshot) {
+		return "{}";
+	}
+
+	std::stringstream stream;
+	stream << "{\"burstID\":" << snapshot->burstID;
+	for (uint stage = 0; stage != NUMBER_OF_LATENCY_STAGES; stage++) {
+		const LatencySnapshot::Stage& histogram = snapshot->stages[stage];
+		stream << ",\"" << getStageName((LatencyStage) stage) << "\":{\"count\":" << histogram.count
+				<< ",\"mean\":" << (histogram.count == 0 ? 0 : histogram.sum / histogram.count)
+				<< ",\"p50\":" << snapshot->getPercentile((LatencyStage) stage, 0.5)
+				<< ",\"p99\":" << snapshot->getPercentile((LatencyStage) stage, 0.99)
+				<< ",\"p999\":" << snapshot->getPercentile((LatencyStage) stage, 0.999)
+				<< ",\"max\":" << histogram.max << "}";
+	}
+	stream << "}";
+	return stream.str();
+}
+
+void EventLatencyStatistics::resetBank(const uint bank) {
+	for (auto& histogram : histograms_[bank]) {
+		histogram.reset();
+	}
+}
+
+void EventLatencyStatistics::resetHistograms() {
+	for (uint bank = 0; bank != NA62_BURST_BANKS; bank++) {
+		resetBank(bank);
+	}
+	std::atomic_store(&sealedSnapshot_, std::shared_ptr<const LatencySnapshot>());
+}
+
+} /* namespace na62 */
@@ -0,0 +1,121 @@
+/*
+ * EventLatencyStatistics.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: NA62 collaboration
+ */
+
+#pragma once
+#ifndef EVENTLATENCYSTATISTICS_H_
+#define EVENTLATENCYSTATISTICS_H_
+
+#include <sys/types.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "BurstIdHandler.h"
+#include "LatencyHistogram.h"
+
+namespace na62 {
+
+/*
+ * Processing stages of an event as measured by Event (all in microseconds)
+ */
+enum LatencyStage {
+	LATENCY_L0_BUILDING, // first to last L0 fragment
+	LATENCY_L1_PROCESSING, // last L0 fragment to end of L1 processing
+	LATENCY_L1_BUILDING, // end of L1 processing to last L1 fragment
+	LATENCY_L2_PROCESSING, // last L1 fragment to end of L2 processing
+	LATENCY_SERIALIZATION, // end of L2 processing to end of serialization
+	NUMBER_OF_LATENCY_STAGES
+};
+
+/*
+ * Copy of the histograms of one burst
+ */
+struct LatencySnapshot {
+	struct Stage {
+		uint64_t buckets[LATENCY_HISTOGRAM_BUCKETS];
+		uint64_t count;
+		uint64_t sum;
+		uint32_t max;
+	};
+
+	uint_fast32_t burstID;
+	Stage stages[NUMBER_OF_LATENCY_STAGES];
+
+	uint32_t getPercentile(const LatencyStage stage, const double quantile) const {
+		const Stage& histogram = stages[stage];
+		return LatencyHistogram::getPercentile(histogram.buckets, histogram.count, histogram.max, quantile);
+	}
+};
+
+/*
+ * One latency histogram per stage, filled by Event. Like the HltStatistics counters the histograms exist in
+ * NA62_BURST_BANKS banks and every event is recorded in the bank of its own burst ID. At the burst seal the
+ * bank of the finished burst is published as snapshot and the bank of the next burst is reset.
+ */
+class EventLatencyStatistics {
+public:
+	/*
+	 * Resets all banks and registers the burst seal listener. Called by Event::initialize
+	 */
+	static void initialize();
+
+	static inline void record(const LatencyStage stage, const uint32_t micros, const uint_fast32_t burstID) {
+		/*
+		 * Stage times are computed as differences of the time since the first fragment. If the stages
+		 * did not happen in the expected order the difference wraps around: don't record these
+		 */
+		if (micros & 0x80000000) {
+			return;
+		}
+		histograms_[BurstIdHandler::getBank(burstID)][stage].record(micros);
+	}
+
+	/*
+	 * Histograms of the running burst
+	 */
+	static const LatencyHistogram& getHistogram(const LatencyStage stage) {
+		return histograms_[BurstIdHandler::getBank(BurstIdHandler::getCurrentBurstId())][stage];
+	}
+
+	static uint32_t getPercentile(const LatencyStage stage, const double quantile) {
+		return getHistogram(stage).getPercentile(quantile);
+	}
+
+	static uint64_t getCount(const LatencyStage stage) {
+		return getHistogram(stage).getCount();
+	}
+
+	/*
+	 * Histograms of the last sealed burst or nullptr if no burst has been sealed yet
+	 */
+	static std::shared_ptr<const LatencySnapshot> getSealedSnapshot() {
+		return std::atomic_load(&sealedSnapshot_);
+	}
+
+	static const char* getStageName(const LatencyStage stage);
+
+	/*
+	 * The sealed burst as {"burstID":..,"L0Building":{"count":..,"mean":..,"p50":..,"p99":..,"p999":..,"max":..},...}
+	 */
+	static std::string toJson();
+
+	/*
+	 * Resets all banks: only to be used at start of run, at the end of a burst the banks are recycled by sealBurst
+	 */
+	static void resetHistograms();
+
+private:
+	static void sealBurst(const uint_fast32_t burstID, const uint_fast32_t nextBurstID);
+	static void resetBank(const uint bank);
+
+	static LatencyHistogram histograms_[NA62_BURST_BANKS][NUMBER_OF_LATENCY_STAGES];
+	static std::shared_ptr<const LatencySnapshot> sealedSnapshot_;
+};
+
+} /* namespace na62 */
+
+#endif /* EVENTLATENCYSTATISTICS_H_ */
@@ -8,14 +8,67 @@
 #include <monitoring/HltStatistics.h>
 #include <monitoring/BurstIdHandler.h>
 #include <array>
+#include <iostream>
+#include <mutex>
 
 namespace na62 {
 
-std::atomic<uint64_t>* HltStatistics::L1Triggers_ = new std::atomic<uint64_t>[0xFF + 1];
-std::atomic<uint64_t>* HltStatistics::L2Triggers_ = new std::atomic<uint64_t>[0xFF + 1];
+std::atomic<uint64_t> HltStatistics::L1Triggers_[NA62_BURST_BANKS][0xFF + 1];
+std::atomic<uint64_t> HltStatistics::L2Triggers_[NA62_BURST_BANKS][0xFF + 1];
 
-std::map<std::string, std::atomic<uint64_t>> HltStatistics::counters_;
-std::map<std::string, std::array<std::atomic<uint64_t>, 16>> HltStatistics::dimensionalCounters_;
+const char* HltStatistics::counterNames_[NUMBER_OF_HLT_COUNTERS] = {
+		"L1InputEvents",
+		"L1SpecialEvents",
+		"L1ControlEvents",
+		"L1PeriodicsEvents",
+		"L1PhysicsEvents",
+		"L1PhysicsEventsByMultipleMasks",
+		"L1RequestToCreams",
+		"L1OutputEvents",
+		"L1AcceptedEvents",
+		"L1TimeoutEvents",
+		"L1AllDisabledEvents",
+		"L1BypassEvents",
+		"L1FlagAlgoEvents",
+		"L1AutoPassEvents",
+		"L1CorruptedHeader",
+
+		"L2InputEvents",
+		"L2SpecialEvents",
+		"L2ControlEvents",
+		"L2PeriodicsEvents",
+		"L2PhysicsEvents",
+		"L2PhysicsEventsByMultipleMasks",
+		"L2OutputEvents",
+		"L2AcceptedEvents",
+		"L2TimeoutEvents",
+		"L2AllDisabledEvents",
+		"L2BypassEvents",
+		"L2FlagAlgoEvents",
+		"L2AutoPassEvents",
+
+		"EventsToMerger",
+		"BytesToMerger" };
+
+const char* HltStatistics::dimensionalCounterNames_[NUMBER_OF_HLT_DIMENSIONAL_COUNTERS] = {
+		"L1InputEventsPerMask",
+		"L1AcceptedEventsPerMask",
+		"L2InputEventsPerMask",
+		"L2AcceptedEventsPerMask" };
+
+// Defined after the names: initialized in this order
+const std::unordered_map<std::string, int> HltStatistics::counterIndices_ = HltStatistics::indexNames(counterNames_,
+		NUMBER_OF_HLT_COUNTERS);
+const std::unordered_map<std::string, int> HltStatistics::dimensionalCounterIndices_ = HltStatistics::indexNames(
+		dimensionalCounterNames_, NUMBER_OF_HLT_DIMENSIONAL_COUNTERS);
+
+ShardedCounters<NUMBER_OF_HLT_COUNTERS> HltStatistics::shardedCounters_[NA62_BURST_BANKS];
+ShardedCounters<NUMBER_OF_HLT_DIMENSIONAL_COUNTERS * HLT_NUMBER_OF_MASKS> HltStatistics::shardedDimensionalCounters_[NA62_BURST_BANKS];
+std::shared_ptr<const HltBurstSnapshot> HltStatistics::sealedSnapshot_;
+
+std::mutex HltStatistics::otherCountersMutex_;
+std::map<std::string, std::atomic<uint64_t>> HltStatistics::otherCounters_;
+std::map<std::string, std::array<std::atomic<uint64_t>, HLT_NUMBER_OF_MASKS>> HltStatistics::otherDimensionalCounters_;
 l1EOBInfo HltStatistics::l1EobStruct_;
 l2EOBInfo HltStatistics::l2EobStruct_;
 int HltStatistics::logicalID_ = 0;
@@ -28,47 +81,210 @@ void HltStatistics::initialize(int logicalID) {
 
 	logicalID_ = logicalID;
 
-	counters_["L1InputEvents"] = 0;
-	counters_["L1SpecialEvents"] = 0;
-	counters_["L1ControlEvents"] = 0;
-	counters_["L1PeriodicsEvents"] = 0;
-	counters_["L1PhysicsEvents"] = 0;
-	counters_["L1PhysicsEventsByMultipleMasks"] = 0;
-	counters_["L1RequestToCreams"] = 0;
-	counters_["L1OutputEvents"] = 0;
-	counters_["L1AcceptedEvents"] = 0;
-	counters_["L1TimeoutEvents"] = 0;
-	counters_["L1AllDisabledEvents"] = 0;
-	counters_["L1BypassEvents"] = 0;
-	counters_["L1FlagAlgoEvents"] = 0;
-	counters_["L1AutoPassEvents"] = 0;
-	counters_["L1CorruptedHeader"] = 0;
-
-	counters_["L2InputEvents"] = 0;
-	counters_["L2SpecialEvents"] = 0;
-	counters_["L2ControlEvents"] = 0;
-	counters_["L2PeriodicsEvents"] = 0;
-	counters_["L2PhysicsEvents"] = 0;
-	counters_["L2PhysicsEventsByMultipleMasks"] = 0;
-	counters_["L2OutputEvents"] = 0;
-	counters_["L2AcceptedEvents"] = 0;
-	counters_["L2TimeoutEvents"] = 0;
-	counters_["L2AllDisabledEvents"] = 0;
-	counters_["L2BypassEvents"] = 0;
-	counters_["L2FlagAlgoEvents"] = 0;
-	counters_["L2AutoPassEvents"] = 0;
+	resetBanks();
+
+	static std::once_flag sealListenerFlag;
+	std::call_once(sealListenerFlag, []() {
+		BurstIdHandler::addBurstSealListener(&HltStatistics::sealBurst);
+	});
+}
+
+std::unordered_map<std::string, int> HltStatistics::indexNames(const char* const * names, const uint numberOfNames) {
+	std::unordered_map<std::string, int> indices;
+	for (uint index = 0; index != numberOfNames; index++) {
+		indices[names[index]] = index;
+	}
+	return indices;
+}
+
+int HltStatistics::findCounter(const std::string& key) {
+	auto it = counterIndices_.find(key);
+	return it == counterIndices_.end() ? -1 : it->second;
+}
+
+int HltStatistics::findDimensionalCounter(const std::string& key) {
+	auto it = dimensionalCounterIndices_.find(key);
+	return it == dimensionalCounterIndices_.end() ? -1 : it->second;
+}
+
+uint64_t HltStatistics::sumCounter(const std::string& key, uint amount) {
+	const int counter = findCounter(key);
+	if (counter >= 0) {
+		return shardedCounters_[BurstIdHandler::getBank(BurstIdHandler::getCurrentBurstId())].fetchAdd(counter,
+				amount);
+	}
+	std::lock_guard<std::mutex> lock(otherCountersMutex_);
+	return otherCounters_[key].fetch_add(amount, std::memory_order_relaxed);
+}
+
+uint64_t HltStatistics::getCounter(const std::string& key) {
+	const int counter = findCounter(key);
+	if (counter >= 0) {
+		return getCounter((HltCounter) counter);
+	}
+	std::lock_guard<std::mutex> lock(otherCountersMutex_);
+	auto it = otherCounters_.find(key);
+	return it == otherCounters_.end() ? 0 : it->second.load();
+}
+
+uint64_t HltStatistics::sumDimensionalCounter(const std::string& key, uint array_index, uint amount) {
+	const int counter = findDimensionalCounter(key);
+	if (counter >= 0) {
+		return shardedDimensionalCounters_[BurstIdHandler::getBank(BurstIdHandler::getCurrentBurstId())].fetchAdd(
+				counter * HLT_NUMBER_OF_MASKS + array_index, amount);
+	}
+	std::lock_guard<std::mutex> lock(otherCountersMutex_);
+	return otherDimensionalCounters_[key][array_index].fetch_add(amount, std::memory_order_relaxed);
+}
+
+uint64_t HltStatistics::getDimensionalCounter(const std::string& key, uint array_index) {
+	const int counter = findDimensionalCounter(key);
+	if (counter >= 0) {
+		return getDimensionalCounter((HltDimensionalCounter) counter, array_index);
+	}
+	std::lock_guard<std::mutex> lock(otherCountersMutex_);
+	auto it = otherDimensionalCounters_.find(key);
+	return it == otherDimensionalCounters_.end() ? 0 : it->second[array_index].load();
+}
+
+void HltStatistics::resetBank(const uint bank) {
+	shardedCounters_[bank].reset();
+	shardedDimensionalCounters_[bank].reset();
+	for (int i = 0; i != 0xFF + 1; i++) {
+		L1Triggers_[bank][i].store(0, std::memory_order_relaxed);
+		L2Triggers_[bank][i].store(0, std::memory_order_relaxed);
+	}
+}
+
+void HltStatistics::resetCounters() {
+}
+
+void HltStatistics::resetBanks() {
+	for (uint bank = 0; bank != NA62_BURST_BANKS; bank++) {
+		resetBank(bank);
+	}
+	std::atomic_store(&sealedSnapshot_, std::shared_ptr<const HltBurstSnapshot>());
+	resetOtherCounters();
+}
 
+void HltStatistics::resetOtherCounters() {
+	std::lock_guard<std::mutex> lock(otherCountersMutex_);
+	for (auto& counter : otherCounters_) {
+		counter.second = 0;
+	}
+	for (auto& counter : otherDimensionalCounters_) {
+		for (uint index = 0; index < HLT_NUMBER_OF_MASKS; index++) {
+			counter.second[index] = 0;
+		}
+	}
+}
+
+std::shared_ptr<HltBurstSnapshot> HltStatistics::takeSnapshot(const uint_fast32_t burstID) {
+	const uint bank = BurstIdHandler::getBank(burstID);
+	std::shared_ptr<HltBurstSnapshot> snapshot = std::make_shared<HltBurstSnapshot>();
+	snapshot->burstID = burstID;
+	for (uint counter = 0; counter != NUMBER_OF_HLT_COUNTERS; counter++) {
+		snapshot->counters[counter] = shardedCounters_[bank].get(counter);
+	}
+	for (uint counter = 0; counter != NUMBER_OF_HLT_DIMENSIONAL_COUNTERS; counter++) {
+		for (uint index = 0; index < HLT_NUMBER_OF_MASKS; index++) {
+			snapshot->dimensionalCounters[counter][index] = shardedDimensionalCounters_[bank].get(
+					counter * HLT_NUMBER_OF_MASKS + index);
+		}
+	}
 	for (int i = 0; i != 0xFF + 1; i++) {
-		L1Triggers_[i] = 0;
-		L2Triggers_[i] = 0;
+		snapshot->l1Triggers[i] = L1Triggers_[bank][i].load(std::memory_order_relaxed);
+		snapshot->l2Triggers[i] = L2Triggers_[bank][i].load(std::memory_order_relaxed);
+	}
+	return snapshot;
+}
+
+void HltStatistics::sealBurst(const uint_fast32_t burstID, const uint_fast32_t nextBurstID) {
+	std::shared_ptr<const HltBurstSnapshot> previous = getSealedSnapshot();
+	std::atomic_store(&sealedSnapshot_, std::shared_ptr<const HltBurstSnapshot>(takeSnapshot(burstID)));
+
+	const uint nextBank = BurstIdHandler::getBank(nextBurstID);
+	if (previous && previous->burstID != burstID && BurstIdHandler::getBank(previous->burstID) == nextBank) {
+		const uint64_t lateEvents = shardedCounters_[nextBank].get((uint) HltCounter::L1InputEvents) - previous->getCounter(HltCounter::L1InputEvents);
+		if (lateEvents != 0) {
+			LOG_ERROR(lateEvents << " events of burst " << previous->burstID << " were processed after its EOB statistics had been sealed");
+		}
+	}
+	resetBank(nextBank);
+	resetOtherCounters();
+}
+
+std::shared_ptr<const HltBurstSnapshot> HltStatistics::getBurstSnapshot(const uint_fast32_t burstID) {
+	std::shared_ptr<const HltBurstSnapshot> sealed = getSealedSnapshot();
+	if (sealed && sealed->burstID == burstID) {
+		return sealed;
+	}
+	return takeSnapshot(burstID);
+}
+
+std::string HltStatistics::toJson() {
+	std::shared_ptr<const HltBurstSnapshot> snapshot = getSealedSnapshot();
+	if (!snapshot) {
+		return "{}";
+	}
+
+	std::stringstream stream;
+	stream << "{\"burstID\":" << snapshot->burstID;
+	for (uint counter = 0; counter != NUMBER_OF_HLT_COUNTERS; counter++) {
+		stream << ",\"" << counterNames_[counter] << "\":" << snapshot->counters[counter];
+	}
+	for (uint counter = 0; counter != NUMBER_OF_HLT_DIMENSIONAL_COUNTERS; counter++) {
+		stream << ",\"" << dimensionalCounterNames_[counter] << "\":[";
+		for (uint index = 0; index < HLT_NUMBER_OF_MASKS; index++) {
+			stream << (index == 0 ? "" : ",") << snapshot->dimensionalCounters[counter][index];
+		}
+		stream << "]";
+	}
+	stream << "}";
+	return stream.str();
+}
+
+std::string HltStatistics::serializeDimensionalCounter(const std::string& key) {
+	std::stringstream serializedConters;
+	for (uint index = 0; index < HLT_NUMBER_OF_MASKS; index++) {
+		const uint64_t value = getDimensionalCounter(key, index);
+		if (value > 0) { //Zero suppression
+			serializedConters << index << ":" << value << ";";
+		}
+	}
+	return serializedConters.str();
+}
+
+void HltStatistics::printCounter() {
+	for (auto const& key : extractKeys()) {
+		std::cout << key << " => " << getCounter(key) << '\n';
+	}
+}
+
+void HltStatistics::printDimensionalCounter() {
+	for (auto const& key : extractDimensionalKeys()) {
+		for (uint i = 0; i < HLT_NUMBER_OF_MASKS; i++)
+			std::cout << key << " => " << getDimensionalCounter(key, i) << '\n';
+	}
+}
+
+std::vector<std::string> HltStatistics::extractKeys() {
+	std::vector<std::string> keys(counterNames_, counterNames_ + NUMBER_OF_HLT_COUNTERS);
+	std::lock_guard<std::mutex> lock(otherCountersMutex_);
+	for (auto const& counter : otherCounters_) {
+		keys.push_back(counter.first);
 	}
+	return keys;
+}
 
-	for (int i = 0; i != 16; ++i) {
-		dimensionalCounters_["L1InputEventsPerMask"][i] = 0;
-		dimensionalCounters_["L1AcceptedEventsPerMask"][i] = 0;
-		dimensionalCounters_["L2InputEventsPerMask"][i] = 0;
-		dimensionalCounters_["L2AcceptedEventsPerMask"][i] = 0;
+std::vector<std::string> HltStatistics::extractDimensionalKeys() {
+	std::vector<std::string> keys(dimensionalCounterNames_,
+			dimensionalCounterNames_ + NUMBER_OF_HLT_DIMENSIONAL_COUNTERS);
+	std::lock_guard<std::mutex> lock(otherCountersMutex_);
+	for (auto const& counter : otherDimensionalCounters_) {
+		keys.push_back(counter.first);
 	}
+	return keys;
 }
 
 void HltStatistics::updateL1Statistics(Event* const event, uint_fast8_t l1Trigger) {
@@ -76,8 +292,9 @@ void HltStatistics::updateL1Statistics(Event* const event, uint_fast8_t l1Trigge
 	 * Method for stats update - all L1 monitoring counters but L1RequestToCreams are incremented here
 	 */
 	uint_fast16_t l0TrigFlags = event->getTriggerFlags();
-	HltStatistics::sumCounter("L1InputEvents", 1);
-	//LOG_INFO("Update L1 Statistics: L1InputsEvents: " << HltStatistics::getCounter("L1InputEvents"));
+	const uint_fast32_t burstID = event->getBurstID();
+	HltStatistics::sumCounter(HltCounter::L1InputEvents, 1, burstID);
+	//LOG_INFO("Update L1 Statistics: L1InputsEvents: " << HltStatistics::getCounter(HltCounter::L1InputEvents));
 
 	/*
 	 *Special triggers are all counted together
@@ -86,24 +303,24 @@ void HltStatistics::updateL1Statistics(Event* const event, uint_fast8_t l1Trigge
 	 *Separate treatments in processing due to different requests for zero-suppression in LKr
 	 */
 	if (event->isSpecialTriggerEvent() || event->isPulserGTKTriggerEvent()) {
-		HltStatistics::sumCounter("L1SpecialEvents", 1);
+		HltStatistics::sumCounter(HltCounter::L1SpecialEvents, 1, burstID);
 	}
 
 	if (event->isControlTriggerEvent()) {
-		HltStatistics::sumCounter("L1ControlEvents", 1);
+		HltStatistics::sumCounter(HltCounter::L1ControlEvents, 1, burstID);
 	}
 	if (event->isPeriodicTriggerEvent()) {
-		HltStatistics::sumCounter("L1PeriodicsEvents", 1);
+		HltStatistics::sumCounter(HltCounter::L1PeriodicsEvents, 1, burstID);
 	}
 	if (event->isPhysicsTriggerEvent()) {
-		HltStatistics::sumCounter("L1PhysicsEvents", 1);
+		HltStatistics::sumCounter(HltCounter::L1PhysicsEvents, 1, burstID);
 		if (__builtin_popcount((uint) l0TrigFlags) > 1)
-			HltStatistics::sumCounter("L1PhysicsEventsByMultipleMasks", 1);
+			HltStatistics::sumCounter(HltCounter::L1PhysicsEventsByMultipleMasks, 1, burstID);
 		for (int i = 0; i != 16; i++) {
 			if (l0TrigFlags & (1 << i)) {
-				HltStatistics::sumDimensionalCounter("L1InputEventsPerMask", i, 1);
+				HltStatistics::sumDimensionalCounter(HltDimensionalCounter::L1InputEventsPerMask, i, 1, burstID);
 				if (event->getL1TriggerWord(i)) {
-					HltStatistics::sumDimensionalCounter("L1AcceptedEventsPerMask", i, 1);
+					HltStatistics::sumDimensionalCounter(HltDimensionalCounter::L1AcceptedEventsPerMask, i, 1, burstID);
 				}
 			}
 		}
@@ -119,26 +336,26 @@ void HltStatistics::updateL1Statistics(Event* const event, uint_fast8_t l1Trigge
 	 * bit 7 = AutoPass (AP) event (fraction of overall bandwidth)
 	 */
 	if (l1Trigger & TRIGGER_L1_PHYSICS) {
-		HltStatistics::sumCounter("L1AcceptedEvents", 1);
+		HltStatistics::sumCounter(HltCounter::L1AcceptedEvents, 1, burstID);
 	}
 	if (l1Trigger & TRIGGER_L1_TIMEOUT) {
-		HltStatistics::sumCounter("L1TimeoutEvents", 1);
+		HltStatistics::sumCounter(HltCounter::L1TimeoutEvents, 1, burstID);
 	}
 	if (l1Trigger & TRIGGER_L1_ALLDISABLED) {
-		HltStatistics::sumCounter("L1AllDisabledEvents", 1);
+		HltStatistics::sumCounter(HltCounter::L1AllDisabledEvents, 1, burstID);
 	}
 	if (l1Trigger & TRIGGER_L1_BYPASS) {
-		HltStatistics::sumCounter("L1BypassEvents", 1);
+		HltStatistics::sumCounter(HltCounter::L1BypassEvents, 1, burstID);
 	}
 	if (l1Trigger & TRIGGER_L1_FLAGALGO) {
-		HltStatistics::sumCounter("L1FlagAlgoEvents", 1);
+		HltStatistics::sumCounter(HltCounter::L1FlagAlgoEvents, 1, burstID);
 	}
 	if (l1Trigger & TRIGGER_L1_AUTOPASS) {
-		HltStatistics::sumCounter("L1AutoPassEvents", 1);
+		HltStatistics::sumCounter(HltCounter::L1AutoPassEvents, 1, burstID);
 	}
 	if (l1Trigger != 0) {
-		HltStatistics::sumCounter("L1OutputEvents", 1);
-		HltStatistics::sumL1TriggerStats(1, l1Trigger);
+		HltStatistics::sumCounter(HltCounter::L1OutputEvents, 1, burstID);
+		HltStatistics::sumL1TriggerStats(1, l1Trigger, burstID);
 	} else {
 		//event has been reduced or downscaled
 	}
@@ -149,7 +366,8 @@ void HltStatistics::updateL2Statistics(Event* const event, uint_fast8_t l2Trigge
 	 * Method for stats update - all L1 monitoring counters but L1RequestToCreams are incremented here
 	 */
 	uint_fast16_t l0TrigFlags = event->getTriggerFlags();
-	HltStatistics::sumCounter("L2InputEvents", 1);
+	const uint_fast32_t burstID = event->getBurstID();
+	HltStatistics::sumCounter(HltCounter::L2InputEvents, 1, burstID);
 
 	/*
 	 *Special triggers are all counted together
@@ -157,23 +375,23 @@ void HltStatistics::updateL2Statistics(Event* const event, uint_fast8_t l2Trigge
 	 *l0 trigger word (ZS): GTK pulsers =0x2c
 	 */
 	if (event->isSpecialTriggerEvent() || event->isPulserGTKTriggerEvent()) {
-		HltStatistics::sumCounter("L2SpecialEvents", 1);
+		HltStatistics::sumCounter(HltCounter::L2SpecialEvents, 1, burstID);
 	}
 	if (event->isControlTriggerEvent()) {
-		HltStatistics::sumCounter("L2ControlEvents", 1);
+		HltStatistics::sumCounter(HltCounter::L2ControlEvents, 1, burstID);
 	}
 	if (event->isPeriodicTriggerEvent()) {
-		HltStatistics::sumCounter("L2PeriodicsEvents", 1);
+		HltStatistics::sumCounter(HltCounter::L2PeriodicsEvents, 1, burstID);
 	}
 	if (event->isPhysicsTriggerEvent()) {
-		HltStatistics::sumCounter("L2PhysicsEvents", 1);
+		HltStatistics::sumCounter(HltCounter::L2PhysicsEvents, 1, burstID);
 		if (__builtin_popcount((uint) l0TrigFlags) > 1)
-			HltStatistics::sumCounter("L2PhysicsEventsByMultipleMasks", 1);
+			HltStatistics::sumCounter(HltCounter::L2PhysicsEventsByMultipleMasks, 1, burstID);
 		for (int i = 0; i != 16; i++) {
 			if (l0TrigFlags & (1 << i)) {
-				HltStatistics::sumDimensionalCounter("L2InputEventsPerMask", i, 1);
+				HltStatistics::sumDimensionalCounter(HltDimensionalCounter::L2InputEventsPerMask, i, 1, burstID);
 				if (event->getL2TriggerWord(i)) {
-					HltStatistics::sumDimensionalCounter("L2AcceptedEventsPerMask", i, 1);
+					HltStatistics::sumDimensionalCounter(HltDimensionalCounter::L2AcceptedEventsPerMask, i, 1, burstID);
 				}
 			}
 		}
@@ -188,37 +406,38 @@ void HltStatistics::updateL2Statistics(Event* const event, uint_fast8_t l2Trigge
 	 * bit 7 = AutoPass (AP) event (fraction of overall bandwidth)
 	 */
 	if (l2Trigger & TRIGGER_L2_PHYSICS) {
-		HltStatistics::sumCounter("L2AcceptedEvents", 1);
+		HltStatistics::sumCounter(HltCounter::L2AcceptedEvents, 1, burstID);
 	}
 	if (l2Trigger & TRIGGER_L2_TIMEOUT) {
-		HltStatistics::sumCounter("L2TimeoutEvents", 1);
+		HltStatistics::sumCounter(HltCounter::L2TimeoutEvents, 1, burstID);
 	}
 	if (l2Trigger & TRIGGER_L2_ALLDISABLED) {
-		HltStatistics::sumCounter("L2AllDisabledEvents", 1);
+		HltStatistics::sumCounter(HltCounter::L2AllDisabledEvents, 1, burstID);
 	}
 	if (l2Trigger & TRIGGER_L2_BYPASS) {
-		HltStatistics::sumCounter("L2BypassEvents", 1);
+		HltStatistics::sumCounter(HltCounter::L2BypassEvents, 1, burstID);
 	}
 	if (l2Trigger & TRIGGER_L2_FLAGALGO) {
-		HltStatistics::sumCounter("L2FlagAlgoEvents", 1);
+		HltStatistics::sumCounter(HltCounter::L2FlagAlgoEvents, 1, burstID);
 	}
 	if (l2Trigger & TRIGGER_L2_AUTOPASS) {
-		HltStatistics::sumCounter("L2AutoPassEvents", 1);
+		HltStatistics::sumCounter(HltCounter::L2AutoPassEvents, 1, burstID);
 	}
 	if (l2Trigger != 0) {
-		HltStatistics::sumCounter("L2OutputEvents", 1);
-		HltStatistics::sumL2TriggerStats(1, l2Trigger);
+		HltStatistics::sumCounter(HltCounter::L2OutputEvents, 1, burstID);
+		HltStatistics::sumL2TriggerStats(1, l2Trigger, burstID);
 	} else {
 		//event has been reduced or downscaled
 	}
 }
 
 void HltStatistics::updateStorageStatistics(uint64_t BytesSentToStorage) {
-	HltStatistics::sumCounter("EventsToMerger", 1);
-	HltStatistics::sumCounter("BytesToMerger", BytesSentToStorage);
+	HltStatistics::sumCounter(HltCounter::EventsToMerger, 1);
+	HltStatistics::sumCounter(HltCounter::BytesToMerger, BytesSentToStorage);
 }
 
 std::string HltStatistics::fillL1Eob() {
+	std::shared_ptr<const HltBurstSnapshot> snapshot = getBurstSnapshot(BurstIdHandler::getCurrentBurstId());
 
 	/*
 	 * Prepare header - this is the same as for each detector source - do not change it!)
@@ -234,66 +453,29 @@ std::string HltStatistics::fillL1Eob() {
 	 */
 
 	l1EobStruct_.l1EobData.formatVersion = 1;
-	l1EobStruct_.l1EobData.timeoutFlag = (getCounter("L1TimeoutEvents") > 0);
+	l1EobStruct_.l1EobData.timeoutFlag = (snapshot->getCounter(HltCounter::L1TimeoutEvents) > 0);
 	l1EobStruct_.l1EobData.reserved = 0;
 
-	for (auto const& counter : counters_) {
-		if (counter.first == "L1CorruptedHeader") {
-			l1EobStruct_.l1EobData.L1CorruptedHeaderEvents = counter.second;
-		}
-		if (counter.first == "L1InputEvents") {
-			l1EobStruct_.l1EobData.L1InputEvents = counter.second;
-		}
-		if (counter.first == "L1SpecialEvents") {
-			l1EobStruct_.l1EobData.L1SpecialEvents = counter.second;
-		}
-		if (counter.first == "L1ControlEvents") {
-			l1EobStruct_.l1EobData.L1ControlEvents = counter.second;
-		}
-		if (counter.first == "L1PeriodicsEvents") {
-			l1EobStruct_.l1EobData.L1PeriodicsEvents = counter.second;
-		}
-		if (counter.first == "L1PhysicsEvents") {
-			l1EobStruct_.l1EobData.L1PhysicsEvents = counter.second;
-		}
-		if (counter.first == "L1PhysicsEventsByMultipleMasks") {
-			l1EobStruct_.l1EobData.L1PhysicsEventsByMultipleMasks = counter.second;
-		}
-		if (counter.first == "L1RequestToCreams") {
-			l1EobStruct_.l1EobData.L1RequestToCreams = counter.second;
-		}
-		if (counter.first == "L1OutputEvents") {
-			l1EobStruct_.l1EobData.L1OutputEvents = counter.second;
-		}
-		if (counter.first == "L1AcceptedEvents") {
-			l1EobStruct_.l1EobData.L1AcceptedEvents = counter.second;
-		}
-		if (counter.first == "L1TimeoutEvents") {
-			l1EobStruct_.l1EobData.L1TimeoutEvents = counter.second;
-		}
-		if (counter.first == "L1AllDisabledEvents") {
-			l1EobStruct_.l1EobData.L1AllDisabledEvents = counter.second;
-		}
-		if (counter.first == "L1BypassEvents") {
-			l1EobStruct_.l1EobData.L1BypassEvents = counter.second;
-		}
-		if (counter.first == "L1FlagAlgoEvents") {
-			l1EobStruct_.l1EobData.L1FlagAlgoEvents = counter.second;
-		}
-		if (counter.first == "L1AutoPassEvents") {
-			l1EobStruct_.l1EobData.L1AutoPassEvents = counter.second;
-		}
-	}
-	for (auto const& dimCounter : dimensionalCounters_) {
-		for (uint i = 0; i < 16; i++) {
-			if (dimCounter.first == "L1InputEventsPerMask") {
-				l1EobStruct_.l1EobData.l1Mask[i].L1InputEventsPerMask = dimCounter.second[i];
-			}
-			if (dimCounter.first == "L1AcceptedEventsPerMask") {
-				l1EobStruct_.l1EobData.l1Mask[i].L1AcceptedEventsPerMask = dimCounter.second[i];
-			}
-			l1EobStruct_.l1EobData.l1Mask[i].L1ReservedPerMask = 0;
-		}
+	l1EobStruct_.l1EobData.L1CorruptedHeaderEvents = snapshot->getCounter(HltCounter::L1CorruptedHeader);
+	l1EobStruct_.l1EobData.L1InputEvents = snapshot->getCounter(HltCounter::L1InputEvents);
+	l1EobStruct_.l1EobData.L1SpecialEvents = snapshot->getCounter(HltCounter::L1SpecialEvents);
+	l1EobStruct_.l1EobData.L1ControlEvents = snapshot->getCounter(HltCounter::L1ControlEvents);
+	l1EobStruct_.l1EobData.L1PeriodicsEvents = snapshot->getCounter(HltCounter::L1PeriodicsEvents);
+	l1EobStruct_.l1EobData.L1PhysicsEvents = snapshot->getCounter(HltCounter::L1PhysicsEvents);
+	l1EobStruct_.l1EobData.L1PhysicsEventsByMultipleMasks = snapshot->getCounter(HltCounter::L1PhysicsEventsByMultipleMasks);
+	l1EobStruct_.l1EobData.L1RequestToCreams = snapshot->getCounter(HltCounter::L1RequestToCreams);
+	l1EobStruct_.l1EobData.L1OutputEvents = snapshot->getCounter(HltCounter::L1OutputEvents);
+	l1EobStruct_.l1EobData.L1AcceptedEvents = snapshot->getCounter(HltCounter::L1AcceptedEvents);
+	l1EobStruct_.l1EobData.L1TimeoutEvents = snapshot->getCounter(HltCounter::L1TimeoutEvents);
+	l1EobStruct_.l1EobData.L1AllDisabledEvents = snapshot->getCounter(HltCounter::L1AllDisabledEvents);
+	l1EobStruct_.l1EobData.L1BypassEvents = snapshot->getCounter(HltCounter::L1BypassEvents);
+	l1EobStruct_.l1EobData.L1FlagAlgoEvents = snapshot->getCounter(HltCounter::L1FlagAlgoEvents);
+	l1EobStruct_.l1EobData.L1AutoPassEvents = snapshot->getCounter(HltCounter::L1AutoPassEvents);
+
+	for (uint i = 0; i < HLT_NUMBER_OF_MASKS; i++) {
+		l1EobStruct_.l1EobData.l1Mask[i].L1InputEventsPerMask = snapshot->getDimensionalCounter(HltDimensionalCounter::L1InputEventsPerMask, i);
+		l1EobStruct_.l1EobData.l1Mask[i].L1AcceptedEventsPerMask = snapshot->getDimensionalCounter(HltDimensionalCounter::L1AcceptedEventsPerMask, i);
+		l1EobStruct_.l1EobData.l1Mask[i].L1ReservedPerMask = 0;
 	}
 	char serializedStruct [sizeof(l1EOBInfo)];
     memcpy((void*) &serializedStruct, (void*) &l1EobStruct_, sizeof(l1EOBInfo));
@@ -301,6 +483,8 @@ std::string HltStatistics::fillL1Eob() {
 }
 
 std::string HltStatistics::fillL2Eob() {
+	std::shared_ptr<const HltBurstSnapshot> snapshot = getBurstSnapshot(BurstIdHandler::getCurrentBurstId());
+
 	/*
 	 * Prepare header - this is the same as for each detector source - do not change it!)
 	 */
@@ -315,61 +499,28 @@ std::string HltStatistics::fillL2Eob() {
 	 */
 
 	l2EobStruct_.l2EobData.formatVersion = 0;
-	l2EobStruct_.l2EobData.timeoutFlag = (getCounter("L2TimeoutEvents") > 0);
+	l2EobStruct_.l2EobData.timeoutFlag = (snapshot->getCounter(HltCounter::L2TimeoutEvents) > 0);
 	l2EobStruct_.l2EobData.reserved = 0;
 	l2EobStruct_.l2EobData.extraReserved = 0;
 
-	for (auto const& counter : counters_) {
-		if (counter.first == "L2InputEvents") {
-			l2EobStruct_.l2EobData.L2InputEvents = counter.second;
-		}
-		if (counter.first == "L2SpecialEvents") {
-			l2EobStruct_.l2EobData.L2SpecialEvents = counter.second;
-		}
-		if (counter.first == "L2ControlEvents") {
-			l2EobStruct_.l2EobData.L2ControlEvents = counter.second;
-		}
-		if (counter.first == "L2PeriodicsEvents") {
-			l2EobStruct_.l2EobData.L2PeriodicsEvents = counter.second;
-		}
-		if (counter.first == "L2PhysicsEvents") {
-			l2EobStruct_.l2EobData.L2PhysicsEvents = counter.second;
-		}
-		if (counter.first == "L2PhysicsEventsByMultipleMasks") {
-			l2EobStruct_.l2EobData.L2PhysicsEventsByMultipleMasks = counter.second;
-		}
-		if (counter.first == "L2OutputEvents") {
-			l2EobStruct_.l2EobData.L2OutputEvents = counter.second;
-		}
-		if (counter.first == "L2AcceptedEvents") {
-			l2EobStruct_.l2EobData.L2AcceptedEvents = counter.second;
-		}
-		if (counter.first == "L2TimeoutEvents") {
-			l2EobStruct_.l2EobData.L2TimeoutEvents = counter.second;
-		}
-		if (counter.first == "L2AllDisabledEvents") {
-			l2EobStruct_.l2EobData.L2AllDisabledEvents = counter.second;
-		}
-		if (counter.first == "L2BypassEvents") {
-			l2EobStruct_.l2EobData.L2BypassEvents = counter.second;
-		}
-		if (counter.first == "L2FlagAlgoEvents") {
-			l2EobStruct_.l2EobData.L2FlagAlgoEvents = counter.second;
-		}
-		if (counter.first == "L2AutoPassEvents") {
-			l2EobStruct_.l2EobData.L2AutoPassEvents = counter.second;
-		}
-	}
-	for (auto const& dimCounter : dimensionalCounters_) {
-		for (uint i = 0; i < 16; i++) {
-			if (dimCounter.first == "L2InputEventsPerMask") {
-				l2EobStruct_.l2EobData.l2Mask[i].L2InputEventsPerMask = dimCounter.second[i];
-			}
-			if (dimCounter.first == "L2AcceptedEventsPerMask") {
-				l2EobStruct_.l2EobData.l2Mask[i].L2AcceptedEventsPerMask = dimCounter.second[i];
-			}
-			l2EobStruct_.l2EobData.l2Mask[i].L2ReservedPerMask = 0;
-		}
+	l2EobStruct_.l2EobData.L2InputEvents = snapshot->getCounter(HltCounter::L2InputEvents);
+	l2EobStruct_.l2EobData.L2SpecialEvents = snapshot->getCounter(HltCounter::L2SpecialEvents);
+	l2EobStruct_.l2EobData.L2ControlEvents = snapshot->getCounter(HltCounter::L2ControlEvents);
+	l2EobStruct_.l2EobData.L2PeriodicsEvents = snapshot->getCounter(HltCounter::L2PeriodicsEvents);
+	l2EobStruct_.l2EobData.L2PhysicsEvents = snapshot->getCounter(HltCounter::L2PhysicsEvents);
+	l2EobStruct_.l2EobData.L2PhysicsEventsByMultipleMasks = snapshot->getCounter(HltCounter::L2PhysicsEventsByMultipleMasks);
+	l2EobStruct_.l2EobData.L2OutputEvents = snapshot->getCounter(HltCounter::L2OutputEvents);
+	l2EobStruct_.l2EobData.L2AcceptedEvents = snapshot->getCounter(HltCounter::L2AcceptedEvents);
+	l2EobStruct_.l2EobData.L2TimeoutEvents = snapshot->getCounter(HltCounter::L2TimeoutEvents);
+	l2EobStruct_.l2EobData.L2AllDisabledEvents = snapshot->getCounter(HltCounter::L2AllDisabledEvents);
+	l2EobStruct_.l2EobData.L2BypassEvents = snapshot->getCounter(HltCounter::L2BypassEvents);
+	l2EobStruct_.l2EobData.L2FlagAlgoEvents = snapshot->getCounter(HltCounter::L2FlagAlgoEvents);
+	l2EobStruct_.l2EobData.L2AutoPassEvents = snapshot->getCounter(HltCounter::L2AutoPassEvents);
+
+	for (uint i = 0; i < HLT_NUMBER_OF_MASKS; i++) {
+		l2EobStruct_.l2EobData.l2Mask[i].L2InputEventsPerMask = snapshot->getDimensionalCounter(HltDimensionalCounter::L2InputEventsPerMask, i);
+		l2EobStruct_.l2EobData.l2Mask[i].L2AcceptedEventsPerMask = snapshot->getDimensionalCounter(HltDimensionalCounter::L2AcceptedEventsPerMask, i);
+		l2EobStruct_.l2EobData.l2Mask[i].L2ReservedPerMask = 0;
 	}
 	char serializedStruct [sizeof(l2EOBInfo)];
     memcpy((void*) &serializedStruct, (void*) &l2EobStruct_, sizeof(l2EOBInfo));
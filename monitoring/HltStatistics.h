@@ -8,14 +8,105 @@
 #ifndef MONITORING_HLTSTATISTICS_H_
 #define MONITORING_HLTSTATISTICS_H_
 
+#include <array>
 #include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <eventBuilding/Event.h>
 #include <structs/Event.h>
 #include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include <structs/EOBPackets.h>
+#include <utils/ThreadShard.h>
+#include <monitoring/BurstIdHandler.h>
 
 namespace na62 {
 
+/*
+ * All counters of the HLT. The names used for serialization are stored in HltStatistics::counterNames_
+ * in the same order
+ */
+enum class HltCounter : uint {
+	L1InputEvents,
+	L1SpecialEvents,
+	L1ControlEvents,
+	L1PeriodicsEvents,
+	L1PhysicsEvents,
+	L1PhysicsEventsByMultipleMasks,
+	L1RequestToCreams,
+	L1OutputEvents,
+	L1AcceptedEvents,
+	L1TimeoutEvents,
+	L1AllDisabledEvents,
+	L1BypassEvents,
+	L1FlagAlgoEvents,
+	L1AutoPassEvents,
+	L1CorruptedHeader,
+
+	L2InputEvents,
+	L2SpecialEvents,
+	L2ControlEvents,
+	L2PeriodicsEvents,
+	L2PhysicsEvents,
+	L2PhysicsEventsByMultipleMasks,
+	L2OutputEvents,
+	L2AcceptedEvents,
+	L2TimeoutEvents,
+	L2AllDisabledEvents,
+	L2BypassEvents,
+	L2FlagAlgoEvents,
+	L2AutoPassEvents,
+
+	EventsToMerger,
+	BytesToMerger,
+
+	NUMBER_OF_COUNTERS
+};
+const uint NUMBER_OF_HLT_COUNTERS = (uint) HltCounter::NUMBER_OF_COUNTERS;
+
+/*
+ * Counters with one entry per L0 trigger mask
+ */
+enum class HltDimensionalCounter : uint {
+	L1InputEventsPerMask,
+	L1AcceptedEventsPerMask,
+	L2InputEventsPerMask,
+	L2AcceptedEventsPerMask,
+
+	NUMBER_OF_COUNTERS
+};
+const uint NUMBER_OF_HLT_DIMENSIONAL_COUNTERS = (uint) HltDimensionalCounter::NUMBER_OF_COUNTERS;
+
+#define HLT_NUMBER_OF_MASKS 16
+
+/*
+ * Values of all counters of one burst
+ */
+struct HltBurstSnapshot {
+	uint_fast32_t burstID;
+	uint64_t counters[NUMBER_OF_HLT_COUNTERS];
+	uint64_t dimensionalCounters[NUMBER_OF_HLT_DIMENSIONAL_COUNTERS][HLT_NUMBER_OF_MASKS];
+	uint64_t l1Triggers[0xFF + 1];
+	uint64_t l2Triggers[0xFF + 1];
+
+	uint64_t getCounter(const HltCounter counter) const {
+		return counters[(uint) counter];
+	}
+
+	uint64_t getDimensionalCounter(const HltDimensionalCounter counter, const uint mask) const {
+		return dimensionalCounters[(uint) counter][mask];
+	}
+};
+
+/*
+ * The enum counters and trigger words exist in NA62_BURST_BANKS banks. Events are counted in the bank of
+ * their own burst ID, so the tail of the previous burst never mixes with the next one. When the
+ * BurstIdHandler finishes a burst, sealBurst publishes the bank as an immutable snapshot used for the EOB
+ * and recycles the bank of the next burst, which has been sealed one burst earlier.
+ */
 class HltStatistics {
 public:
 	HltStatistics();
@@ -27,108 +118,160 @@ public:
 
 	//TODO remove
 	static inline std::atomic<uint64_t>* getL1TriggerStats() {
-		return L1Triggers_;
+		return L1Triggers_[BurstIdHandler::getBank(BurstIdHandler::getCurrentBurstId())];
 	}
 	static inline std::atomic<uint64_t>* sumL1TriggerStats(int amount, uint_fast8_t l1Trigger) {
-		L1Triggers_[l1Trigger].fetch_add(amount, std::memory_order_relaxed);
-		return L1Triggers_;
+		return sumL1TriggerStats(amount, l1Trigger, BurstIdHandler::getCurrentBurstId());
+	}
+	static inline std::atomic<uint64_t>* sumL1TriggerStats(int amount, uint_fast8_t l1Trigger,
+			const uint_fast32_t burstID) {
+		std::atomic<uint64_t>* triggers = L1Triggers_[BurstIdHandler::getBank(burstID)];
+		triggers[l1Trigger].fetch_add(amount, std::memory_order_relaxed);
+		return triggers;
 	}
 
 	//TODO remove
 	static inline std::atomic<uint64_t>* getL2TriggerStats() {
-		return L2Triggers_;
+		return L2Triggers_[BurstIdHandler::getBank(BurstIdHandler::getCurrentBurstId())];
 	}
 	static inline std::atomic<uint64_t>* sumL2TriggerStats(int amount, uint_fast8_t l2Trigger) {
-		L2Triggers_[l2Trigger].fetch_add(amount, std::memory_order_relaxed);
-		return L2Triggers_;
-	}
-
-	//Functions to manipulate the maps
-	static inline uint64_t sumCounter(std::string key, uint amount) {
-		return counters_[key].fetch_add(amount, std::memory_order_relaxed);
+		return sumL2TriggerStats(amount, l2Trigger, BurstIdHandler::getCurrentBurstId());
 	}
-	static inline uint64_t getCounter(std::string key) {
-		return counters_[key];
+	static inline std::atomic<uint64_t>* sumL2TriggerStats(int amount, uint_fast8_t l2Trigger,
+			const uint_fast32_t burstID) {
+		std::atomic<uint64_t>* triggers = L2Triggers_[BurstIdHandler::getBank(burstID)];
+		triggers[l2Trigger].fetch_add(amount, std::memory_order_relaxed);
+		return triggers;
 	}
 
-	//Functions to manipulate the maps for multidimensional counter
-	static inline uint64_t sumDimensionalCounter(std::string key, uint array_index, uint amount) {
-		return dimensionalCounters_[key][array_index].fetch_add(amount, std::memory_order_relaxed);
+	/*
+	 * Fast path: no lookup, only the cache line of the calling thread is written.
+	 * Without burst ID the counters of the current burst are used
+	 */
+	static inline void sumCounter(const HltCounter counter, const uint64_t amount,
+			const uint_fast32_t burstID) {
+		shardedCounters_[BurstIdHandler::getBank(burstID)].add((uint) counter, amount);
 	}
-	static inline uint64_t getDimensionalCounter(std::string key, uint array_index) {
-		return dimensionalCounters_[key][array_index];
+	static inline void sumCounter(const HltCounter counter, const uint64_t amount) {
+		sumCounter(counter, amount, BurstIdHandler::getCurrentBurstId());
 	}
-
-	//Counters reset at EOB timestamp
-	static void resetCounters() {
-		for (auto& key : extractKeys()) {
-			counters_[key] = 0;
-		}
-		for (auto& key : extractDimensionalKeys()) {
-			for (uint index = 0; index < 16; index++) {
-				dimensionalCounters_[key][index] = 0;
-			}
-		}
-		for (int i = 0; i != 0xFF + 1; i++) {
-			L1Triggers_[i] = 0;
-			L2Triggers_[i] = 0;
-		}
+	static inline uint64_t getCounter(const HltCounter counter) {
+		return shardedCounters_[BurstIdHandler::getBank(BurstIdHandler::getCurrentBurstId())].get((uint) counter);
 	}
 
-	//TODO: this method is the same as getCounter - must be eliminated if not needed
-	static uint64_t getRollingCounter(std::string key) {
-		return counters_[key];
+	static inline void sumDimensionalCounter(const HltDimensionalCounter counter,
+			const uint array_index, const uint amount, const uint_fast32_t burstID) {
+		shardedDimensionalCounters_[BurstIdHandler::getBank(burstID)].add(
+				(uint) counter * HLT_NUMBER_OF_MASKS + array_index, amount);
 	}
-
-	static std::string serializeDimensionalCounter(std::string key) {
-		std::stringstream serializedConters;
-		for (uint index = 0; index < 16; index++) {
-			if (dimensionalCounters_[key][index] > 0) { //Zero suppression
-				serializedConters << index << ":" << dimensionalCounters_[key][index] << ";";
-			}
-		}
-		return serializedConters.str();
+	static inline void sumDimensionalCounter(const HltDimensionalCounter counter,
+			const uint array_index, const uint amount) {
+		sumDimensionalCounter(counter, array_index, amount, BurstIdHandler::getCurrentBurstId());
+	}
+	static inline uint64_t getDimensionalCounter(const HltDimensionalCounter counter,
+			const uint array_index) {
+		return shardedDimensionalCounters_[BurstIdHandler::getBank(BurstIdHandler::getCurrentBurstId())].get(
+				(uint) counter * HLT_NUMBER_OF_MASKS + array_index);
 	}
 
-	static void printCounter() {
-		for (auto const& counter : counters_) {
-			std::cout << counter.first << " => " << counter.second << '\n';
-		}
+	static inline const char* getCounterName(const HltCounter counter) {
+		return counterNames_[(uint) counter];
 	}
-	static void printDimensionalCounter() {
-		for (auto const& counter : dimensionalCounters_) {
-			for (uint i = 0; i < 16; i++)
-				std::cout << counter.first << " => " << counter.second[i] << '\n';
-		}
+	static inline const char* getDimensionalCounterName(const HltDimensionalCounter counter) {
+		return dimensionalCounterNames_[(uint) counter];
 	}
 
-	static std::vector<std::string> extractKeys() {
-		std::vector<std::string> keys;
-		for (auto const& counter : counters_) {
-			keys.push_back(counter.first);
-		}
-		return keys;
+	/*
+	 * String based interface kept for compatibility. Known names are mapped onto the registry above with a
+	 * hash map built once from the counter names, unknown names are stored in a separate mutex protected map.
+	 * Use the enum versions on the event path!
+	 *
+	 * The return value is the value before adding <amount>. For the registry counters it is read in the same
+	 * step as the addition to the shard of the calling thread, see ShardedCounters::fetchAdd
+	 */
+	static uint64_t sumCounter(const std::string& key, uint amount);
+	static uint64_t getCounter(const std::string& key);
+	static uint64_t sumDimensionalCounter(const std::string& key, uint array_index, uint amount);
+	static uint64_t getDimensionalCounter(const std::string& key, uint array_index);
+
+	/*
+	 * Formerly called at every EOB timestamp. The banks are now reset at start of run by initialize and
+	 * recycled by sealBurst at the end of a burst, so this does nothing: clearing here would wipe the burst
+	 * that is about to be sealed
+	 */
+	static void resetCounters();
+
+	/*
+	 * Called by the BurstIdHandler after the cleanup of <burstID>: publishes its counters as sealed snapshot
+	 * and clears the bank to be used by <nextBurstID>
+	 */
+	static void sealBurst(const uint_fast32_t burstID, const uint_fast32_t nextBurstID);
+
+	/*
+	 * Snapshot of the last sealed burst or nullptr if no burst has been sealed yet
+	 */
+	static std::shared_ptr<const HltBurstSnapshot> getSealedSnapshot() {
+		return std::atomic_load(&sealedSnapshot_);
 	}
 
-	static std::vector<std::string> extractDimensionalKeys() {
-		std::vector<std::string> keys;
-		for (auto const& counter : dimensionalCounters_) {
-			keys.push_back(counter.first);
-		}
-		return keys;
+	/*
+	 * The sealed snapshot if it belongs to <burstID>, otherwise a copy of the current values of its bank
+	 */
+	static std::shared_ptr<const HltBurstSnapshot> getBurstSnapshot(const uint_fast32_t burstID);
+
+	/*
+	 * The sealed snapshot as JSON object
+	 */
+	static std::string toJson();
+
+	//TODO: this method is the same as getCounter - must be eliminated if not needed
+	static uint64_t getRollingCounter(const std::string& key) {
+		return getCounter(key);
 	}
 
+	static std::string serializeDimensionalCounter(const std::string& key);
+
+	static void printCounter();
+	static void printDimensionalCounter();
+
+	static std::vector<std::string> extractKeys();
+	static std::vector<std::string> extractDimensionalKeys();
+
 	static std::string fillL1Eob();
 	static std::string fillL2Eob();
 
 private:
+	/*
+	 * Returns the index of the counter with the given name or -1
+	 */
+	static int findCounter(const std::string& key);
+	static int findDimensionalCounter(const std::string& key);
+	static std::unordered_map<std::string, int> indexNames(const char* const * names, const uint numberOfNames);
+
+	static std::shared_ptr<HltBurstSnapshot> takeSnapshot(const uint_fast32_t burstID);
+	static void resetBank(const uint bank);
+	static void resetBanks();
+	static void resetOtherCounters();
+
 	static int logicalID_;
-	static std::atomic<uint64_t>* L1Triggers_;
-	static std::atomic<uint64_t>* L2Triggers_;
+	static std::atomic<uint64_t> L1Triggers_[NA62_BURST_BANKS][0xFF + 1];
+	static std::atomic<uint64_t> L2Triggers_[NA62_BURST_BANKS][0xFF + 1];
+
+	static const char* counterNames_[NUMBER_OF_HLT_COUNTERS];
+	static const char* dimensionalCounterNames_[NUMBER_OF_HLT_DIMENSIONAL_COUNTERS];
+	static const std::unordered_map<std::string, int> counterIndices_;
+	static const std::unordered_map<std::string, int> dimensionalCounterIndices_;
+
+	//Counters continuously updated by the farm, one bank per burst parity
+	static ShardedCounters<NUMBER_OF_HLT_COUNTERS> shardedCounters_[NA62_BURST_BANKS];
+	static ShardedCounters<NUMBER_OF_HLT_DIMENSIONAL_COUNTERS * HLT_NUMBER_OF_MASKS> shardedDimensionalCounters_[NA62_BURST_BANKS];
+
+	static std::shared_ptr<const HltBurstSnapshot> sealedSnapshot_;
 
-	//Map containing counters continuously updated by the farm
-	static std::map<std::string, std::atomic<uint64_t>> counters_;
-	static std::map<std::string, std::array<std::atomic<uint64_t>, 16>> dimensionalCounters_;
+	//Counters not known at compile time, only accessed via the string interface. Not banked, reset by sealBurst
+	static std::mutex otherCountersMutex_;
+	static std::map<std::string, std::atomic<uint64_t>> otherCounters_;
+	static std::map<std::string, std::array<std::atomic<uint64_t>, HLT_NUMBER_OF_MASKS>> otherDimensionalCounters_;
 
 	static l1EOBInfo l1EobStruct_;
 	static l2EOBInfo l2EobStruct_;
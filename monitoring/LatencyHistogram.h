@@ -0,0 +1,146 @@
+/*
+ * LatencyHistogram.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: NA62 collaboration
+ */
+
+#pragma once
+#ifndef LATENCYHISTOGRAM_H_
+#define LATENCYHISTOGRAM_H_
+
+#include <sys/types.h>
+#include <atomic>
+#include <cstdint>
+
+#include "../utils/ThreadShard.h"
+
+namespace na62 {
+
+/*
+ * Log-linear histogram of 32 bit values (HDR histogram style): every power of two is split into
+ * LATENCY_SUB_BUCKETS linear sub buckets. Values below LATENCY_SUB_BUCKETS are exact, above that the
+ * relative error is at most 1/LATENCY_SUB_BUCKETS.
+ *
+ * Recording is one relaxed fetch_add on the thread shard of the caller. Reading (percentiles)
+ * sums up all shards and should only be done by the monitoring.
+ *
+ * Objects must have static storage duration (see ShardedCounters).
+ */
+#define LATENCY_SUB_BUCKET_BITS 3
+#define LATENCY_SUB_BUCKETS (1 << LATENCY_SUB_BUCKET_BITS)
+#define LATENCY_HISTOGRAM_BUCKETS ((32 - LATENCY_SUB_BUCKET_BITS + 1) * LATENCY_SUB_BUCKETS)
+
+class LatencyHistogram {
+public:
+	static inline uint bucketIndex(const uint32_t value) {
+		if (value < LATENCY_SUB_BUCKETS) {
+			return value;
+		}
+		const uint exponent = 31 - __builtin_clz(value); // >= LATENCY_SUB_BUCKET_BITS
+		const uint shift = exponent - LATENCY_SUB_BUCKET_BITS;
+		return (shift + 1) * LATENCY_SUB_BUCKETS
+				+ ((value >> shift) & (LATENCY_SUB_BUCKETS - 1));
+	}
+
+	/*
+	 * Smallest value stored in the given bucket
+	 */
+	static inline uint32_t bucketLowerBound(const uint index) {
+		if (index < LATENCY_SUB_BUCKETS) {
+			return index;
+		}
+		const uint shift = index / LATENCY_SUB_BUCKETS - 1;
+		return (uint32_t) (LATENCY_SUB_BUCKETS + index % LATENCY_SUB_BUCKETS) << shift;
+	}
+
+	inline void record(const uint32_t value) {
+		buckets_.add(bucketIndex(value), 1);
+		sum_.add(0, value);
+
+		uint32_t max = max_.load(std::memory_order_relaxed);
+		while (value > max
+				&& !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+		}
+	}
+
+	uint64_t getBucketCount(const uint index) const {
+		return buckets_.get(index);
+	}
+
+	uint64_t getCount() const {
+		uint64_t count = 0;
+		for (uint i = 0; i != LATENCY_HISTOGRAM_BUCKETS; i++) {
+			count += buckets_.get(i);
+		}
+		return count;
+	}
+
+	uint64_t getSum() const {
+		return sum_.get(0);
+	}
+
+	uint32_t getMax() const {
+		return max_.load(std::memory_order_relaxed);
+	}
+
+	/*
+	 * Copies the bucket counts into <counts> of LATENCY_HISTOGRAM_BUCKETS entries and returns their sum
+	 */
+	uint64_t copyBuckets(uint64_t* counts) const {
+		uint64_t total = 0;
+		for (uint i = 0; i != LATENCY_HISTOGRAM_BUCKETS; i++) {
+			counts[i] = buckets_.get(i);
+			total += counts[i];
+		}
+		return total;
+	}
+
+	/*
+	 * Returns the lower bound of the bucket containing the given quantile (0 < quantile <= 1)
+	 * or 0 if nothing has been recorded
+	 */
+	uint32_t getPercentile(const double quantile) const {
+		uint64_t counts[LATENCY_HISTOGRAM_BUCKETS];
+		const uint64_t total = copyBuckets(counts);
+		return getPercentile(counts, total, getMax(), quantile);
+	}
+
+	/*
+	 * Same as above for bucket counts copied with copyBuckets
+	 */
+	static uint32_t getPercentile(const uint64_t* counts, const uint64_t total, const uint32_t max,
+			const double quantile) {
+		if (total == 0) {
+			return 0;
+		}
+
+		uint64_t rank = quantile * total + 0.5;
+		if (rank == 0) {
+			rank = 1;
+		}
+		uint64_t seen = 0;
+		for (uint i = 0; i != LATENCY_HISTOGRAM_BUCKETS; i++) {
+			seen += counts[i];
+			if (seen >= rank) {
+				return bucketLowerBound(i);
+			}
+		}
+		return max;
+	}
+
+	void reset() {
+		buckets_.reset();
+		sum_.reset();
+		max_.store(0, std::memory_order_relaxed);
+	}
+
+private:
+	ShardedCounters<LATENCY_HISTOGRAM_BUCKETS> buckets_;
+	ShardedCounters<1> sum_;
+	std::atomic<uint32_t> max_;
+};
+
+} /* namespace na62 */
+
+#endif /* LATENCYHISTOGRAM_H_ */
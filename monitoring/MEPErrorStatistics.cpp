@@ -0,0 +1,151 @@
+/*
+ * MEPErrorStatistics.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: NA62 collaboration
+ */
+
+#include "MEPErrorStatistics.h"
+
+#include <chrono>
+#include <sstream>
+
+#include "../options/Logging.h"
+
+namespace na62 {
+
+std::atomic<uint64_t> MEPErrorStatistics::errors_[NUMBER_OF_LEVELS][(uint_fast8_t) MEPParseStatus::NUMBER_OF_STATUS_CODES][NO_SOURCE_ID
+		+ 1];
+std::atomic<uint64_t> MEPErrorStatistics::lastLogTime_[NUMBER_OF_LEVELS][(uint_fast8_t) MEPParseStatus::NUMBER_OF_STATUS_CODES];
+std::atomic<uint64_t> MEPErrorStatistics::suppressedLogs_[NUMBER_OF_LEVELS][(uint_fast8_t) MEPParseStatus::NUMBER_OF_STATUS_CODES];
+std::atomic<uint> MEPErrorStatistics::logIntervalMillis_(1000);
+
+static const char* levelName(const MEPErrorStatistics::Level level) {
+	return level == MEPErrorStatistics::L0 ? "L0" : "L1";
+}
+
+uint64_t MEPErrorStatistics::getErrors(const Level level,
+		const MEPParseStatus status) {
+	uint64_t sum = 0;
+	for (uint_fast16_t sourceID = 0; sourceID <= NO_SOURCE_ID; sourceID++) {
+		sum += getErrors(level, status, sourceID);
+	}
+	return sum;
+}
+
+uint64_t MEPErrorStatistics::getTotalErrors(const Level level) {
+	uint64_t sum = 0;
+	for (uint_fast8_t status = 1;
+			status != (uint_fast8_t) MEPParseStatus::NUMBER_OF_STATUS_CODES;
+			status++) {
+		sum += getErrors(level, (MEPParseStatus) status);
+	}
+	return sum;
+}
+
+void MEPErrorStatistics::resetCounters() {
+	for (uint_fast8_t level = 0; level != NUMBER_OF_LEVELS; level++) {
+		for (uint_fast8_t status = 0;
+				status != (uint_fast8_t) MEPParseStatus::NUMBER_OF_STATUS_CODES;
+				status++) {
+			for (uint_fast16_t sourceID = 0; sourceID <= NO_SOURCE_ID;
+					sourceID++) {
+				errors_[level][status][sourceID].store(0,
+						std::memory_order_relaxed);
+			}
+		}
+	}
+}
+
+bool MEPErrorStatistics::tryAcquireLogSlot(const Level level,
+		const MEPParseStatus status) {
+	const uint64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	std::atomic<uint64_t>& lastLogTime = lastLogTime_[level][(uint_fast8_t) status];
+
+	uint64_t last = lastLogTime.load(std::memory_order_relaxed);
+	if (last != 0 && now - last < logIntervalMillis_.load(std::memory_order_relaxed)) {
+		suppressedLogs_[level][(uint_fast8_t) status].fetch_add(1,
+				std::memory_order_relaxed);
+		return false;
+	}
+
+	/*
+	 * Only one thread may win the slot of this interval
+	 */
+	if (!lastLogTime.compare_exchange_strong(last, now)) {
+		suppressedLogs_[level][(uint_fast8_t) status].fetch_add(1,
+				std::memory_order_relaxed);
+		return false;
+	}
+	return true;
+}
+
+void MEPErrorStatistics::logFailure(const Level level,
+		const MEPParseStatus status, const uint_fast16_t sourceID,
+		const uint_fast16_t dataLength) {
+	const uint64_t suppressed = suppressedLogs_[level][(uint_fast8_t) status].exchange(
+			0, std::memory_order_relaxed);
+
+	std::ostringstream s;
+	s << "BadEv : " << levelName(level) << " "
+			<< mepParseStatusToString(status) << " from source ";
+	if (sourceID == NO_SOURCE_ID) {
+		s << "<unknown>";
+	} else {
+		s << "0x" << std::hex << sourceID << std::dec;
+	}
+	s << " (" << dataLength << " bytes)";
+	if (suppressed != 0) {
+		s << ". " << suppressed << " similar messages suppressed";
+	}
+	LOG_ERROR(s.str());
+}
+
+std::string MEPErrorStatistics::toJson() {
+	std::stringstream stream;
+	stream << "{";
+	for (uint_fast8_t level = 0; level != NUMBER_OF_LEVELS; level++) {
+		if (level != 0) {
+			stream << ",";
+		}
+		stream << "\"" << levelName((Level) level) << "\":{";
+
+		bool firstStatus = true;
+		for (uint_fast8_t status = 1;
+				status != (uint_fast8_t) MEPParseStatus::NUMBER_OF_STATUS_CODES;
+				status++) {
+			bool firstSource = true;
+			for (uint_fast16_t sourceID = 0; sourceID <= NO_SOURCE_ID;
+					sourceID++) {
+				const uint64_t errors = errors_[level][status][sourceID].load(
+						std::memory_order_relaxed);
+				if (errors == 0) {
+					continue;
+				}
+				if (firstSource) {
+					stream << (firstStatus ? "" : ",") << "\""
+							<< mepParseStatusName((MEPParseStatus) status)
+							<< "\":{";
+					firstStatus = false;
+					firstSource = false;
+				} else {
+					stream << ",";
+				}
+				if (sourceID == NO_SOURCE_ID) {
+					stream << "\"none\":" << errors;
+				} else {
+					stream << "\"" << sourceID << "\":" << errors;
+				}
+			}
+			if (!firstSource) {
+				stream << "}";
+			}
+		}
+		stream << "}";
+	}
+	stream << "}";
+	return stream.str();
+}
+
+} /* namespace na62 */
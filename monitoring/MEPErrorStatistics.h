@@ -0,0 +1,104 @@
+/*
+ * MEPErrorStatistics.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: NA62 collaboration
+ */
+
+#pragma once
+#ifndef MEPERRORSTATISTICS_H_
+#define MEPERRORSTATISTICS_H_
+
+#include <sys/types.h>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "../structs/MEPParseStatus.h"
+
+namespace na62 {
+
+/*
+ * Counts every MEP rejected by l0::MEP::tryParse or l1::MEP::tryParse per failure reason and
+ * per sourceID. Counting is a single relaxed fetch_add so that a detector sending garbage at
+ * high rate does not slow down the receiver threads.
+ *
+ * A human readable message is only built for the first failure of each reason within
+ * logIntervalMillis_. All failures in between are only counted and the number of suppressed
+ * messages is printed together with the next message.
+ */
+class MEPErrorStatistics {
+public:
+	enum Level {
+		L0 = 0, L1 = 1, NUMBER_OF_LEVELS
+	};
+
+	/*
+	 * Index used for packets too short to contain a sourceID
+	 */
+	static const uint_fast16_t NO_SOURCE_ID = 0x100;
+
+	/*
+	 * Counts the failure and writes a rate limited log message
+	 */
+	static void report(const Level level, const MEPParseStatus status,
+			const uint_fast16_t sourceID, const uint_fast16_t dataLength) {
+		count(level, status, sourceID);
+		if (tryAcquireLogSlot(level, status)) {
+			logFailure(level, status, sourceID, dataLength);
+		}
+	}
+
+	/*
+	 * Only counts the failure. Used by the throwing constructors where the caller reports the exception
+	 */
+	static inline void count(const Level level, const MEPParseStatus status,
+			const uint_fast16_t sourceID) {
+		errors_[level][(uint_fast8_t) status][sourceID].fetch_add(1,
+				std::memory_order_relaxed);
+	}
+
+	static inline uint64_t getErrors(const Level level,
+			const MEPParseStatus status, const uint_fast16_t sourceID) {
+		return errors_[level][(uint_fast8_t) status][sourceID].load(
+				std::memory_order_relaxed);
+	}
+
+	/*
+	 * Sum over all sourceIDs
+	 */
+	static uint64_t getErrors(const Level level, const MEPParseStatus status);
+
+	/*
+	 * Sum over all sourceIDs and failure reasons
+	 */
+	static uint64_t getTotalErrors(const Level level);
+
+	static void setLogInterval(const uint milliseconds) {
+		logIntervalMillis_ = milliseconds;
+	}
+
+	static void resetCounters();
+
+	/*
+	 * {"L0":{"<reason>":{"<sourceID>":count,...},...},"L1":{...}}
+	 * Only non-zero counters are written, packets without sourceID are stored with key "none"
+	 */
+	static std::string toJson();
+
+private:
+	static bool tryAcquireLogSlot(const Level level, const MEPParseStatus status);
+	static void logFailure(const Level level, const MEPParseStatus status,
+			const uint_fast16_t sourceID, const uint_fast16_t dataLength);
+
+	static std::atomic<uint64_t> errors_[NUMBER_OF_LEVELS][(uint_fast8_t) MEPParseStatus::NUMBER_OF_STATUS_CODES][NO_SOURCE_ID
+			+ 1];
+
+	static std::atomic<uint64_t> lastLogTime_[NUMBER_OF_LEVELS][(uint_fast8_t) MEPParseStatus::NUMBER_OF_STATUS_CODES];
+	static std::atomic<uint64_t> suppressedLogs_[NUMBER_OF_LEVELS][(uint_fast8_t) MEPParseStatus::NUMBER_OF_STATUS_CODES];
+	static std::atomic<uint> logIntervalMillis_;
+};
+
+} /* namespace na62 */
+
+#endif /* MEPERRORSTATISTICS_H_ */
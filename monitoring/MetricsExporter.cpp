@@ -0,0 +1,427 @@
+/*
+ * MetricsExporter.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: NA62 collaboration
+ */
+
+#include "MetricsExporter.h"
+
+#include <unistd.h>
+#include <boost/asio.hpp>
+#include <istream>
+#include <thread>
+
+#include "../eventBuilding/Event.h"
+#include "../eventBuilding/SourceIDManager.h"
+#include "../eventBuilding/UnfinishedEventsCollector.h"
+#include "../options/AsyncLogger.h"
+#include "../options/Logging.h"
+#include "../SharedMemory/SharedMemoryManager.h"
+#include "../structs/DataContainer.h"
+#include "../utils/PacketBufferPool.h"
+#include "BurstIdHandler.h"
+#include "DetectorStatistics.h"
+#include "EventLatencyStatistics.h"
+#include "HltStatistics.h"
+#include "MEPErrorStatistics.h"
+#include "Tracer.h"
+
+namespace na62 {
+
+using boost::asio::ip::tcp;
+
+std::mutex MetricsExporter::collectorsMutex_;
+std::vector<MetricsExporter::Collector> MetricsExporter::collectors_;
+std::shared_ptr<const std::string> MetricsExporter::snapshot_ = std::make_shared<
+		const std::string>("# EOF\n");
+
+namespace {
+
+/*
+ * One HTTP/1.0 request: read the header, answer with the last snapshot and close
+ */
+class MetricsSession: public std::enable_shared_from_this<MetricsSession> {
+public:
+	MetricsSession(boost::asio::io_service& ioService) :
+			socket_(ioService), request_(8192) {
+	}
+
+	tcp::socket& socket() {
+		return socket_;
+	}
+
+	void start() {
+		auto self = shared_from_this();
+		boost::asio::async_read_until(socket_, request_, "\r\n\r\n",
+				[self](const boost::system::error_code& error, std::size_t) {
+					if (!error) {
+						self->respond();
+					}
+				});
+	}
+
+private:
+	void respond() {
+		std::istream request(&request_);
+		std::string method, path;
+		request >> method >> path;
+
+		std::ostringstream response;
+		if (method == "GET" && (path == "/metrics" || path == "/")) {
+			std::shared_ptr<const std::string> page = MetricsExporter::getSnapshot();
+			response << "HTTP/1.0 200 OK\r\n"
+					<< "Content-Type: application/openmetrics-text; version=1.0.0; charset=utf-8\r\n"
+					<< "Content-Length: " << page->size() << "\r\n"
+					<< "Connection: close\r\n\r\n" << *page;
+		} else {
+			response << "HTTP/1.0 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+		}
+		response_ = response.str();
+
+		auto self = shared_from_this();
+		boost::asio::async_write(socket_, boost::asio::buffer(response_),
+				[self](const boost::system::error_code&, std::size_t) {
+					boost::system::error_code ignored;
+					self->socket_.shutdown(tcp::socket::shutdown_both, ignored);
+					self->socket_.close(ignored);
+				});
+	}
+
+	tcp::socket socket_;
+	boost::asio::streambuf request_;
+	std::string response_;
+};
+
+void startAccept(boost::asio::io_service& ioService, tcp::acceptor& acceptor) {
+	auto session = std::make_shared<MetricsSession>(ioService);
+	acceptor.async_accept(session->socket(),
+			[session, &ioService, &acceptor](const boost::system::error_code& error) {
+				if (!error) {
+					session->start();
+				}
+				if (acceptor.is_open()) {
+					startAccept(ioService, acceptor);
+				}
+			});
+}
+
+void collectHltStatistics(MetricsWriter& writer) {
+	const std::string burst = std::to_string(BurstIdHandler::getCurrentBurstId());
+
+	writer.family("na62_burst_id", "gauge", "Current burst ID");
+	writer.sample("na62_burst_id", { }, (uint64_t) BurstIdHandler::getCurrentBurstId());
+
+	writer.family("na62_hlt_counter", "gauge", "HLT counters of the current burst");
+	for (uint counter = 0; counter != NUMBER_OF_HLT_COUNTERS; counter++) {
+		writer.sample("na62_hlt_counter",
+				{ { "name", HltStatistics::getCounterName((HltCounter) counter) }, { "burst", burst } },
+				HltStatistics::getCounter((HltCounter) counter));
+	}
+
+	writer.family("na62_hlt_mask_counter", "gauge", "HLT counters per L0 trigger mask of the current burst");
+	for (uint counter = 0; counter != NUMBER_OF_HLT_DIMENSIONAL_COUNTERS; counter++) {
+		for (uint mask = 0; mask != HLT_NUMBER_OF_MASKS; mask++) {
+			writer.sample("na62_hlt_mask_counter",
+					{ { "name", HltStatistics::getDimensionalCounterName((HltDimensionalCounter) counter) }, {
+							"mask", std::to_string(mask) }, { "burst", burst } },
+					HltStatistics::getDimensionalCounter((HltDimensionalCounter) counter, mask));
+		}
+	}
+
+	writer.family("na62_hlt_trigger_words", "gauge", "Events per L1/L2 trigger word of the current burst");
+	for (uint word = 0; word != 0xFF + 1; word++) {
+		const uint64_t l1 = HltStatistics::getL1TriggerStats()[word];
+		const uint64_t l2 = HltStatistics::getL2TriggerStats()[word];
+		if (l1 != 0) {
+			writer.sample("na62_hlt_trigger_words",
+					{ { "level", "L1" }, { "trigger", MetricsWriter::hex(word) }, { "burst", burst } }, l1);
+		}
+		if (l2 != 0) {
+			writer.sample("na62_hlt_trigger_words",
+					{ { "level", "L2" }, { "trigger", MetricsWriter::hex(word) }, { "burst", burst } }, l2);
+		}
+	}
+}
+
+void collectEventStatistics(MetricsWriter& writer) {
+	writer.family("na62_event_missing_fragments", "gauge", "Events with missing fragments per source");
+	for (uint sourceNum = 0; sourceNum != SourceIDManager::NUMBER_OF_L0_DATA_SOURCES; sourceNum++) {
+		const uint sourceID = SourceIDManager::sourceNumToID(sourceNum);
+		writer.sample("na62_event_missing_fragments",
+				{ { "level", "L0" }, { "sourceID", MetricsWriter::hex(sourceID) }, { "detector",
+						SourceIDManager::sourceIdToDetectorName(sourceID) } },
+				(uint64_t) Event::getMissingL0EventsBySourceNum(sourceNum));
+	}
+	for (uint sourceNum = 0; sourceNum != SourceIDManager::NUMBER_OF_L1_DATA_SOURCES; sourceNum++) {
+		const uint sourceID = SourceIDManager::l1SourceNumToID(sourceNum);
+		writer.sample("na62_event_missing_fragments",
+				{ { "level", "L1" }, { "sourceID", MetricsWriter::hex(sourceID) }, { "detector",
+						SourceIDManager::sourceIdToDetectorName(sourceID) } },
+				(uint64_t) Event::getMissingL1EventsBySourceNum(sourceNum));
+	}
+
+	writer.family("na62_event_non_requested_l1_fragments", "counter", "L1 fragments received without request");
+	writer.sample("na62_event_non_requested_l1_fragments_total", { }, Event::getNumberOfNonRequestedL1Fragments());
+
+	writer.family("na62_unfinished_event_fragments", "gauge",
+			"Fragments received for events that were never completed in the last finished burst");
+	const std::string sealedBurst = std::to_string(UnfinishedEventsCollector::getSealedBurstID());
+	UnfinishedEventsCollector::forEach([&writer, &sealedBurst](uint sourceNum, uint subSourceID, uint events) {
+		writer.sample("na62_unfinished_event_fragments",
+				{ {"sourceID", MetricsWriter::hex(SourceIDManager::sourceNumToID(sourceNum))}, {"subID", std::to_string(subSourceID)}, {"burst", sealedBurst}},
+				(uint64_t) events);
+	});
+}
+
+void collectDetectorStatistics(MetricsWriter& writer) {
+	std::shared_ptr<const DetectorStatisticsSnapshot> snapshot = DetectorStatistics::getSealedSnapshot();
+	if (snapshot) {
+		const std::string burst = std::to_string(snapshot->burstID);
+		writer.family("na62_detector_fragments", "gauge", "Fragments received per source and subID in the last finished burst");
+		for (int index = 0; index < DetectorStatistics::getMaxL0Index(); index++) {
+			for (int subID = 0; subID != 32; subID++) {
+				const uint64_t received = snapshot->L0receivedSourceIdsSubIds[index * 32 + subID];
+				if (received != 0) {
+					writer.sample("na62_detector_fragments",
+							{ { "level", "L0" }, { "sourceID", MetricsWriter::hex(index * 4) }, { "subID",
+									std::to_string(subID) }, { "burst", burst } }, received);
+				}
+			}
+		}
+		for (int crate = 0; crate < DetectorStatistics::getMaxL1Index(); crate++) {
+			for (int slot = 0; slot != 21; slot++) {
+				const uint64_t received = snapshot->L1receivedSourceIdsSubIds[crate * 21 + slot];
+				if (received != 0) {
+					writer.sample("na62_detector_fragments",
+							{ { "level", "L1" }, { "crate", std::to_string(crate) }, { "slot", std::to_string(
+									slot) }, { "burst", burst } }, received);
+				}
+			}
+		}
+	}
+
+	writer.family("na62_mep_errors", "counter", "Rejected MEPs per failure reason and source");
+	for (uint level = 0; level != MEPErrorStatistics::NUMBER_OF_LEVELS; level++) {
+		for (uint status = 1; status != (uint) MEPParseStatus::NUMBER_OF_STATUS_CODES; status++) {
+			for (uint sourceID = 0; sourceID <= MEPErrorStatistics::NO_SOURCE_ID; sourceID++) {
+				const uint64_t errors = MEPErrorStatistics::getErrors((MEPErrorStatistics::Level) level,
+						(MEPParseStatus) status, sourceID);
+				if (errors != 0) {
+					writer.sample("na62_mep_errors_total",
+							{ { "level", level == MEPErrorStatistics::L0 ? "L0" : "L1" }, { "reason",
+									mepParseStatusName((MEPParseStatus) status) }, { "sourceID",
+									sourceID == MEPErrorStatistics::NO_SOURCE_ID ? "none" : MetricsWriter::hex(
+											sourceID) } }, errors);
+				}
+			}
+		}
+	}
+
+	writer.family("na62_shm_store_ratio", "gauge", "Fraction of L1 events stored in shared memory");
+	writer.sample("na62_shm_store_ratio", { }, (double) SharedMemoryManager::getStoreRatio());
+
+	writer.family("na62_shm_l2_events", "counter", "Events handed to the L2 processes or dropped by backpressure");
+	writer.sample("na62_shm_l2_events_total", { { "state", "stored" } }, SharedMemoryManager::getL2EventsStored());
+	writer.sample("na62_shm_l2_events_total", { { "state", "dropped_no_slot" } },
+			SharedMemoryManager::getL2EventsDroppedNoSlot());
+	writer.sample("na62_shm_l2_events_total", { { "state", "dropped_queue_full" } },
+			SharedMemoryManager::getL2EventsDroppedQueueFull());
+	writer.sample("na62_shm_l2_events_total", { { "state", "dropped_too_large" } },
+			SharedMemoryManager::getL2EventsDroppedTooLarge());
+
+	writer.family("na62_shm_l2_events_in_flight", "gauge", "Events waiting for an L2 verdict");
+	writer.sample("na62_shm_l2_events_in_flight", { }, (uint64_t) std::max<int64_t>(SharedMemoryManager::getL2EventsInFlight(), 0));
+
+	writer.family("na62_shm_dispatched_events", "counter", "L1 events sent to a trigger consumer sub-queue or to the shared queue");
+	writer.sample("na62_shm_dispatched_events_total", { { "queue", "consumer" } },
+			SharedMemoryManager::getEventsDispatchedToConsumers());
+	writer.sample("na62_shm_dispatched_events_total", { { "queue", "shared" } },
+			SharedMemoryManager::getEventsDispatchedShared());
+
+	if (SharedMemoryManager::hasTriggerConsumers()) {
+		std::vector<std::pair<uint, TriggerConsumerStats>> consumers;
+		for (uint consumer_id = 0; consumer_id != MAX_TRIGGER_CONSUMERS; consumer_id++) {
+			const TriggerConsumerStats stats = SharedMemoryManager::getTriggerConsumerStats(consumer_id);
+			if (stats.registered || stats.completed != 0) {
+				consumers.push_back(std::make_pair(consumer_id, stats));
+			}
+		}
+
+		writer.family("na62_shm_consumer_alive", "gauge", "1 if the trigger consumer sent a heartbeat within the timeout");
+		for (const auto& consumer : consumers) {
+			writer.sample("na62_shm_consumer_alive", { { "consumer", std::to_string(consumer.first) } },
+					(uint64_t) consumer.second.alive);
+		}
+		writer.family("na62_shm_consumer_events", "gauge", "Events queued for or being processed by a trigger consumer");
+		for (const auto& consumer : consumers) {
+			const std::string id = std::to_string(consumer.first);
+			writer.sample("na62_shm_consumer_events", { { "consumer", id }, { "state", "queued" } },
+					(uint64_t) std::max<int64_t>(consumer.second.queued, 0));
+			writer.sample("na62_shm_consumer_events", { { "consumer", id }, { "state", "in_flight" } },
+					(uint64_t) std::max<int64_t>(consumer.second.inFlight, 0));
+		}
+		writer.family("na62_shm_consumer_completed_events", "counter", "Events processed by a trigger consumer");
+		for (const auto& consumer : consumers) {
+			writer.sample("na62_shm_consumer_completed_events_total", { { "consumer", std::to_string(consumer.first) } },
+					consumer.second.completed);
+		}
+		writer.family("na62_shm_consumer_stolen_events", "counter",
+				"Events a trigger consumer took from the sub-queue of another one");
+		for (const auto& consumer : consumers) {
+			writer.sample("na62_shm_consumer_stolen_events_total", { { "consumer", std::to_string(consumer.first) } },
+					consumer.second.stolen);
+		}
+		writer.family("na62_shm_consumer_latency_microseconds", "gauge", "Dispatch to verdict time per trigger consumer");
+		for (const auto& consumer : consumers) {
+			const std::string id = std::to_string(consumer.first);
+			writer.sample("na62_shm_consumer_latency_microseconds", { { "consumer", id }, { "stat", "mean" } },
+					consumer.second.completed == 0 ?
+							0. : (double) consumer.second.latencySumMicros / consumer.second.completed);
+			writer.sample("na62_shm_consumer_latency_microseconds", { { "consumer", id }, { "stat", "max" } },
+					(double) consumer.second.latencyMaxMicros);
+		}
+	}
+}
+
+void collectLatencies(MetricsWriter& writer) {
+	/*
+	 * Export the last sealed burst: the bank of the running burst is still being filled
+	 */
+	std::shared_ptr<const LatencySnapshot> snapshot = EventLatencyStatistics::getSealedSnapshot();
+	if (!snapshot) {
+		return;
+	}
+	const std::string burst = std::to_string(snapshot->burstID);
+
+	writer.family("na62_event_latency_microseconds", "histogram", "Event processing time per stage of the last finished burst");
+	for (uint stage = 0; stage != NUMBER_OF_LATENCY_STAGES; stage++) {
+		const LatencySnapshot::Stage& histogram = snapshot->stages[stage];
+		const std::string stageName = EventLatencyStatistics::getStageName((LatencyStage) stage);
+
+		/*
+		 * The histogram buckets are aligned to powers of two -> export cumulative counts of all values < 2^k
+		 */
+		uint64_t cumulative = 0;
+		uint bucket = 0;
+		for (uint exponent = 0; exponent != 32; exponent++) {
+			const uint64_t boundary = 1ull << exponent;
+			while (bucket != LATENCY_HISTOGRAM_BUCKETS && LatencyHistogram::bucketLowerBound(bucket) < boundary) {
+				cumulative += histogram.buckets[bucket++];
+			}
+			writer.sample("na62_event_latency_microseconds_bucket",
+					{ { "stage", stageName }, { "le", std::to_string(boundary - 1) }, { "burst", burst } }, cumulative);
+		}
+		while (bucket != LATENCY_HISTOGRAM_BUCKETS) {
+			cumulative += histogram.buckets[bucket++];
+		}
+		writer.sample("na62_event_latency_microseconds_bucket",
+				{ { "stage", stageName }, { "le", "+Inf" }, { "burst", burst } }, cumulative);
+		writer.sample("na62_event_latency_microseconds_count", { { "stage", stageName }, { "burst", burst } },
+				cumulative);
+		writer.sample("na62_event_latency_microseconds_sum", { { "stage", stageName }, { "burst", burst } },
+				histogram.sum);
+	}
+}
+
+void collectInstrumentation(MetricsWriter& writer) {
+	writer.family("na62_log_dropped_messages", "counter", "Log messages lost due to full buffers");
+	writer.sample("na62_log_dropped_messages_total", { }, AsyncLogger::getDroppedMessages());
+
+	writer.family("na62_trace_dropped_records", "counter", "Trace records lost due to full buffers");
+	writer.sample("na62_trace_dropped_records_total", { }, Tracer::getDroppedRecords());
+
+	writer.family("na62_packet_checksum_mode", "gauge", "0: off, 1: sampled, 2: full");
+	writer.sample("na62_packet_checksum_mode", { }, (uint64_t) DataContainer::getChecksumMode());
+
+	writer.family("na62_packet_checksums", "counter", "Received packets by checksum handling");
+	writer.sample("na62_packet_checksums_total", { { "state", "computed" } },
+			DataContainer::getChecksumCounter(CHECKSUM_COMPUTED));
+	writer.sample("na62_packet_checksums_total", { { "state", "skipped" } },
+			DataContainer::getChecksumCounter(CHECKSUM_SKIPPED));
+	writer.sample("na62_packet_checksums_total", { { "state", "verified" } },
+			DataContainer::getChecksumCounter(CHECKSUM_VERIFIED));
+	writer.sample("na62_packet_checksums_total", { { "state", "corrupted" } },
+			DataContainer::getChecksumCounter(CHECKSUM_CORRUPTED));
+
+	writer.family("na62_packet_buffer_allocations", "counter", "Receive buffers taken from the pool or from the heap");
+	for (uint bufferClass = 0; bufferClass != NUMBER_OF_PACKET_BUFFER_CLASSES; bufferClass++) {
+		const std::string size = std::to_string(PacketBufferPool::getBufferSize((PacketBufferClass) bufferClass));
+		writer.sample("na62_packet_buffer_allocations_total", { { "size", size }, { "source", "pool" } },
+				PacketBufferPool::getCounter((PacketBufferClass) bufferClass, PACKET_BUFFER_POOL_ALLOCATIONS));
+		writer.sample("na62_packet_buffer_allocations_total", { { "size", size }, { "source", "heap" } },
+				PacketBufferPool::getCounter((PacketBufferClass) bufferClass, PACKET_BUFFER_HEAP_ALLOCATIONS));
+	}
+}
+
+}
+
+MetricsExporter::MetricsExporter(const ushort port, const uint snapshotIntervalMillis) :
+		port_(port), snapshotIntervalMillis_(snapshotIntervalMillis), running_(true) {
+	static std::once_flag defaultCollectorsFlag;
+	std::call_once(defaultCollectorsFlag, &MetricsExporter::registerDefaultCollectors);
+}
+
+MetricsExporter::~MetricsExporter() {
+}
+
+void MetricsExporter::registerCollector(const Collector& collector) {
+	std::lock_guard<std::mutex> lock(collectorsMutex_);
+	collectors_.push_back(collector);
+}
+
+void MetricsExporter::registerDefaultCollectors() {
+	registerCollector(collectHltStatistics);
+	registerCollector(collectEventStatistics);
+	registerCollector(collectDetectorStatistics);
+	registerCollector(collectLatencies);
+	registerCollector(collectInstrumentation);
+}
+
+std::string MetricsExporter::collect() {
+	MetricsWriter writer;
+	std::lock_guard<std::mutex> lock(collectorsMutex_);
+	for (const auto& collector : collectors_) {
+		collector(writer);
+	}
+	return writer.str();
+}
+
+void MetricsExporter::thread() {
+	boost::asio::io_service ioService;
+	tcp::acceptor acceptor(ioService);
+	try {
+		tcp::endpoint endpoint(tcp::v4(), port_);
+		acceptor.open(endpoint.protocol());
+		acceptor.set_option(tcp::acceptor::reuse_address(true));
+		acceptor.bind(endpoint);
+		acceptor.listen();
+	} catch (const boost::system::system_error& e) {
+		LOG_ERROR("Unable to open metrics port " << port_ << ": " << e.what());
+		return;
+	}
+	startAccept(ioService, acceptor);
+	std::thread server([&ioService]() {ioService.run();});
+	LOG_INFO("Serving metrics on port " << port_);
+
+	while (running_) {
+		std::atomic_store(&snapshot_, std::make_shared<const std::string>(collect()));
+
+		for (uint waited = 0; running_ && waited < snapshotIntervalMillis_; waited += 10) {
+			usleep(10000);
+		}
+	}
+
+	ioService.post([&acceptor]() {
+		boost::system::error_code ignored;
+		acceptor.close(ignored);
+	});
+	ioService.stop();
+	server.join();
+}
+
+void MetricsExporter::onInterruption() {
+	running_ = false;
+}
+
+} /* namespace na62 */
@@ -0,0 +1,133 @@
+/*
+ * MetricsExporter.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: NA62 collaboration
+ */
+
+#pragma once
+#ifndef METRICSEXPORTER_H_
+#define METRICSEXPORTER_H_
+
+#include <sys/types.h>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../utils/AExecutable.h"
+
+namespace na62 {
+
+typedef std::pair<const char*, std::string> MetricLabel;
+
+/*
+ * Builds a page in the OpenMetrics text format
+ */
+class MetricsWriter {
+public:
+	/*
+	 * Starts a new metric family. <type> is one of counter, gauge, histogram
+	 */
+	void family(const std::string& name, const char* type, const char* help) {
+		stream_ << "# TYPE " << name << " " << type << "\n# HELP " << name << " " << help << "\n";
+	}
+
+	void sample(const std::string& name, std::initializer_list<MetricLabel> labels,
+			const uint64_t value) {
+		writeName(name, labels);
+		stream_ << value << "\n";
+	}
+
+	void sample(const std::string& name, std::initializer_list<MetricLabel> labels,
+			const double value) {
+		writeName(name, labels);
+		stream_ << value << "\n";
+	}
+
+	std::string str() {
+		return stream_.str() + "# EOF\n";
+	}
+
+	static std::string hex(const uint value) {
+		std::ostringstream s;
+		s << "0x" << std::hex << value;
+		return s.str();
+	}
+
+private:
+	void writeName(const std::string& name, std::initializer_list<MetricLabel> labels) {
+		stream_ << name;
+		if (labels.size() != 0) {
+			stream_ << "{";
+			bool first = true;
+			for (const auto& label : labels) {
+				stream_ << (first ? "" : ",") << label.first << "=\"" << label.second << "\"";
+				first = false;
+			}
+			stream_ << "}";
+		}
+		stream_ << " ";
+	}
+
+	std::ostringstream stream_;
+};
+
+/*
+ * Registry of all farm metrics with an HTTP endpoint serving them in the OpenMetrics text format.
+ *
+ * The thread of this object calls all registered collectors every snapshotIntervalMillis and publishes
+ * the resulting page atomically. Scrapes (GET /metrics) only copy the last published page, so a scrape never
+ * touches the counters and never blocks the data path. The collectors only read relaxed atomics.
+ */
+class MetricsExporter: public AExecutable {
+public:
+	typedef std::function<void(MetricsWriter&)> Collector;
+
+	MetricsExporter(const ushort port, const uint snapshotIntervalMillis);
+	virtual ~MetricsExporter();
+
+	/*
+	 * Collectors are called in the order of registration by the snapshot thread
+	 */
+	static void registerCollector(const Collector& collector);
+
+	/*
+	 * Registers the collectors of all statistics of this library. Called once by the constructor
+	 */
+	static void registerDefaultCollectors();
+
+	/*
+	 * Runs all collectors and returns the page
+	 */
+	static std::string collect();
+
+	/*
+	 * Returns the last published page
+	 */
+	static std::shared_ptr<const std::string> getSnapshot() {
+		return std::atomic_load(&snapshot_);
+	}
+
+private:
+	virtual void thread();
+	virtual void onInterruption();
+
+	const ushort port_;
+	const uint snapshotIntervalMillis_;
+	std::atomic<bool> running_;
+
+	static std::mutex collectorsMutex_;
+	static std::vector<Collector> collectors_;
+	static std::shared_ptr<const std::string> snapshot_;
+};
+
+} /* namespace na62 */
+
+#endif /* METRICSEXPORTER_H_ */
@@ -0,0 +1,218 @@
+/*
+ * Tracer.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: NA62 collaboration
+ */
+
+#include "Tracer.h"
+
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "../options/Logging.h"
+#include "../utils/ThreadLocalRing.h"
+
+namespace na62 {
+
+namespace {
+
+const uint TRACE_RING_SIZE = 4096; // must be a power of two
+
+typedef ThreadLocalRing<TraceRecord, TRACE_RING_SIZE> TraceRing;
+
+/*
+ * Writes all pending records of all threads as one block per thread
+ */
+void drainTraceBuffers(std::ofstream& file) {
+	TraceRing::drain(
+			[&file](const pid_t threadID, const TraceRecord* first, const uint numberOfFirst,
+					const TraceRecord* second, const uint numberOfSecond) {
+				const uint32_t blockThreadID = threadID;
+				const uint32_t numberOfRecords = numberOfFirst + numberOfSecond;
+				file.write((const char*) &blockThreadID, sizeof(uint32_t));
+				file.write((const char*) &numberOfRecords, sizeof(uint32_t));
+				file.write((const char*) first, numberOfFirst * sizeof(TraceRecord));
+				file.write((const char*) second, numberOfSecond * sizeof(TraceRecord));
+			});
+	file.flush();
+}
+
+}
+
+std::atomic<bool> Tracer::enabled_(false);
+std::atomic<uint32_t> Tracer::samplingMask_(0);
+std::atomic<uint64_t> Tracer::droppedRecords_(0);
+
+Tracer::Tracer(const std::string fileName, const uint samplingShift) :
+		fileName_(fileName), running_(true) {
+	samplingMask_ = (1u << samplingShift) - 1;
+	TscClock::calibrate();
+}
+
+Tracer::~Tracer() {
+}
+
+void Tracer::write(const TraceStage stage, const uint32_t burstID, const uint32_t eventNumber,
+		const uint8_t sourceID, const uint16_t sourceSubID) {
+	TraceRecord* record = TraceRing::reserve();
+	if (record == nullptr) {
+		droppedRecords_.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	record->timestamp = TscClock::now();
+	record->burstID = burstID;
+	record->eventNumber = eventNumber;
+	record->stage = stage;
+	record->sourceID = sourceID;
+	record->sourceSubID = sourceSubID;
+
+	TraceRing::commit();
+}
+
+void Tracer::thread() {
+	std::ofstream file(fileName_.c_str(), std::ofstream::binary | std::ofstream::trunc);
+	if (!file.is_open()) {
+		LOG_ERROR("Unable to open trace file " << fileName_);
+		return;
+	}
+
+	TraceFileHeader header;
+	memcpy(header.magic, "NA62TRC2", sizeof(header.magic));
+	header.ticksPerMicrosecond = TscClock::getTicksPerMicrosecond();
+	file.write((const char*) &header, sizeof(header));
+
+	LOG_INFO("Tracing every " << samplingMask_.load() + 1 << "th event to " << fileName_);
+	enabled_ = true;
+	while (running_) {
+		drainTraceBuffers(file);
+		usleep(10000);
+	}
+	enabled_ = false;
+
+	drainTraceBuffers(file);
+	file.close();
+	if (getDroppedRecords() != 0) {
+		LOG_ERROR("Tracer dropped " << getDroppedRecords() << " records due to full buffers");
+	}
+}
+
+void Tracer::onInterruption() {
+	running_ = false;
+}
+
+const char* Tracer::getStageName(const uint8_t stage) {
+	switch (stage) {
+	case TRACE_L0_FRAGMENT_RECEIVED:
+		return "L0FragmentReceived";
+	case TRACE_L0_COMPLETE:
+		return "L0Complete";
+	case TRACE_L1_PROCESSED:
+		return "L1Processed";
+	case TRACE_L1_FRAGMENT_RECEIVED:
+		return "L1FragmentReceived";
+	case TRACE_L1_COMPLETE:
+		return "L1Complete";
+	case TRACE_L2_PROCESSED:
+		return "L2Processed";
+	case TRACE_SERIALIZED:
+		return "Serialized";
+	case TRACE_DESTROYED:
+		return "Destroyed";
+	default:
+		return "UserStage";
+	}
+}
+
+bool Tracer::convertToChromeTrace(const std::string& traceFileName,
+		std::ostream& out) {
+	std::ifstream file(traceFileName.c_str(), std::ifstream::binary);
+	TraceFileHeader header;
+	if (!file.read((char*) &header, sizeof(header))
+			|| memcmp(header.magic, "NA62TRC2", sizeof(header.magic)) != 0
+			|| header.ticksPerMicrosecond <= 0) {
+		LOG_ERROR("Not a trace file: " << traceFileName);
+		return false;
+	}
+
+	// first and last timestamp of every event by burst ID and event number
+	std::map<std::pair<uint32_t, uint32_t>, std::pair<uint64_t, uint64_t>> eventSpans;
+	uint64_t firstTimestamp = UINT64_MAX;
+	bool firstEntry = true;
+
+	out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+	uint32_t threadID;
+	uint32_t numberOfRecords;
+	std::vector<TraceRecord> records;
+	std::streampos blocksStart = file.tellg();
+
+	/*
+	 * First pass: find the global start time to get small relative timestamps
+	 */
+	while (file.read((char*) &threadID, sizeof(threadID))
+			&& file.read((char*) &numberOfRecords, sizeof(numberOfRecords))) {
+		records.resize(numberOfRecords);
+		if (!file.read((char*) records.data(), numberOfRecords * sizeof(TraceRecord))) {
+			break;
+		}
+		for (const TraceRecord& record : records) {
+			const uint64_t timestamp = record.timestamp;
+			firstTimestamp = std::min(firstTimestamp, timestamp);
+		}
+	}
+
+	file.clear();
+	file.seekg(blocksStart);
+	out.precision(3);
+	out << std::fixed;
+	while (file.read((char*) &threadID, sizeof(threadID))
+			&& file.read((char*) &numberOfRecords, sizeof(numberOfRecords))) {
+		records.resize(numberOfRecords);
+		if (!file.read((char*) records.data(), numberOfRecords * sizeof(TraceRecord))) {
+			break;
+		}
+		for (const TraceRecord& record : records) {
+			const uint64_t timestamp = record.timestamp;
+			const double micros = (timestamp - firstTimestamp) / header.ticksPerMicrosecond;
+			out << (firstEntry ? "" : ",") << "\n{\"name\":\"" << getStageName(record.stage)
+					<< "\",\"ph\":\"i\",\"s\":\"t\",\"ts\":" << micros << ",\"pid\":1,\"tid\":"
+					<< threadID << ",\"args\":{\"burst\":" << record.burstID << ",\"event\":" << record.eventNumber
+					<< ",\"stage\":" << (uint) record.stage << ",\"sourceID\":"
+					<< (uint) record.sourceID << ",\"sourceSubID\":" << record.sourceSubID << "}}";
+			firstEntry = false;
+
+			const std::pair<uint32_t, uint32_t> event(record.burstID, record.eventNumber);
+			auto span = eventSpans.find(event);
+			if (span == eventSpans.end()) {
+				eventSpans[event] = std::make_pair(timestamp, timestamp);
+			} else {
+				span->second.first = std::min(span->second.first, timestamp);
+				span->second.second = std::max(span->second.second, timestamp);
+			}
+		}
+	}
+
+	for (const auto& span : eventSpans) {
+		const uint64_t id = ((uint64_t) span.first.first << 32) | span.first.second;
+		out << (firstEntry ? "" : ",") << "\n{\"name\":\"Event " << span.first.first << ":" << span.first.second
+				<< "\",\"cat\":\"event\",\"ph\":\"b\",\"id\":" << id << ",\"ts\":"
+				<< (span.second.first - firstTimestamp) / header.ticksPerMicrosecond
+				<< ",\"pid\":1,\"tid\":0}";
+		out << ",\n{\"name\":\"Event " << span.first.first << ":" << span.first.second
+				<< "\",\"cat\":\"event\",\"ph\":\"e\",\"id\":" << id << ",\"ts\":"
+				<< (span.second.second - firstTimestamp) / header.ticksPerMicrosecond
+				<< ",\"pid\":1,\"tid\":0}";
+		firstEntry = false;
+	}
+	out << "\n]}\n";
+	return true;
+}
+
+} /* namespace na62 */
@@ -0,0 +1,120 @@
+/*
+ * Tracer.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: NA62 collaboration
+ */
+
+#pragma once
+#ifndef TRACER_H_
+#define TRACER_H_
+
+#include <sys/types.h>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include "../utils/AExecutable.h"
+#include "../utils/TscClock.h"
+
+namespace na62 {
+
+/*
+ * Stages of the lifecycle of an event. Values above TRACE_USER_STAGE may be used freely by the farm
+ */
+enum TraceStage {
+	TRACE_L0_FRAGMENT_RECEIVED = 1,
+	TRACE_L0_COMPLETE,
+	TRACE_L1_PROCESSED,
+	TRACE_L1_FRAGMENT_RECEIVED,
+	TRACE_L1_COMPLETE,
+	TRACE_L2_PROCESSED,
+	TRACE_SERIALIZED,
+	TRACE_DESTROYED,
+	TRACE_USER_STAGE = 128
+};
+
+struct TraceRecord {
+	uint64_t timestamp; // TscClock ticks
+	uint32_t burstID;
+	uint32_t eventNumber;
+	uint8_t stage;
+	uint8_t sourceID;
+	uint16_t sourceSubID;
+}__attribute__ ((__packed__));
+
+/*
+ * Binary trace of sampled events.
+ *
+ * trace() writes a 20 byte record into a lock free ring buffer of the calling thread. The thread of the
+ * Tracer object empties all rings into a binary file:
+ *
+ *   TraceFileHeader
+ *   { uint32_t threadID; uint32_t numberOfRecords; TraceRecord[numberOfRecords] }*
+ *
+ * Events are sampled by their event number so that the whole lifecycle of a sampled event is traced
+ * by all threads. As event numbers restart every burst, an event is identified by burst ID and event number. If tracing is disabled trace() costs one relaxed load.
+ */
+class Tracer: public AExecutable {
+public:
+	struct TraceFileHeader {
+		char magic[8]; // "NA62TRC2"
+		double ticksPerMicrosecond;
+	}__attribute__ ((__packed__));
+
+	/*
+	 * Every 2^samplingShift'th event is traced. The sampling mask is set here, before the thread
+	 * enables tracing
+	 */
+	Tracer(const std::string fileName, const uint samplingShift);
+	virtual ~Tracer();
+
+	static inline void trace(const TraceStage stage, const uint32_t burstID, const uint32_t eventNumber,
+			const uint8_t sourceID = 0, const uint16_t sourceSubID = 0) {
+		if (!enabled_.load(std::memory_order_relaxed)
+				|| (eventNumber & samplingMask_.load(std::memory_order_relaxed)) != 0) {
+			return;
+		}
+		write(stage, burstID, eventNumber, sourceID, sourceSubID);
+	}
+
+	static inline bool isEnabled() {
+		return enabled_.load(std::memory_order_relaxed);
+	}
+
+	/*
+	 * Number of records lost because a ring buffer was full
+	 */
+	static uint64_t getDroppedRecords() {
+		return droppedRecords_.load(std::memory_order_relaxed);
+	}
+
+	/*
+	 * Converts a binary trace file into the Chrome trace event JSON format (chrome://tracing, Perfetto).
+	 * Every record becomes an instant event on the thread that wrote it and every event (burst ID and
+	 * event number) an async slice from its first to its last record.
+	 */
+	static bool convertToChromeTrace(const std::string& traceFileName,
+			std::ostream& out);
+
+private:
+	static void write(const TraceStage stage, const uint32_t burstID, const uint32_t eventNumber,
+			const uint8_t sourceID, const uint16_t sourceSubID);
+
+	virtual void thread();
+	virtual void onInterruption();
+
+	static const char* getStageName(const uint8_t stage);
+
+	const std::string fileName_;
+	std::atomic<bool> running_;
+
+	static std::atomic<bool> enabled_;
+	static std::atomic<uint32_t> samplingMask_;
+	static std::atomic<uint64_t> droppedRecords_;
+};
+
+} /* namespace na62 */
+
+#endif /* TRACER_H_ */
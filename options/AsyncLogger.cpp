@@ -0,0 +1,208 @@
+/*
+ * AsyncLogger.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: NA62 collaboration
+ */
+
+#include "AsyncLogger.h"
+
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+#include "../utils/ThreadLocalRing.h"
+
+namespace na62 {
+
+namespace {
+
+const uint RECORD_TEXT_SIZE = 464;
+const uint RING_SIZE = 256; // must be a power of two
+
+struct LogRecord {
+	uint64_t timestamp; // microseconds since epoch
+	uint64_t suppressed;
+	const char* file;
+	uint line;
+	uint16_t length;
+	uint8_t level;
+	bool truncated;
+	char text[RECORD_TEXT_SIZE];
+};
+
+typedef ThreadLocalRing<LogRecord, RING_SIZE> LogRing;
+
+std::atomic<bool> running_(false);
+std::thread drainThread_;
+std::once_flag atexitFlag_;
+
+thread_local std::stringstream threadStream_;
+
+uint64_t nowMicros() {
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+const char* baseName(const char* file) {
+	const char* slash = strrchr(file, '/');
+	return slash == nullptr ? file : slash + 1;
+}
+
+void writeLine(std::ostream& out, const uint8_t level, const uint64_t timestamp,
+		const pid_t threadID, const char* file, const uint line, const char* text,
+		const uint length, const bool truncated, const uint64_t suppressed) {
+	static const char levelChars[] = { 'E', 'W', 'I' };
+
+	const std::time_t seconds = timestamp / 1000000;
+	struct tm time;
+	localtime_r(&seconds, &time);
+	char timeString[32];
+	strftime(timeString, sizeof(timeString), "%m%d %H:%M:%S", &time);
+
+	out << levelChars[level] << timeString << "." << std::setfill('0')
+			<< std::setw(6) << timestamp % 1000000 << std::setfill(' ') << " "
+			<< threadID << " " << baseName(file) << ":" << line << "] ";
+	out.write(text, length);
+	if (truncated) {
+		out << "...";
+	}
+	if (suppressed != 0) {
+		out << " (" << suppressed << " similar messages suppressed)";
+	}
+	out << '\n';
+}
+
+/*
+ * Writes all pending records of all threads. Returns the number of written records
+ */
+uint drainAll() {
+	static uint64_t reportedDrops = 0;
+	bool wroteErrors = false;
+
+	const uint written = LogRing::drain(
+			[&wroteErrors](const pid_t threadID, const LogRecord* first, const uint numberOfFirst,
+					const LogRecord* second, const uint numberOfSecond) {
+				for (uint i = 0; i != numberOfFirst + numberOfSecond; i++) {
+					const LogRecord& record = i < numberOfFirst ? first[i] : second[i - numberOfFirst];
+					std::ostream& out = record.level == LOG_LEVEL_INFO ? std::cout : std::cerr;
+					wroteErrors |= record.level != LOG_LEVEL_INFO;
+					writeLine(out, record.level, record.timestamp, threadID,
+							record.file, record.line, record.text, record.length,
+							record.truncated, record.suppressed);
+				}
+			});
+
+	const uint64_t drops = AsyncLogger::getDroppedMessages();
+	if (drops != reportedDrops) {
+		std::cerr << "AsyncLogger: " << drops - reportedDrops
+				<< " messages dropped due to full buffers\n";
+		reportedDrops = drops;
+		wroteErrors = true;
+	}
+
+	if (written != 0) {
+		std::cout.flush();
+	}
+	if (wroteErrors) {
+		std::cerr.flush();
+	}
+	return written;
+}
+
+void drainLoop() {
+	while (running_.load(std::memory_order_acquire)) {
+		if (drainAll() == 0) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		}
+	}
+}
+
+}
+
+std::atomic<uint64_t> AsyncLogger::droppedMessages_(0);
+
+void AsyncLogger::start() {
+	bool running = false;
+	if (!running_.compare_exchange_strong(running, true)) {
+		return;
+	}
+	drainThread_ = std::thread(drainLoop);
+	std::call_once(atexitFlag_, []() {std::atexit(AsyncLogger::stop);});
+}
+
+void AsyncLogger::stop() {
+	bool running = true;
+	if (!running_.compare_exchange_strong(running, false)) {
+		return;
+	}
+	if (drainThread_.joinable()) {
+		drainThread_.join();
+	}
+	drainAll();
+}
+
+bool AsyncLogger::hasSpace(const uint64_t suppressed) {
+	if (!running_.load(std::memory_order_acquire) || LogRing::reserve() != nullptr) {
+		return true;
+	}
+	droppedMessages_.fetch_add(1 + suppressed, std::memory_order_relaxed);
+	return false;
+}
+
+std::stringstream& AsyncLogger::stream() {
+	/*
+	 * Rewind instead of assigning an empty string to keep the buffer. Old characters behind the write
+	 * position are ignored as push() only reads up to tellp()
+	 */
+	threadStream_.clear();
+	threadStream_.seekp(0);
+	threadStream_.seekg(0);
+	return threadStream_;
+}
+
+void AsyncLogger::push(const LogLevel level, std::stringstream& message,
+		const uint64_t suppressed, const char* file, const uint line) {
+	const std::streamoff size = std::max<std::streamoff>(message.tellp(), 0);
+
+	if (!running_.load(std::memory_order_acquire)) {
+		/*
+		 * Drain thread not (yet/anymore) running: write synchronously like before
+		 */
+		const std::string text = message.str().substr(0, size);
+		std::ostream& out = level == LOG_LEVEL_INFO ? std::cout : std::cerr;
+		writeLine(out, level, nowMicros(), syscall(SYS_gettid), file, line,
+				text.data(), text.size(), false, suppressed);
+		out.flush();
+		return;
+	}
+
+	LogRecord* slot = LogRing::reserve();
+	if (slot == nullptr) {
+		/*
+		 * Only possible if formatting the message logged itself and filled the ring
+		 */
+		droppedMessages_.fetch_add(1 + suppressed, std::memory_order_relaxed);
+		return;
+	}
+
+	LogRecord& record = *slot;
+	record.timestamp = nowMicros();
+	record.suppressed = suppressed;
+	record.file = file;
+	record.line = line;
+	record.level = level;
+	record.length = message.rdbuf()->sgetn(record.text, std::min<std::streamoff>(size, RECORD_TEXT_SIZE));
+	record.truncated = record.length != size;
+
+	LogRing::commit();
+}
+
+} /* namespace na62 */
@@ -0,0 +1,154 @@
+/*
+ * AsyncLogger.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: NA62 collaboration
+ */
+
+#pragma once
+#ifndef ASYNCLOGGER_H_
+#define ASYNCLOGGER_H_
+
+#include <sys/types.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <sstream>
+
+/*
+ * Messages with a level above NA62_LOG_LEVEL are removed at compile time:
+ * 0 = errors only, 1 = errors and warnings, 2 = everything
+ */
+#ifndef NA62_LOG_LEVEL
+#define NA62_LOG_LEVEL 2
+#endif
+
+/*
+ * Maximum number of messages per second written by a single LOG_WARNING/LOG_ERROR statement
+ */
+#ifndef NA62_LOG_RATE_LIMIT
+#define NA62_LOG_RATE_LIMIT 20
+#endif
+
+/*
+ * Maximum number of messages per second written by a single LOG_INFO statement. Higher than the
+ * warning/error limit so that loops printing the configuration at startup stay complete
+ */
+#ifndef NA62_LOG_INFO_RATE_LIMIT
+#define NA62_LOG_INFO_RATE_LIMIT 1000
+#endif
+
+namespace na62 {
+
+enum LogLevel {
+	LOG_LEVEL_ERROR = 0, LOG_LEVEL_WARNING = 1, LOG_LEVEL_INFO = 2
+};
+
+/*
+ * Rate limiter of a single logging statement. Every logging macro owns one static instance so that a
+ * message flooding the log from the packet path does not drown all others.
+ */
+class LogRateLimiter {
+public:
+	/*
+	 * Returns true if the message may be written, allowing <limit> messages per second. In this case
+	 * <suppressed> is set to the number of messages dropped by this call site since the last written one.
+	 */
+	inline bool allow(uint64_t& suppressed, const uint limit) {
+		const uint64_t second = std::chrono::duration_cast<std::chrono::seconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count();
+
+		uint64_t window = windowStart_.load(std::memory_order_relaxed);
+		if (window != second
+				&& windowStart_.compare_exchange_strong(window, second,
+						std::memory_order_relaxed)) {
+			messagesInWindow_.store(0, std::memory_order_relaxed);
+		}
+
+		if (messagesInWindow_.fetch_add(1, std::memory_order_relaxed) < limit) {
+			suppressed = suppressed_.exchange(0, std::memory_order_relaxed);
+			return true;
+		}
+		suppressed_.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+private:
+	std::atomic<uint64_t> windowStart_;
+	std::atomic<uint> messagesInWindow_;
+	std::atomic<uint64_t> suppressed_;
+};
+
+/*
+ * Logging backend of the default build (neither USE_GLOG nor USE_ERS).
+ *
+ * Every thread writes its messages into an own single producer/single consumer ring buffer which is
+ * emptied by one background thread. Writing a message therefore never takes a lock and never waits
+ * for the terminal or file. If a ring is full the message is dropped and counted without being formatted.
+ *
+ * As long as start() has not been called messages are written synchronously to stdout/stderr.
+ *
+ * As with the former std::cout/std::cerr backend all levels enabled by NA62_LOG_LEVEL are written,
+ * independent of the verbosity option.
+ */
+class AsyncLogger {
+public:
+	/*
+	 * Starts the drain thread
+	 */
+	static void start();
+
+	/*
+	 * Writes all pending messages and joins the drain thread. Registered via atexit by start()
+	 */
+	static void stop();
+
+	/*
+	 * Returns false if the ring of the calling thread is full. The message and the <suppressed> ones are
+	 * then counted as dropped and must not be formatted
+	 */
+	static bool hasSpace(const uint64_t suppressed);
+
+	/*
+	 * Returns an empty stream owned by the calling thread to format the next message. The buffer of the
+	 * stream is reused, so formatting does not allocate once it has grown to the longest message
+	 */
+	static std::stringstream& stream();
+
+	/*
+	 * Enqueues the message formatted in stream(), copying it directly out of the stream buffer
+	 */
+	static void push(const LogLevel level, std::stringstream& message,
+			const uint64_t suppressed, const char* file, const uint line);
+
+	/*
+	 * Number of messages lost because a ring buffer was full
+	 */
+	static uint64_t getDroppedMessages() {
+		return droppedMessages_.load(std::memory_order_relaxed);
+	}
+
+private:
+	static std::atomic<uint64_t> droppedMessages_;
+};
+
+} /* namespace na62 */
+
+/*
+ * The message is only formatted if the level is enabled, the rate limit of this call site is not
+ * exceeded and the ring of the calling thread has space. Otherwise <message> is never evaluated.
+ */
+#define NA62_ASYNC_LOG(level, message) do { \
+	if (level <= NA62_LOG_LEVEL) { \
+		static na62::LogRateLimiter na62LogRateLimiter_; \
+		uint64_t na62LogSuppressed_ = 0; \
+		if (na62LogRateLimiter_.allow(na62LogSuppressed_, \
+				level == na62::LOG_LEVEL_INFO ? NA62_LOG_INFO_RATE_LIMIT : NA62_LOG_RATE_LIMIT) \
+				&& na62::AsyncLogger::hasSpace(na62LogSuppressed_)) { \
+			std::stringstream& na62LogStream_ = na62::AsyncLogger::stream(); \
+			na62LogStream_ << message; \
+			na62::AsyncLogger::push(level, na62LogStream_, na62LogSuppressed_, __FILE__, __LINE__); \
+		} \
+	} } while(0)
+
+#endif /* ASYNCLOGGER_H_ */
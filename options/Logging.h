@@ -27,10 +27,10 @@
 	#define LOG_ERROR(message)	ERS_ERROR(message)
 	#define LOG_WARNING(message)	ERS_WARNING(message)
 #else
-	#include <iostream>
-	#define LOG_INFO(message)	std::cout << message << std::endl
-	#define LOG_ERROR(message)	std::cerr << message << std::endl
-	#define LOG_WARNING(message)	std::cerr << message << std::endl
+	#include "AsyncLogger.h"
+	#define LOG_INFO(message)	NA62_ASYNC_LOG(na62::LOG_LEVEL_INFO, message)
+	#define LOG_ERROR(message)	NA62_ASYNC_LOG(na62::LOG_LEVEL_ERROR, message)
+	#define LOG_WARNING(message)	NA62_ASYNC_LOG(na62::LOG_LEVEL_WARNING, message)
 #endif
 
 #endif /* LOGGING_H_ */
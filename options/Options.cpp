@@ -75,6 +75,9 @@ void Options::Initialize(int argc, char* argv[], po::options_description desc) {
 	(OPTION_DELAY_EOB_PROCESSING, po::value<int>()->default_value(2000),
 			"Delay in milliseconds before the EOB cleanup.")
 
+	(OPTION_L0_SUB_IDS, po::value<std::string>()->default_value(""),
+			"SubIDs sending data for L0 sources whose boards are not numbered 0 to n-1, e.g. 0x0C:0-3,0x0C:6. Sources not listed use the subIDs 0 to n-1 where n is the number of fragments per event.")
+
 			;
 
 	po::store(po::parse_command_line(argc, argv, desc), vm);
@@ -139,6 +142,8 @@ void Options::Initialize(int argc, char* argv[], po::options_description desc) {
 		freopen (std::string(GetString(OPTION_LOG_FILE) +"/" + GetString(OPTION_APP_NAME) + "_" + ts + ".info").c_str(),"w",stdout);
 		freopen (std::string(GetString(OPTION_LOG_FILE) +"/" + GetString(OPTION_APP_NAME) + "_" + ts + ".err").c_str(),"w",stderr);
 	}
+#else
+	AsyncLogger::start();
 #endif
 
 	std::cout << "======= Running with following configuration:" << std::endl;
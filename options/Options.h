@@ -42,6 +42,7 @@ namespace po = boost::program_options;
 #define OPTION_LOG_FILE (char*)"logDir"
 #define OPTION_APP_NAME (char*)"appName"
 #define OPTION_DELAY_EOB_PROCESSING (char*)"delayEOBProcessing"
+#define OPTION_L0_SUB_IDS (char*)"L0SubIDs"
 
 namespace na62 {
 class Options {
@@ -29,7 +29,7 @@ void EventSerializer::initialize() {
 	/*
 	 * L0 + L1 sources
 	 */
-	TotalNumberOfDetectors_ = SourceIDManager::NUMBER_OF_L0_DATA_SOURCES + SourceIDManager::NUMBER_OF_L1_DATA_SOURCES ;
+	TotalNumberOfDetectors_ = SourceIDManager::getNumberOfL0DataSources() + SourceIDManager::getNumberOfL1DataSources() ;
 	InitialEventBufferSize_ = 4096; // allocate 4 kB initially for the serialized event
 }
 
@@ -109,7 +109,7 @@ uint& eventBufferSize, uint& pointerTableOffset, bool& isUnfinishedEOB) {
 	/*
 	 * Write all L0 data sources
 	 */
-	for (int sourceNum = 0; sourceNum != SourceIDManager::NUMBER_OF_L0_DATA_SOURCES; sourceNum++) {
+	for (int sourceNum = 0; sourceNum != SourceIDManager::getNumberOfL0DataSources(); sourceNum++) {
 		const l0::Subevent* const subevent = event->getL0SubeventBySourceIDNum(sourceNum);
 
 		if (eventOffset + 4 > eventBufferSize) {
@@ -195,7 +195,7 @@ uint& eventBufferSize, uint& pointerTableOffset, bool& isUnfinishedEOB) {
 char* EventSerializer::writeL1Data(const Event* event, char*& eventBuffer, uint& eventOffset,
 		uint& eventBufferSize, uint& pointerTableOffset, bool& isUnfinishedEOB) {
 
-	for (int sourceNum = 0; sourceNum != SourceIDManager::NUMBER_OF_L1_DATA_SOURCES; sourceNum++) {
+	for (int sourceNum = 0; sourceNum != SourceIDManager::getNumberOfL1DataSources(); sourceNum++) {
 		const l1::Subevent* const subevent = event->getL1SubeventBySourceIDNum(sourceNum);
 
 		if (eventOffset + 4 > eventBufferSize) {
@@ -215,8 +215,6 @@ char* EventSerializer::writeL1Data(const Event* event, char*& eventBuffer, uint&
 		for (uint fragmentNum = 0; fragmentNum != subevent->getNumberOfFragments(); fragmentNum++) {
 			l1::MEPFragment* e = subevent->getFragment(fragmentNum);
 	        if (SourceIDManager::l1SourceNumToID(sourceNum)!=SOURCE_ID_LKr||e->getEventLength()!=28) {	// RF 22.09.2016
-	        	LOG_ERROR ("Source ID " << SourceIDManager::l1SourceNumToID(sourceNum));
-	        	LOG_ERROR ("Length    " << e->getEventLength());
 	        	if (eventOffset + e->getEventLength() > eventBufferSize) {
 	        		eventBuffer = ResizeBuffer(eventBuffer, eventBufferSize,
 						eventBufferSize + std::max(4096, (int) e->getEventLength()));
@@ -33,7 +33,7 @@ void SmartEventSerializer::initialize() {
 	/*
 	 * L0 + L1 sources
 	 */
-	TotalNumberOfDetectors_ = SourceIDManager::NUMBER_OF_L0_DATA_SOURCES + SourceIDManager::NUMBER_OF_L1_DATA_SOURCES ;
+	TotalNumberOfDetectors_ = SourceIDManager::getNumberOfL0DataSources() + SourceIDManager::getNumberOfL1DataSources() ;
 	//InitialEventBufferSize_ = 1000;
 	//InitialEventBufferSize_ = 4096; // allocate 4 kB initially for the serialized event
 	//Should not be less than the header size!!!
@@ -63,7 +63,7 @@ EVENT_HDR* SmartEventSerializer::SerializeEvent(const Event* event) {
 }
 
 EVENT_HDR* SmartEventSerializer::SerializeEvent(const Event* event, l1_SerializedEvent* seriale) {
-	uint eventBufferSize = sizeof(l1_SerializedEvent); //Set the length of the buffersize equal to the size of the fragment of the shared memory
+	uint eventBufferSize = sizeof(l1_SerializedEvent) - L1_TRIGGER_RESULT_AREA_SIZE; //Set the length of the buffersize equal to the size of the fragment of the shared memory without the trigger result area
 	char* eventBuffer = (char*) seriale;
 	bool isInitialEventBufferSizeFixed = true; //Length can't change
 	return SmartEventSerializer::doSerialization(event, eventBuffer, eventBufferSize, isInitialEventBufferSizeFixed);
@@ -117,7 +117,7 @@ uint& eventBufferSize, uint& pointerTableOffset, bool& isUnfinishedEOB, bool& is
 	/*
 	 * Write all L0 data sources
 	 */
-	for (int sourceNum = 0; sourceNum != SourceIDManager::NUMBER_OF_L0_DATA_SOURCES; sourceNum++) {
+	for (int sourceNum = 0; sourceNum != SourceIDManager::getNumberOfL0DataSources(); sourceNum++) {
 		const l0::Subevent* const subevent = event->getL0SubeventBySourceIDNum(sourceNum);
 
 		if (eventOffset + 4 > eventBufferSize) {
@@ -203,7 +203,7 @@ uint& eventBufferSize, uint& pointerTableOffset, bool& isUnfinishedEOB, bool& is
 char* SmartEventSerializer::writeL1Data(const Event* event, char*& eventBuffer, uint& eventOffset,
 		uint& eventBufferSize, uint& pointerTableOffset, bool& isUnfinishedEOB, bool& isInitialEventBufferSizeFixed) {
 
-	for (int sourceNum = 0; sourceNum != SourceIDManager::NUMBER_OF_L1_DATA_SOURCES; sourceNum++) {
+	for (int sourceNum = 0; sourceNum != SourceIDManager::getNumberOfL1DataSources(); sourceNum++) {
 		const l1::Subevent* const subevent = event->getL1SubeventBySourceIDNum(sourceNum);
 
 		if (eventOffset + 4 > eventBufferSize) {
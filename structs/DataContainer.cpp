@@ -9,21 +9,39 @@
 
 namespace na62 {
 
+std::atomic<DataContainerChecksumMode> DataContainer::checksumMode_(CHECKSUM_OFF);
+std::atomic<uint> DataContainer::checksumSampleRate_(1000);
+ShardedCounters<NUMBER_OF_CHECKSUM_COUNTERS> DataContainer::checksumCounters_;
+
 DataContainer::DataContainer(char* _data, uint_fast16_t _length,
-		bool _ownerMayFreeData) :
-		data(_data), length(_length), ownerMayFreeData(_ownerMayFreeData) {
-	checksum = GenerateChecksum(_data, _length, 0);
+		bool _ownerMayFreeData, PacketBufferClass _bufferClass) :
+		data(_data), length(_length), ownerMayFreeData(_ownerMayFreeData), checksumTracked(trackChecksum()), bufferClass(
+				_bufferClass), checksum(0) {
+	if (checksumTracked) {
+		checksum = GenerateChecksum(_data, _length, 0);
+		checksumCounters_.add(CHECKSUM_COMPUTED, 1);
+	} else {
+		checksumCounters_.add(CHECKSUM_SKIPPED, 1);
+	}
+}
+
+void DataContainer::setChecksumMode(const DataContainerChecksumMode mode, const uint sampleRate) {
+	checksumSampleRate_ = std::max(sampleRate, 1u);
+	checksumMode_ = mode;
 }
 
 bool DataContainer::checkValid() {
-	if(checksum==0 && data == nullptr){
+	if (!checksumTracked || data == nullptr) {
 		return true;
 	}
 
+	checksumCounters_.add(CHECKSUM_VERIFIED, 1);
 	if (checksum != GenerateChecksum(data, length, 0)) {
+		checksumCounters_.add(CHECKSUM_CORRUPTED, 1);
 		LOG_ERROR("Packet broke!");
+		return false;
 	}
-	return checksum != GenerateChecksum(data, length, 0);
+	return true;
 }
 
 }
@@ -13,20 +13,43 @@
 #include <cstdint>
 
 #include "../options/Logging.h"
+#include "../utils/PacketBufferPool.h"
+#include "../utils/ThreadShard.h"
 
 namespace na62 {
+
+/*
+ * Which received packets get a checksum to detect buffer corruption between receive and free():
+ * OFF for production, SAMPLED (1 in N) for validation runs and FULL for debugging
+ */
+enum DataContainerChecksumMode
+	: uint_fast8_t {
+		CHECKSUM_OFF, CHECKSUM_SAMPLED, CHECKSUM_FULL
+};
+
+enum DataContainerChecksumCounter {
+	CHECKSUM_COMPUTED, CHECKSUM_SKIPPED, CHECKSUM_VERIFIED, CHECKSUM_CORRUPTED, NUMBER_OF_CHECKSUM_COUNTERS
+};
+
 struct DataContainer {
 	char * data;
 	uint_fast16_t length;
 	bool ownerMayFreeData;
+	bool checksumTracked;
+	PacketBufferClass bufferClass; // The pool <data> is returned to by free()
 
 	uint16_t checksum;
 
 	DataContainer() :
-			data(nullptr), length(0), ownerMayFreeData(false), checksum(0) {
+			data(nullptr), length(0), ownerMayFreeData(false), checksumTracked(false), bufferClass(PACKET_BUFFER_HEAP), checksum(0) {
 	}
 
-	DataContainer(char* _data, uint_fast16_t _length, bool _ownerMayFreeData);
+	/*
+	 * <_data> must either be allocated with new[] or come from PacketBufferPool::allocate
+	 * which has set <_bufferClass>
+	 */
+	DataContainer(char* _data, uint_fast16_t _length, bool _ownerMayFreeData,
+			PacketBufferClass _bufferClass = PACKET_BUFFER_HEAP);
 
 	~DataContainer() {
 	}
@@ -36,7 +59,7 @@ struct DataContainer {
 	 */
 	DataContainer(const DataContainer& other) :
 			data(other.data), length(std::move(other.length)), ownerMayFreeData(
-					other.ownerMayFreeData), checksum(other.checksum) {
+					other.ownerMayFreeData), checksumTracked(other.checksumTracked), bufferClass(other.bufferClass), checksum(other.checksum) {
 	}
 
 	/**
@@ -44,7 +67,7 @@ struct DataContainer {
 	 */
 	DataContainer(const DataContainer&& other) :
 			data(other.data), length(other.length), ownerMayFreeData(
-					other.ownerMayFreeData), checksum(other.checksum) {
+					other.ownerMayFreeData), checksumTracked(other.checksumTracked), bufferClass(other.bufferClass), checksum(other.checksum) {
 	}
 
 	/**
@@ -55,6 +78,8 @@ struct DataContainer {
 			data = other.data;
 			length = other.length;
 			ownerMayFreeData = other.ownerMayFreeData;
+			checksumTracked = other.checksumTracked;
+			bufferClass = other.bufferClass;
 			checksum = other.checksum;
 
 			other.data = nullptr;
@@ -71,13 +96,32 @@ struct DataContainer {
 			data = other.data;
 			length = other.length;
 			ownerMayFreeData = other.ownerMayFreeData;
+			checksumTracked = other.checksumTracked;
+			bufferClass = other.bufferClass;
 			checksum = other.checksum;
 		}
 		return *this;
 	}
 
+	/*
+	 * Returns false if the data has changed since the container was created. Containers without
+	 * checksum (see setChecksumMode) are always valid
+	 */
 	bool checkValid();
 
+	/*
+	 * With CHECKSUM_SAMPLED every <sampleRate>th container of each thread gets a checksum
+	 */
+	static void setChecksumMode(const DataContainerChecksumMode mode, const uint sampleRate = 1000);
+
+	static inline DataContainerChecksumMode getChecksumMode() {
+		return checksumMode_.load(std::memory_order_relaxed);
+	}
+
+	static inline uint64_t getChecksumCounter(const DataContainerChecksumCounter counter) {
+		return checksumCounters_.get(counter);
+	}
+
 	static inline u_int32_t Wrapsum(u_int32_t sum) {
 		sum = ~sum & 0xFFFF;
 		return (htons(sum));
@@ -116,13 +160,37 @@ struct DataContainer {
 	}
 
 	void inline free() {
-		//checkValid();
+		if (checksumTracked) {
+			checkValid();
+			checksumTracked = false;
+		}
 		if (ownerMayFreeData) {
 			checksum = 0;
-			delete[] data;
+			PacketBufferPool::release(data, bufferClass);
 			data = nullptr;
 		}
 	}
+
+private:
+	static inline bool trackChecksum() {
+		switch (checksumMode_.load(std::memory_order_relaxed)) {
+		case CHECKSUM_OFF:
+			return false;
+		case CHECKSUM_FULL:
+			return true;
+		default:
+			static thread_local uint packetsSinceSample = 0;
+			if (++packetsSinceSample < checksumSampleRate_) {
+				return false;
+			}
+			packetsSinceSample = 0;
+			return true;
+		}
+	}
+
+	static std::atomic<DataContainerChecksumMode> checksumMode_;
+	static std::atomic<uint> checksumSampleRate_;
+	static ShardedCounters<NUMBER_OF_CHECKSUM_COUNTERS> checksumCounters_;
 };
 
 }
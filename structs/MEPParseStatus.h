@@ -0,0 +1,109 @@
+/*
+ * MEPParseStatus.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: NA62 collaboration
+ */
+
+#pragma once
+#ifndef MEPPARSESTATUS_H_
+#define MEPPARSESTATUS_H_
+
+#include <cstdint>
+
+#include "../options/Options.h"
+
+namespace na62 {
+
+/*
+ * Result of the validation pass over a received L0 or L1 MEP. Anything else than OK
+ * means that no MEPFragment has been created and the packet must be dropped.
+ */
+enum class MEPParseStatus : uint_fast8_t {
+	OK = 0,
+	EMPTY_PACKET, // UDP payload of length 0
+	TRUNCATED_HEADER, // Less data than a single MEP/L1 header
+	TRUNCATED_MEP, // 'mep length' field larger than the received data
+	OVERSIZED_MEP, // 'mep length' field smaller than the received data
+	UNKNOWN_SOURCE_ID, // SourceID not configured in the SourceIDManager
+	BAD_FRAGMENT_LENGTH, // Fragment length smaller than its header or larger than a jumbo frame
+	TRUNCATED_FRAGMENT, // Fragment exceeds the received data
+	BAD_EVENT_NUMBER, // Event number LSB of a fragment does not match the MEP header
+	TRAILING_BYTES, // Sum of all fragments is smaller than the received data
+	TOO_MANY_FRAGMENTS, // More fragments than fit into a single frame
+	NUMBER_OF_STATUS_CODES
+};
+
+inline const char* mepParseStatusToString(const MEPParseStatus status) {
+	switch (status) {
+	case MEPParseStatus::OK:
+		return "OK";
+	case MEPParseStatus::EMPTY_PACKET:
+		return "Received EMPTY UDP packet";
+	case MEPParseStatus::TRUNCATED_HEADER:
+		return "Incomplete MEP: size smaller than the MEP header";
+	case MEPParseStatus::TRUNCATED_MEP:
+		return "Incomplete MEP: received less data than the 'mep length' field";
+	case MEPParseStatus::OVERSIZED_MEP:
+		return "Received MEP longer than 'mep length' field";
+	case MEPParseStatus::UNKNOWN_SOURCE_ID:
+		return "Unknown source ID";
+	case MEPParseStatus::BAD_FRAGMENT_LENGTH:
+		return "MEPFragment with invalid length";
+	case MEPParseStatus::TRUNCATED_FRAGMENT:
+		return "Incomplete MEPFragment";
+	case MEPParseStatus::BAD_EVENT_NUMBER:
+		return "MEPFragment with bad event number LSB";
+	case MEPParseStatus::TRAILING_BYTES:
+		return "Sum of MEP events + MEP Header is smaller than expected";
+	case MEPParseStatus::TOO_MANY_FRAGMENTS:
+		return "Too many fragments in MEP";
+	default:
+		return "Unknown MEP parse status";
+	}
+}
+
+/*
+ * Short identifier of the status, used as key in monitoring output
+ */
+inline const char* mepParseStatusName(const MEPParseStatus status) {
+	switch (status) {
+	case MEPParseStatus::OK:
+		return "OK";
+	case MEPParseStatus::EMPTY_PACKET:
+		return "EMPTY_PACKET";
+	case MEPParseStatus::TRUNCATED_HEADER:
+		return "TRUNCATED_HEADER";
+	case MEPParseStatus::TRUNCATED_MEP:
+		return "TRUNCATED_MEP";
+	case MEPParseStatus::OVERSIZED_MEP:
+		return "OVERSIZED_MEP";
+	case MEPParseStatus::UNKNOWN_SOURCE_ID:
+		return "UNKNOWN_SOURCE_ID";
+	case MEPParseStatus::BAD_FRAGMENT_LENGTH:
+		return "BAD_FRAGMENT_LENGTH";
+	case MEPParseStatus::TRUNCATED_FRAGMENT:
+		return "TRUNCATED_FRAGMENT";
+	case MEPParseStatus::BAD_EVENT_NUMBER:
+		return "BAD_EVENT_NUMBER";
+	case MEPParseStatus::TRAILING_BYTES:
+		return "TRAILING_BYTES";
+	case MEPParseStatus::TOO_MANY_FRAGMENTS:
+		return "TOO_MANY_FRAGMENTS";
+	default:
+		return "UNKNOWN";
+	}
+}
+
+/*
+ * Upper bound of fragments within one frame. Used to size the offset tables of the validation pass
+ * on the stack: L0 MEPs carry at most 255 events (8 bit eventCount), L1 fragments are at least one
+ * 16 byte L1_EVENT_RAW_HDR long.
+ */
+#define MAX_L0_FRAGMENTS_PER_MEP 255
+#define MAX_L1_FRAGMENTS_PER_MEP (MTU / 16)
+
+}
+/* namespace na62 */
+
+#endif /* MEPPARSESTATUS_H_ */
@@ -24,6 +24,9 @@ struct EventTest {
 typedef std::array< char, 24576 > l1_SerializedEvent; //byte
 //typedef std::array< char, 16384 > l1_SerializedEvent; //byte
 
+//The last bytes of every l1_SerializedEvent are reserved for the trigger result, see TriggerMessageCodec
+#define L1_TRIGGER_RESULT_AREA_SIZE 512
+
 #endif /* SERIALEVENT_H_ */
 
 
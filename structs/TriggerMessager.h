@@ -5,6 +5,9 @@
  *      Author: Adam Pearson
  */
 
+#include <array>
+#include <cstdint>
+
 #include "l1/L1InfoToStorage.h"
 
 #ifndef TRIGGER_MESSAGER_H_
@@ -15,6 +18,7 @@ struct TriggerMessager {
 	uint_fast32_t event_id;
 	uint_fast32_t burst_id;
 	uint level;
+	uint64_t dispatch_time_micros; //CLOCK_MONOTONIC time the farm enqueued the event, for the consumer latency
 	uint_fast8_t l1_trigger_type_word; //Filled from the trigger processor
 
 	//uint_fast8_t l1TriggerWords;
@@ -24,7 +28,23 @@ struct TriggerMessager {
 	bool isRequestZeroSuppressed;
 
 	bool trigger_result;
+	uint_fast8_t l2_trigger_type_word; //Filled from the L2 trigger processor for level 2 messages
+};
+
+/*
+ * What is actually sent through the shared memory queues. The L1 results of a response are written into the
+ * result area at the end of the event slot, see TriggerMessageCodec
+ */
+struct TriggerDescriptor {
+	uint32_t memory_id;
+	uint32_t event_id;
+	uint32_t burst_id;
+	uint8_t level;
+	uint8_t flags;
+	uint8_t trigger_type_word; // l1_trigger_type_word or l2_trigger_type_word depending on the level
+	uint8_t reserved;
 };
+static_assert(sizeof(TriggerDescriptor) == 16, "TriggerDescriptor must be 16 bytes");
 
 #endif /* EVENTID_H_ */
 
@@ -0,0 +1,72 @@
+/*
+ * DeadlineScheduler.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: NA62 collaboration
+ */
+
+#include "DeadlineScheduler.h"
+
+namespace na62 {
+
+DeadlineScheduler::DeadlineScheduler() :
+		running_(true), nextID_(0) {
+}
+
+DeadlineScheduler::DeadlineID DeadlineScheduler::schedule(const Clock::time_point deadline,
+		const std::function<void()>& callback) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	const DeadlineID id = nextID_++;
+	const bool earliest = deadlines_.empty() || deadline < deadlines_.begin()->first.first;
+	deadlines_[std::make_pair(deadline, id)] = callback;
+	if (earliest) {
+		wakeup_.notify_all();
+	}
+	return id;
+}
+
+bool DeadlineScheduler::cancel(const DeadlineID id) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	for (auto it = deadlines_.begin(); it != deadlines_.end(); ++it) {
+		if (it->first.second == id) {
+			deadlines_.erase(it);
+			return true;
+		}
+	}
+	return false;
+}
+
+uint DeadlineScheduler::size() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return deadlines_.size();
+}
+
+void DeadlineScheduler::run() {
+	std::unique_lock<std::mutex> lock(mutex_);
+	while (running_) {
+		if (deadlines_.empty()) {
+			wakeup_.wait(lock);
+			continue;
+		}
+
+		auto next = deadlines_.begin();
+		if (Clock::now() < next->first.first) {
+			wakeup_.wait_until(lock, next->first.first);
+			continue;
+		}
+
+		std::function<void()> callback = std::move(next->second);
+		deadlines_.erase(next);
+		lock.unlock();
+		callback();
+		lock.lock();
+	}
+}
+
+void DeadlineScheduler::stop() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	running_ = false;
+	wakeup_.notify_all();
+}
+
+} /* namespace na62 */
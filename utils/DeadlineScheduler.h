@@ -0,0 +1,75 @@
+/*
+ * DeadlineScheduler.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: NA62 collaboration
+ */
+
+#pragma once
+#ifndef DEADLINESCHEDULER_H_
+#define DEADLINESCHEDULER_H_
+
+#include <sys/types.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <utility>
+
+namespace na62 {
+
+/*
+ * Executes callbacks at absolute deadlines of the steady clock. The thread calling run() sleeps until the
+ * earliest deadline or until a new earlier deadline is scheduled, so callbacks fire without polling jitter.
+ *
+ * Callbacks are executed by the thread calling run() without holding any lock and may schedule or cancel
+ * further deadlines.
+ */
+class DeadlineScheduler {
+public:
+	typedef std::chrono::steady_clock Clock;
+	typedef uint64_t DeadlineID;
+
+	DeadlineScheduler();
+
+	/*
+	 * Returns an ID that can be used to cancel the deadline
+	 */
+	DeadlineID schedule(const Clock::time_point deadline, const std::function<void()>& callback);
+
+	DeadlineID scheduleAfter(const uint milliseconds, const std::function<void()>& callback) {
+		return schedule(Clock::now() + std::chrono::milliseconds(milliseconds), callback);
+	}
+
+	/*
+	 * Returns false if the deadline has already been executed or canceled
+	 */
+	bool cancel(const DeadlineID id);
+
+	/*
+	 * Number of pending deadlines
+	 */
+	uint size();
+
+	/*
+	 * Executes the deadlines until stop() is called
+	 */
+	void run();
+
+	void stop();
+
+private:
+	std::mutex mutex_;
+	std::condition_variable wakeup_;
+	bool running_;
+	DeadlineID nextID_;
+
+	// ordered by deadline and ID so that equal deadlines are executed in the order of scheduling
+	std::map<std::pair<Clock::time_point, DeadlineID>, std::function<void()>> deadlines_;
+};
+
+} /* namespace na62 */
+
+#endif /* DEADLINESCHEDULER_H_ */
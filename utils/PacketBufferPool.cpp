@@ -0,0 +1,145 @@
+/*
+ * PacketBufferPool.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: NA62 collaboration
+ */
+
+#include "PacketBufferPool.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#include "../options/Logging.h"
+#include "../options/Options.h"
+
+namespace na62 {
+
+PacketBufferPool::Pool PacketBufferPool::pools_[NUMBER_OF_PACKET_BUFFER_CLASSES];
+ShardedCounters<NUMBER_OF_PACKET_BUFFER_CLASSES * NUMBER_OF_PACKET_BUFFER_COUNTERS> PacketBufferPool::counters_;
+
+void PacketBufferPool::initialize(const uint numberOfMTUBuffers, const uint numberOfJumboBuffers) {
+	const uint numberOfBuffers[NUMBER_OF_PACKET_BUFFER_CLASSES] = { numberOfMTUBuffers, numberOfJumboBuffers };
+
+	for (uint bufferClass = 0; bufferClass != NUMBER_OF_PACKET_BUFFER_CLASSES; bufferClass++) {
+		Pool& pool = pools_[bufferClass];
+		pool.stride = (getBufferSize((PacketBufferClass) bufferClass) + NA62_CACHE_LINE_SIZE - 1)
+				& ~(NA62_CACHE_LINE_SIZE - 1);
+		pool.capacity = numberOfBuffers[bufferClass];
+		pool.head = EMPTY;
+		if (pool.capacity == 0) {
+			continue;
+		}
+
+		if (posix_memalign((void**) &pool.slab, NA62_CACHE_LINE_SIZE, (size_t) pool.stride * pool.capacity) != 0) {
+			LOG_ERROR("Unable to allocate " << pool.capacity << " packet buffers of " << pool.stride << " B");
+			pool.capacity = 0;
+			continue;
+		}
+		// First touch on this thread's NUMA node
+		memset(pool.slab, 0, (size_t) pool.stride * pool.capacity);
+
+		pool.next = new std::atomic<uint32_t>[pool.capacity];
+		for (uint32_t index = 0; index != pool.capacity; index++) {
+			pool.next[index] = index + 1 == pool.capacity ? EMPTY : index + 1;
+		}
+		pool.head = 0;
+	}
+}
+
+uint_fast32_t PacketBufferPool::getBufferSize(const PacketBufferClass bufferClass) {
+	return bufferClass == PACKET_BUFFER_MTU ? MTU : PACKET_BUFFER_JUMBO_SIZE;
+}
+
+uint32_t PacketBufferPool::pop(Pool& pool) {
+	uint64_t head = pool.head.load(std::memory_order_acquire);
+	while (true) {
+		const uint32_t index = head;
+		if (index == EMPTY) {
+			return EMPTY;
+		}
+		const uint64_t newHead = (((head >> 32) + 1) << 32) | pool.next[index].load(std::memory_order_relaxed);
+		if (pool.head.compare_exchange_weak(head, newHead, std::memory_order_acquire, std::memory_order_acquire)) {
+			return index;
+		}
+	}
+}
+
+void PacketBufferPool::push(Pool& pool, const uint32_t index) {
+	uint64_t head = pool.head.load(std::memory_order_relaxed);
+	while (true) {
+		pool.next[index].store((uint32_t) head, std::memory_order_relaxed);
+		const uint64_t newHead = (((head >> 32) + 1) << 32) | index;
+		if (pool.head.compare_exchange_weak(head, newHead, std::memory_order_release, std::memory_order_relaxed)) {
+			return;
+		}
+	}
+}
+
+PacketBufferPool::ThreadCache::ThreadCache() {
+	memset(size, 0, sizeof(size));
+}
+
+/*
+ * Buffers cached by a terminating thread go back to the shared stacks
+ */
+PacketBufferPool::ThreadCache::~ThreadCache() {
+	for (uint bufferClass = 0; bufferClass != NUMBER_OF_PACKET_BUFFER_CLASSES; bufferClass++) {
+		while (size[bufferClass] != 0) {
+			push(pools_[bufferClass], indices[bufferClass][--size[bufferClass]]);
+		}
+	}
+}
+
+PacketBufferPool::ThreadCache& PacketBufferPool::threadCache() {
+	static thread_local ThreadCache cache;
+	return cache;
+}
+
+char* PacketBufferPool::allocate(const uint_fast32_t size, PacketBufferClass& bufferClass) {
+	bufferClass = size <= MTU ? PACKET_BUFFER_MTU : PACKET_BUFFER_JUMBO;
+	Pool& pool = pools_[bufferClass];
+
+	if (size <= PACKET_BUFFER_JUMBO_SIZE && pool.capacity != 0) {
+		ThreadCache& cache = threadCache();
+		uint32_t index;
+		if (cache.size[bufferClass] != 0) {
+			index = cache.indices[bufferClass][--cache.size[bufferClass]];
+		} else {
+			index = pop(pool);
+		}
+
+		if (index != EMPTY) {
+			counters_.add(bufferClass * NUMBER_OF_PACKET_BUFFER_COUNTERS + PACKET_BUFFER_POOL_ALLOCATIONS, 1);
+			return pool.slab + (size_t) index * pool.stride;
+		}
+	}
+
+	counters_.add(
+			(size <= PACKET_BUFFER_JUMBO_SIZE ? bufferClass : PACKET_BUFFER_JUMBO) * NUMBER_OF_PACKET_BUFFER_COUNTERS
+					+ PACKET_BUFFER_HEAP_ALLOCATIONS, 1);
+	bufferClass = PACKET_BUFFER_HEAP;
+	return new char[size];
+}
+
+void PacketBufferPool::release(char* buffer, const PacketBufferClass bufferClass) {
+	if (bufferClass == PACKET_BUFFER_HEAP) {
+		delete[] buffer;
+		return;
+	}
+
+	Pool& pool = pools_[bufferClass];
+	const uint32_t index = (buffer - pool.slab) / pool.stride;
+	ThreadCache& cache = threadCache();
+	if (cache.size[bufferClass] == PACKET_BUFFER_THREAD_CACHE) {
+		/*
+		 * Buffers are typically released by other threads than the receiver: hand half of the cache back
+		 */
+		while (cache.size[bufferClass] != PACKET_BUFFER_THREAD_CACHE / 2) {
+			push(pool, cache.indices[bufferClass][--cache.size[bufferClass]]);
+		}
+	}
+	cache.indices[bufferClass][cache.size[bufferClass]++] = index;
+}
+
+} /* namespace na62 */
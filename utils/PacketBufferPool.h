@@ -0,0 +1,106 @@
+/*
+ * PacketBufferPool.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: NA62 collaboration
+ */
+
+#pragma once
+#ifndef PACKETBUFFERPOOL_H_
+#define PACKETBUFFERPOOL_H_
+
+#include <sys/types.h>
+#include <atomic>
+#include <cstdint>
+
+#include "ThreadShard.h"
+
+/*
+ * Reassembled IP packets may be as large as the largest UDP datagram
+ */
+#define PACKET_BUFFER_JUMBO_SIZE 65536
+
+/*
+ * Number of buffers per class each thread keeps for itself before returning them to the shared stack
+ */
+#define PACKET_BUFFER_THREAD_CACHE 64
+
+namespace na62 {
+
+/*
+ * The pool handle stored in a DataContainer. Buffers not coming from the pool have PACKET_BUFFER_HEAP
+ * and are freed with delete[]
+ */
+enum PacketBufferClass
+	: uint8_t {
+		PACKET_BUFFER_MTU, PACKET_BUFFER_JUMBO, NUMBER_OF_PACKET_BUFFER_CLASSES, PACKET_BUFFER_HEAP = 0xFF
+};
+
+enum PacketBufferCounter {
+	PACKET_BUFFER_POOL_ALLOCATIONS, PACKET_BUFFER_HEAP_ALLOCATIONS, NUMBER_OF_PACKET_BUFFER_COUNTERS
+};
+
+/*
+ * Fixed size receive buffers (MTU and jumbo) preallocated in one slab per class.
+ *
+ * Free buffers are kept in a lock free stack of slab indices with an ABA tag in the upper half of the head.
+ * Every thread has a small cache per class in front of it so that the common case (allocate and release
+ * in a tight loop) does not touch shared cache lines at all. The slabs are allocated and first touched by
+ * the thread calling initialize(), so that thread should be pinned to the NUMA node of the NIC.
+ *
+ * If a class is exhausted or not initialized, allocate() falls back to new[].
+ */
+class PacketBufferPool {
+public:
+	/*
+	 * Must be called once before the first allocate
+	 */
+	static void initialize(const uint numberOfMTUBuffers, const uint numberOfJumboBuffers);
+
+	/*
+	 * Returns a buffer of at least <size> bytes. <bufferClass> is set to the handle that has to be passed to release()
+	 */
+	static char* allocate(const uint_fast32_t size, PacketBufferClass& bufferClass);
+
+	static void release(char* buffer, const PacketBufferClass bufferClass);
+
+	static uint_fast32_t getBufferSize(const PacketBufferClass bufferClass);
+
+	static inline uint getNumberOfBuffers(const PacketBufferClass bufferClass) {
+		return pools_[bufferClass].capacity;
+	}
+
+	static inline uint64_t getCounter(const PacketBufferClass bufferClass, const PacketBufferCounter counter) {
+		return counters_.get(bufferClass * NUMBER_OF_PACKET_BUFFER_COUNTERS + counter);
+	}
+
+private:
+	static const uint32_t EMPTY = 0xFFFFFFFF;
+
+	struct Pool {
+		char* slab;
+		uint stride;
+		uint capacity;
+		std::atomic<uint64_t> head; // ABA tag << 32 | index of the first free buffer
+		std::atomic<uint32_t>* next;
+	};
+
+	struct ThreadCache {
+		uint32_t indices[NUMBER_OF_PACKET_BUFFER_CLASSES][PACKET_BUFFER_THREAD_CACHE];
+		uint size[NUMBER_OF_PACKET_BUFFER_CLASSES];
+
+		ThreadCache();
+		~ThreadCache();
+	};
+
+	static uint32_t pop(Pool& pool);
+	static void push(Pool& pool, const uint32_t index);
+	static ThreadCache& threadCache();
+
+	static Pool pools_[NUMBER_OF_PACKET_BUFFER_CLASSES];
+	static ShardedCounters<NUMBER_OF_PACKET_BUFFER_CLASSES * NUMBER_OF_PACKET_BUFFER_COUNTERS> counters_;
+};
+
+} /* namespace na62 */
+
+#endif /* PACKETBUFFERPOOL_H_ */
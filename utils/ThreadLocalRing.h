@@ -0,0 +1,151 @@
+/*
+ * ThreadLocalRing.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: NA62 collaboration
+ */
+
+#pragma once
+#ifndef THREADLOCALRING_H_
+#define THREADLOCALRING_H_
+
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <atomic>
+#include <cstdint>
+
+namespace na62 {
+
+/*
+ * One single producer/single consumer ring of <Size> records per writing thread, emptied by a single
+ * consumer thread calling drain(). The rings are kept in a lock free list and reused as soon as their
+ * thread finished, so a writer never takes a lock and only allocates for its very first record.
+ *
+ * Every instantiation owns its own set of rings. The producer only writes head_, the consumer only tail_.
+ */
+template<typename Record, uint Size>
+class ThreadLocalRing {
+	static_assert((Size & (Size - 1)) == 0, "The ring size must be a power of two");
+
+public:
+	/*
+	 * Returns the next free record of the ring of the calling thread or nullptr if the ring is full.
+	 * The record is passed to drain() only after commit() has been called
+	 */
+	static inline Record* reserve() {
+		Buffer* buffer = handle_.get();
+		const uint head = buffer->head_.load(std::memory_order_relaxed);
+		if (head - buffer->tail_.load(std::memory_order_acquire) == Size) {
+			return nullptr;
+		}
+		return &buffer->records_[head & (Size - 1)];
+	}
+
+	/*
+	 * Publishes the record returned by the last reserve() of the calling thread
+	 */
+	static inline void commit() {
+		Buffer* buffer = handle_.get();
+		buffer->head_.store(buffer->head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	/*
+	 * Calls consume(threadID, first, numberOfFirst, second, numberOfSecond) with the pending records of every
+	 * ring and frees them afterwards. As the records may wrap around the end of the ring they are passed in
+	 * two consecutive parts, the second one being empty most of the time.
+	 *
+	 * Returns the number of consumed records
+	 */
+	template<typename Consumer>
+	static uint drain(Consumer consume) {
+		uint consumed = 0;
+		for (Buffer* buffer = buffers_.load(std::memory_order_acquire); buffer != nullptr; buffer =
+				buffer->next_) {
+			const uint tail = buffer->tail_.load(std::memory_order_relaxed);
+			const uint head = buffer->head_.load(std::memory_order_acquire);
+			if (head == tail) {
+				continue;
+			}
+
+			const uint numberOfRecords = head - tail;
+			const uint first = tail & (Size - 1);
+			const uint numberOfFirst = numberOfRecords < Size - first ? numberOfRecords : Size - first;
+			consume(buffer->threadID_, &buffer->records_[first], numberOfFirst, &buffer->records_[0],
+					numberOfRecords - numberOfFirst);
+			consumed += numberOfRecords;
+
+			buffer->tail_.store(head, std::memory_order_release);
+		}
+		return consumed;
+	}
+
+private:
+	struct Buffer {
+		std::atomic<uint> head_;
+		std::atomic<uint> tail_;
+		std::atomic<bool> inUse_;
+		pid_t threadID_;
+		Buffer* next_;
+		Record records_[Size];
+	};
+
+	static Buffer* acquire() {
+		for (Buffer* buffer = buffers_.load(std::memory_order_acquire); buffer != nullptr; buffer =
+				buffer->next_) {
+			bool inUse = false;
+			if (buffer->inUse_.compare_exchange_strong(inUse, true, std::memory_order_acquire)) {
+				buffer->threadID_ = syscall(SYS_gettid);
+				return buffer;
+			}
+		}
+
+		Buffer* buffer = new Buffer();
+		buffer->head_ = 0;
+		buffer->tail_ = 0;
+		buffer->inUse_ = true;
+		buffer->threadID_ = syscall(SYS_gettid);
+		buffer->next_ = buffers_.load(std::memory_order_relaxed);
+		while (!buffers_.compare_exchange_weak(buffer->next_, buffer, std::memory_order_release)) {
+		}
+		return buffer;
+	}
+
+	/*
+	 * Gives the ring back as soon as the owning thread finishes
+	 */
+	struct Handle {
+		Buffer* buffer_;
+
+		Handle() :
+				buffer_(nullptr) {
+		}
+
+		~Handle() {
+			if (buffer_ != nullptr) {
+				buffer_->inUse_.store(false, std::memory_order_release);
+			}
+		}
+
+		inline Buffer* get() {
+			if (buffer_ == nullptr) {
+				buffer_ = acquire();
+			}
+			return buffer_;
+		}
+	};
+
+	// Lock free list of all rings ever created
+	static std::atomic<Buffer*> buffers_;
+	static thread_local Handle handle_;
+};
+
+template<typename Record, uint Size>
+std::atomic<typename ThreadLocalRing<Record, Size>::Buffer*> ThreadLocalRing<Record, Size>::buffers_(nullptr);
+
+template<typename Record, uint Size>
+thread_local typename ThreadLocalRing<Record, Size>::Handle ThreadLocalRing<Record, Size>::handle_;
+
+} /* namespace na62 */
+
+#endif /* THREADLOCALRING_H_ */
@@ -0,0 +1,14 @@
+/*
+ * ThreadShard.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: NA62 collaboration
+ */
+
+#include "ThreadShard.h"
+
+namespace na62 {
+
+std::atomic<uint> ThreadShard::nextIndex_(0);
+
+} /* namespace na62 */
@@ -0,0 +1,169 @@
+/*
+ * ThreadShard.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: NA62 collaboration
+ */
+
+#pragma once
+#ifndef THREADSHARD_H_
+#define THREADSHARD_H_
+
+#include <sys/types.h>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#define NA62_CACHE_LINE_SIZE 64
+
+/*
+ * Number of counter copies. Threads are mapped round robin onto the shards so that up to
+ * NA62_COUNTER_SHARDS threads never write into the same cache line. Must be a power of two.
+ */
+#ifndef NA62_COUNTER_SHARDS
+#define NA62_COUNTER_SHARDS 32
+#endif
+
+namespace na62 {
+
+class ThreadShard {
+public:
+	/*
+	 * Shard of the calling thread, fixed for the lifetime of the thread
+	 */
+	static inline uint index() {
+		static thread_local uint index_ = nextIndex_.fetch_add(1,
+				std::memory_order_relaxed) & (NA62_COUNTER_SHARDS - 1);
+		return index_;
+	}
+
+private:
+	static std::atomic<uint> nextIndex_;
+};
+
+/*
+ * <N> relaxed atomic counters with one cache line aligned copy per shard. Incrementing only touches
+ * the shard of the calling thread; reading sums up all shards and is therefore meant for
+ * monitoring and EOB, not for the event path.
+ *
+ * Objects must have static storage duration as operator new does not respect the alignment.
+ */
+template<uint N>
+class ShardedCounters {
+public:
+	inline void add(const uint counter, const uint64_t amount) {
+		shards_[ThreadShard::index()].counters_[counter].fetch_add(amount,
+				std::memory_order_relaxed);
+	}
+
+	/*
+	 * Adds <amount> and returns the sum before the addition: the previous value of the own shard as
+	 * returned by its fetch_add plus the other shards. Concurrent additions of other threads may or may
+	 * not be included, additions of the calling thread never get lost or counted twice
+	 */
+	inline uint64_t fetchAdd(const uint counter, const uint64_t amount) {
+		const uint ownShard = ThreadShard::index();
+		uint64_t sum = shards_[ownShard].counters_[counter].fetch_add(amount,
+				std::memory_order_relaxed);
+		for (uint shard = 0; shard != NA62_COUNTER_SHARDS; shard++) {
+			if (shard != ownShard) {
+				sum += shards_[shard].counters_[counter].load(
+						std::memory_order_relaxed);
+			}
+		}
+		return sum;
+	}
+
+	uint64_t get(const uint counter) const {
+		uint64_t sum = 0;
+		for (uint shard = 0; shard != NA62_COUNTER_SHARDS; shard++) {
+			sum += shards_[shard].counters_[counter].load(
+					std::memory_order_relaxed);
+		}
+		return sum;
+	}
+
+	void reset(const uint counter) {
+		for (uint shard = 0; shard != NA62_COUNTER_SHARDS; shard++) {
+			shards_[shard].counters_[counter].store(0, std::memory_order_relaxed);
+		}
+	}
+
+	void reset() {
+		for (uint counter = 0; counter != N; counter++) {
+			reset(counter);
+		}
+	}
+
+private:
+	struct alignas(NA62_CACHE_LINE_SIZE) Shard {
+		std::atomic<uint64_t> counters_[N];
+	};
+	Shard shards_[NA62_COUNTER_SHARDS];
+};
+
+/*
+ * Same as ShardedCounters for a number of counters only known at runtime (e.g. per sourceID).
+ * init() must be called before the first access.
+ */
+class DynamicShardedCounters {
+public:
+	DynamicShardedCounters() :
+			counters_(nullptr), numberOfCounters_(0), stride_(0) {
+	}
+
+	void init(const uint numberOfCounters) {
+		const uint countersPerLine = NA62_CACHE_LINE_SIZE / sizeof(std::atomic<uint64_t>);
+		numberOfCounters_ = numberOfCounters;
+		stride_ = (numberOfCounters + countersPerLine - 1) / countersPerLine * countersPerLine;
+
+		void* memory = nullptr;
+		if (posix_memalign(&memory, NA62_CACHE_LINE_SIZE,
+				stride_ * NA62_COUNTER_SHARDS * sizeof(std::atomic<uint64_t>)) != 0) {
+			throw std::bad_alloc();
+		}
+		counters_ = static_cast<std::atomic<uint64_t>*>(memory);
+		for (uint i = 0; i != stride_ * NA62_COUNTER_SHARDS; i++) {
+			new (counters_ + i) std::atomic<uint64_t>(0);
+		}
+	}
+
+	inline void add(const uint counter, const uint64_t amount) {
+		counters_[ThreadShard::index() * stride_ + counter].fetch_add(amount,
+				std::memory_order_relaxed);
+	}
+
+	/*
+	 * Returns 0 for counters out of range, e.g. if init() has not been called
+	 */
+	uint64_t get(const uint counter) const {
+		uint64_t sum = 0;
+		if (counter >= numberOfCounters_) {
+			return 0;
+		}
+		for (uint shard = 0; shard != NA62_COUNTER_SHARDS; shard++) {
+			sum += counters_[shard * stride_ + counter].load(std::memory_order_relaxed);
+		}
+		return sum;
+	}
+
+	void reset() {
+		for (uint i = 0; i != stride_ * NA62_COUNTER_SHARDS; i++) {
+			counters_[i].store(0, std::memory_order_relaxed);
+		}
+	}
+
+	inline uint size() const {
+		return numberOfCounters_;
+	}
+
+private:
+	std::atomic<uint64_t>* counters_;
+	uint numberOfCounters_;
+	uint stride_;
+};
+
+} /* namespace na62 */
+
+#endif /* THREADSHARD_H_ */
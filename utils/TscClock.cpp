@@ -0,0 +1,39 @@
+/*
+ * TscClock.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: NA62 collaboration
+ */
+
+#include "TscClock.h"
+
+#include <unistd.h>
+
+namespace na62 {
+
+// 1 tick per microsecond until calibrate() has been called
+uint64_t TscClock::microsPerTickScaled_ = 1ull << TscClock::SCALE_SHIFT;
+
+static uint64_t monotonicNanos() {
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+void TscClock::calibrate() {
+	const uint64_t startNanos = monotonicNanos();
+	const uint64_t startTicks = now();
+	usleep(10000);
+	const uint64_t ticks = now() - startTicks;
+	const uint64_t nanos = monotonicNanos() - startNanos;
+
+	if (ticks == 0 || nanos == 0) {
+		return;
+	}
+	microsPerTickScaled_ = ((nanos << SCALE_SHIFT) / 1000) / ticks;
+	if (microsPerTickScaled_ == 0) {
+		microsPerTickScaled_ = 1;
+	}
+}
+
+} /* namespace na62 */
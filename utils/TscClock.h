@@ -0,0 +1,61 @@
+/*
+ * TscClock.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: NA62 collaboration
+ */
+
+#pragma once
+#ifndef TSCCLOCK_H_
+#define TSCCLOCK_H_
+
+#include <sys/types.h>
+#include <cstdint>
+#include <ctime>
+
+namespace na62 {
+
+/*
+ * Cheap monotonic timestamps for the event path. On x86 this is the time stamp counter (constant_tsc is
+ * required, which all farm nodes provide), elsewhere CLOCK_MONOTONIC in nanoseconds.
+ *
+ * calibrate() must be called once before ticksToMicros() is used.
+ */
+class TscClock {
+public:
+	static inline uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+		unsigned a, d;
+		asm volatile("rdtsc" : "=a" (a), "=d" (d));
+		return ((uint64_t) a) | (((uint64_t) d) << 32);
+#else
+		timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+#endif
+	}
+
+	static inline uint32_t ticksToMicros(const uint64_t ticks) {
+		return (ticks * microsPerTickScaled_) >> SCALE_SHIFT;
+	}
+
+	/*
+	 * Measures the number of ticks per microsecond against CLOCK_MONOTONIC (takes ~10 ms)
+	 */
+	static void calibrate();
+
+	static double getTicksPerMicrosecond() {
+		return (double) (1ull << SCALE_SHIFT) / microsPerTickScaled_;
+	}
+
+private:
+	/*
+	 * Fixed point factor so that the conversion is one multiplication and one shift
+	 */
+	static const uint SCALE_SHIFT = 24;
+	static uint64_t microsPerTickScaled_;
+};
+
+} /* namespace na62 */
+
+#endif /* TSCCLOCK_H_ */